@@ -6,14 +6,15 @@ DatabentoMboClient::DatabentoMboClient(uint64_t client_id,
                                        const std::string &name,
                                        std::shared_ptr<OrderBook> order_book,
                                        uint64_t tracked_user_id,
-                                       uint64_t slippage_delay_ns)
+                                       uint64_t slippage_delay_ns,
+                                       const std::string &file_tag)
     : order_book_(order_book), client_id_(client_id), client_name_(name),
       tracked_user_id_(tracked_user_id) {
   // Note: slippage_delay_ns parameter is reserved for future use
   (void)slippage_delay_ns; // Suppress unused parameter warning
 
   portfolio_manager_ = std::make_shared<PortfolioManager>(
-      "portfolio_" + std::to_string(tracked_user_id) + ".csv");
+      "portfolio_" + std::to_string(tracked_user_id) + file_tag + ".csv");
 
   // Generate current date for TOB CSV filename
   auto now = std::chrono::system_clock::now();
@@ -26,7 +27,7 @@ DatabentoMboClient::DatabentoMboClient(uint64_t client_id,
 
   // Initialize TOB tracker with default symbol and current date
   // Symbol will be updated when we process market data
-  std::string default_symbol = "ES_DEMO";
+  std::string default_symbol = "ES_DEMO" + file_tag;
   tob_tracker_ = std::make_shared<TopOfBookTracker>(
       default_symbol, current_date + "_" + current_date);
 
@@ -87,12 +88,7 @@ bool DatabentoMboClient::CancelOrder(uint64_t order_id) {
     return false;
   }
 
-  try {
-    order_book_->CancelOrder(order_id);
-    return true;
-  } catch (const std::exception &e) {
-    return false;
-  }
+  return order_book_->TryCancelOrder(order_id).Ok();
 }
 
 bool DatabentoMboClient::ModifyOrder(uint64_t order_id, uint64_t new_quantity,
@@ -101,12 +97,7 @@ bool DatabentoMboClient::ModifyOrder(uint64_t order_id, uint64_t new_quantity,
     return false;
   }
 
-  try {
-    order_book_->ModifyOrder(order_id, new_quantity, new_price);
-    return true;
-  } catch (const std::exception &e) {
-    return false;
-  }
+  return order_book_->TryModifyOrder(order_id, new_quantity, new_price).Ok();
 }
 
 uint64_t DatabentoMboClient::GetBestBid() const {
@@ -278,47 +269,150 @@ bool DatabentoMboClient::IsUserTracked(uint64_t user_id) const {
 // ========== Databento MBO Message Processing ==========
 
 KeepGoing DatabentoMboClient::ProcessMarketData(const Record &rec) {
-  symbol_mappings_.OnRecord(rec);
+  if (rec.RType() == RType::SymbolMapping) {
+    SetSymbol(rec.Get<SymbolMappingMsg>().STypeOutSymbol());
+  }
 
-  if (!running_) {
-    return KeepGoing::Stop;
+  FeedCommand commands[kMaxCommandsPerRecord];
+  size_t count = DecodeRecord(rec, commands);
+  for (size_t i = 0; i < count; ++i) {
+    if (ProcessCommand(commands[i]) == KeepGoing::Stop) {
+      return KeepGoing::Stop;
+    }
   }
+  return running_ ? KeepGoing::Continue : KeepGoing::Stop;
+}
+
+namespace {
+
+// Databento prices are in nano-units; the book stores hundredths of a point
+// (ES futures trade in 0.25 point increments, e.g. 5432.25, 5432.50)
+uint64_t ToBookPrice(int64_t price_raw) {
+  double price_points = static_cast<double>(price_raw) / 1000000000.0;
+  return static_cast<uint64_t>(static_cast<int64_t>(price_points * 100));
+}
+
+} // namespace
+
+size_t DatabentoMboClient::DecodeRecord(const Record &rec, FeedCommand *out) {
+  FeedCommand &command = out[0];
+  command = FeedCommand{};
+  command.instrument_id = rec.Header().instrument_id;
 
   // Handle different record types based on RType
   switch (rec.RType()) {
   case RType::Mbo: {
     const auto &mbo = rec.Get<MboMsg>();
-    return ProcessMboMessage(mbo);
+    // Extract timestamps that are common to all MBO actions
+    uint64_t ts_received =
+        static_cast<uint64_t>(mbo.ts_recv.time_since_epoch().count());
+    uint64_t ts_executed =
+        ts_received + static_cast<uint64_t>(mbo.ts_in_delta.count());
+    uint64_t order_id = static_cast<uint64_t>(mbo.order_id);
+    uint64_t size = static_cast<uint64_t>(mbo.size);
+
+    switch (mbo.action) {
+    case Action::Add:
+      command.command =
+          BookCommand::Add(order_id, 1, mbo.side == Side::Bid, size,
+                           ToBookPrice(mbo.price), ts_received, ts_executed);
+      command.kind = FeedCommand::Kind::Order;
+      break;
+    case Action::Cancel:
+      command.command = BookCommand::Cancel(order_id);
+      command.kind = FeedCommand::Kind::Order;
+      break;
+    case Action::Modify:
+      command.command =
+          BookCommand::Modify(order_id, size, ToBookPrice(mbo.price));
+      command.kind = FeedCommand::Kind::Order;
+      break;
+    default:
+      command.kind = FeedCommand::Kind::MboOther;
+      break;
+    }
+    command.command.ts_received = ts_received;
+    command.command.ts_executed = ts_executed;
+    command.ends_event = mbo.flags.IsLast();
+    return 1;
   }
   case RType::Mbp0: {
     const auto &trade = rec.Get<TradeMsg>();
-    return ProcessTradeMessage(trade);
+    command.kind = FeedCommand::Kind::Trade;
+    command.command.is_buy = trade.side == Side::Bid;
+    command.command.quantity = static_cast<uint64_t>(trade.size);
+    command.command.price = static_cast<uint64_t>(trade.price / 1000000000);
+    // Trade messages don't have ts_in_delta
+    command.command.ts_received =
+        static_cast<uint64_t>(trade.ts_recv.time_since_epoch().count());
+    command.command.ts_executed = command.command.ts_received;
+    return 1;
   }
   case RType::Mbp1:
   case RType::Bbo1M:
   case RType::Bbo1S: {
     const auto &mbp1 = rec.Get<Mbp1Msg>();
-    return ProcessQuoteMessage(mbp1);
+    // Access the first level from the BidAskPair array
+    const auto &level = mbp1.levels[0];
+    command.command.ts_received =
+        static_cast<uint64_t>(mbp1.ts_recv.time_since_epoch().count());
+    command.command.ts_executed = command.command.ts_received;
+    out[1] = command;
+    command.kind = FeedCommand::Kind::QuoteBid;
+    command.command.is_buy = true;
+    command.command.quantity = level.bid_sz;
+    command.command.price = static_cast<uint64_t>(level.bid_px);
+    out[1].kind = FeedCommand::Kind::QuoteAsk;
+    out[1].command.quantity = level.ask_sz;
+    out[1].command.price = static_cast<uint64_t>(level.ask_px);
+    return 2;
   }
+  case RType::SymbolMapping:
+    command.kind = FeedCommand::Kind::Symbol;
+    return 1;
   default:
     // Ignore other message types
+    return 0;
+  }
+}
+
+KeepGoing DatabentoMboClient::ProcessCommand(const FeedCommand &command) {
+  if (!running_) {
+    return KeepGoing::Stop;
+  }
+
+  switch (command.kind) {
+  case FeedCommand::Kind::Order:
+  case FeedCommand::Kind::MboOther:
+    return ProcessMboCommand(command);
+  case FeedCommand::Kind::Trade:
+    return ProcessTradeCommand(command);
+  case FeedCommand::Kind::QuoteBid:
+  case FeedCommand::Kind::QuoteAsk:
+    return ProcessQuoteCommand(command);
+  case FeedCommand::Kind::Symbol:
+    // Names arrive through SetSymbol
     break;
   }
 
   return KeepGoing::Continue;
 }
 
+void DatabentoMboClient::SetSymbol(const std::string &symbol) {
+  symbol_ = symbol;
+}
+
 uint64_t DatabentoMboClient::GenerateOrderId() {
   return next_order_id_.fetch_add(1);
 }
 
-KeepGoing DatabentoMboClient::ProcessMboMessage(const MboMsg &mbo) {
-  std::string symbol = symbol_mappings_[mbo.hd.instrument_id];
+KeepGoing DatabentoMboClient::ProcessMboCommand(const FeedCommand &command) {
+  std::string symbol = symbol_;
 
   // Debug: Print symbol mapping info
   static int debug_count = 0;
   if (debug_count < 10) {
-    std::cout << "[DEBUG] Instrument ID: " << mbo.hd.instrument_id
+    std::cout << "[DEBUG] Instrument ID: " << command.instrument_id
               << " -> Symbol: '" << symbol << "'" << std::endl;
     debug_count++;
   }
@@ -332,91 +426,83 @@ KeepGoing DatabentoMboClient::ProcessMboMessage(const MboMsg &mbo) {
   // Update current symbol for portfolio tracking
   current_symbol_ = symbol;
 
-  // Extract timestamps that are common to all MBO actions
-  uint64_t ts_received =
-      static_cast<uint64_t>(mbo.ts_recv.time_since_epoch().count());
-  uint64_t ts_executed =
-      ts_received + static_cast<uint64_t>(mbo.ts_in_delta.count());
+  const BookCommand &order = command.command;
 
   // Store the latest timestamp for use in TopOfBookUpdate callbacks
-  last_mbo_timestamp_ = ts_executed;
-
-  // Handle different MBO actions
-  switch (mbo.action) {
-  case Action::Add: {
-    int64_t price_raw = static_cast<int64_t>(mbo.price);
-    // For ES futures: Databento prices are in nano-precision, convert to index
-    // points ES futures trade in 0.25 point increments (e.g., 5432.25, 5432.50,
-    // etc.)
-    double price_points = static_cast<double>(price_raw) / 1000000000.0;
-    int64_t price_for_orderbook = static_cast<int64_t>(
-        price_points * 100); // Store as hundredths for precision
-    uint64_t size = static_cast<uint64_t>(mbo.size);
-    uint64_t order_id = static_cast<uint64_t>(mbo.order_id);
+  last_mbo_timestamp_ = order.ts_executed;
 
-    // Debug: Print timestamp info for first few orders to verify conversion
-    static int ts_debug_count = 0;
-    if (ts_debug_count < 5) {
-      std::cout << "[TIMESTAMP-DEBUG] Order " << order_id
-                << " - ts_received: " << ts_received
-                << " ns, ts_executed: " << ts_executed
-                << " ns, delta: " << mbo.ts_in_delta.count() << " ns"
-                << std::endl;
-      ts_debug_count++;
-    }
+  // One exchange event spans every record up to the one flagged F_LAST;
+  // the book publishes at most one TOB update for it
+  if (!in_mbo_event_) {
+    order_book_->BeginEvent();
+    in_mbo_event_ = true;
+  }
 
-    bool is_buy = (mbo.side == Side::Bid);
-
-    try {
-      order_book_->AddOrder(order_id, 1, is_buy, size, price_for_orderbook,
-                            ts_received, ts_executed);
-      std::cout << "[MBO-ADD] " << symbol << " Order " << order_id << " "
-                << (is_buy ? "BUY" : "SELL") << " " << size << "@" << std::fixed
-                << std::setprecision(2) << price_points << std::endl;
-    } catch (const std::exception &e) {
-      // Order might already exist, which is fine for market data
-      std::cout << "[MBO-ADD-SKIP] Order " << order_id << " already exists"
-                << std::endl;
+  if (command.kind == FeedCommand::Kind::Order) {
+    switch (order.type) {
+    case BookCommandType::Add: {
+      // Debug: Print timestamp info for first few orders to verify conversion
+      static int ts_debug_count = 0;
+      if (ts_debug_count < 5) {
+        std::cout << "[TIMESTAMP-DEBUG] Order " << order.order_id
+                  << " - ts_received: " << order.ts_received
+                  << " ns, ts_executed: " << order.ts_executed
+                  << " ns, delta: " << (order.ts_executed - order.ts_received)
+                  << " ns" << std::endl;
+        ts_debug_count++;
+      }
+
+      // Replay path: use the non-throwing API, rejections are routine here
+      OrderResult result = order_book_->TryAddOrder(
+          order.order_id, order.user_id, order.is_buy, order.quantity,
+          order.price, order.ts_received, order.ts_executed);
+      if (result.Ok()) {
+        std::cout << "[MBO-ADD] " << symbol << " Order " << order.order_id
+                  << " " << (order.is_buy ? "BUY" : "SELL") << " "
+                  << order.quantity << "@" << std::fixed
+                  << std::setprecision(2) << (order.price / 100.0)
+                  << std::endl;
+      } else {
+        // Order might already exist, which is fine for market data
+        std::cout << "[MBO-ADD-SKIP] Order " << order.order_id << ": "
+                  << ToString(result.status) << std::endl;
+      }
+      break;
     }
-    break;
-  }
 
-  case Action::Cancel: {
-    uint64_t order_id = static_cast<uint64_t>(mbo.order_id);
-    try {
-      order_book_->CancelOrder(order_id);
-      std::cout << "[MBO-CANCEL] " << symbol << " Order " << order_id
-                << " cancelled" << std::endl;
-    } catch (const std::exception &e) {
-      // Order might not exist, which is fine for market data
-      std::cout << "[MBO-CANCEL-SKIP] Order " << order_id << " not found"
-                << std::endl;
+    case BookCommandType::Cancel: {
+      if (order_book_->TryCancelOrder(order.order_id).Ok()) {
+        std::cout << "[MBO-CANCEL] " << symbol << " Order " << order.order_id
+                  << " cancelled" << std::endl;
+      } else {
+        // Order might not exist, which is fine for market data
+        std::cout << "[MBO-CANCEL-SKIP] Order " << order.order_id
+                  << " not found" << std::endl;
+      }
+      break;
     }
-    break;
-  }
 
-  case Action::Modify: {
-    uint64_t order_id = static_cast<uint64_t>(mbo.order_id);
-    // Fix price conversion for ES futures
-    double new_price_points = static_cast<double>(mbo.price) / 1000000000.0;
-    int64_t new_price_for_orderbook =
-        static_cast<int64_t>(new_price_points * 100);
-    uint64_t new_size = static_cast<uint64_t>(mbo.size);
-
-    try {
-      order_book_->ModifyOrder(order_id, new_size, new_price_for_orderbook);
-      std::cout << "[MBO-MODIFY] " << symbol << " Order " << order_id
-                << " modified to " << new_size << "@" << std::fixed
-                << std::setprecision(2) << new_price_points << std::endl;
-    } catch (const std::exception &e) {
-      std::cout << "[MBO-MODIFY-SKIP] Order " << order_id
-                << " modify failed: " << e.what() << std::endl;
+    case BookCommandType::Modify: {
+      OrderResult result = order_book_->TryModifyOrder(
+          order.order_id, order.quantity, order.price);
+      if (result.Ok()) {
+        std::cout << "[MBO-MODIFY] " << symbol << " Order " << order.order_id
+                  << " modified to " << order.quantity << "@" << std::fixed
+                  << std::setprecision(2) << (order.price / 100.0)
+                  << std::endl;
+      } else {
+        std::cout << "[MBO-MODIFY-SKIP] Order " << order.order_id
+                  << " modify failed: " << ToString(result.status)
+                  << std::endl;
+      }
+      break;
+    }
     }
-    break;
   }
 
-  default:
-    break;
+  if (command.ends_event) {
+    order_book_->EndEvent();
+    in_mbo_event_ = false;
   }
 
   // Print periodic status updates
@@ -428,57 +514,48 @@ KeepGoing DatabentoMboClient::ProcessMboMessage(const MboMsg &mbo) {
   return KeepGoing::Continue;
 }
 
-KeepGoing DatabentoMboClient::ProcessTradeMessage(const TradeMsg &trade) {
-  std::string symbol = symbol_mappings_[trade.hd.instrument_id];
-
-  if (symbol.empty()) {
+KeepGoing DatabentoMboClient::ProcessTradeCommand(const FeedCommand &command) {
+  if (symbol_.empty()) {
     return KeepGoing::Continue;
   }
 
-  // Extract timestamp for trade message
-  uint64_t ts_received =
-      static_cast<uint64_t>(trade.ts_recv.time_since_epoch().count());
-  uint64_t ts_executed = ts_received; // Trade messages don't have ts_in_delta
-
   // Store the latest timestamp for use in TopOfBookUpdate callbacks
-  last_mbo_timestamp_ = ts_executed;
+  last_mbo_timestamp_ = command.command.ts_executed;
 
-  uint64_t price = static_cast<uint64_t>(trade.price / 1000000000);
-  uint64_t size = static_cast<uint64_t>(trade.size);
+  uint64_t price = command.command.price;
+  uint64_t size = command.command.quantity;
 
-  std::cout << "\n[TRADE] " << symbol << " - Price: " << (price / 100.0)
+  std::cout << "\n[TRADE] " << symbol_ << " - Price: " << (price / 100.0)
             << ", Size: " << size << std::endl;
 
   // Update last price for this symbol
-  last_price_by_symbol_[symbol] = price;
+  last_price_by_symbol_[symbol_] = price;
 
   printOrderBookStatus();
 
   return KeepGoing::Continue;
 }
 
-KeepGoing DatabentoMboClient::ProcessQuoteMessage(const Mbp1Msg &mbp1) {
-  std::string symbol = symbol_mappings_[mbp1.hd.instrument_id];
-
-  if (symbol.empty()) {
+KeepGoing DatabentoMboClient::ProcessQuoteCommand(const FeedCommand &command) {
+  if (symbol_.empty()) {
     return KeepGoing::Continue;
   }
 
-  // Extract timestamp for quote message
-  uint64_t ts_received =
-      static_cast<uint64_t>(mbp1.ts_recv.time_since_epoch().count());
-  uint64_t ts_executed = ts_received; // Quote messages don't have ts_in_delta
+  // The bid half is held until its ask arrives
+  if (command.kind == FeedCommand::Kind::QuoteBid) {
+    quote_bid_price_ = command.command.price;
+    quote_bid_size_ = command.command.quantity;
+    return KeepGoing::Continue;
+  }
 
   // Store the latest timestamp for use in TopOfBookUpdate callbacks
-  last_mbo_timestamp_ = ts_executed;
-
-  // Access the first level from the BidAskPair array
-  const auto &level = mbp1.levels[0];
+  last_mbo_timestamp_ = command.command.ts_executed;
 
-  std::cout << "\n[MARKET DATA] Quote for " << symbol
-            << " - Bid: " << (level.bid_px / 1e9) << " (" << level.bid_sz << ")"
-            << ", Ask: " << (level.ask_px / 1e9) << " (" << level.ask_sz << ")"
-            << std::endl;
+  std::cout << "\n[MARKET DATA] Quote for " << symbol_ << " - Bid: "
+            << (static_cast<int64_t>(quote_bid_price_) / 1e9) << " ("
+            << quote_bid_size_ << ")"
+            << ", Ask: " << (static_cast<int64_t>(command.command.price) / 1e9)
+            << " (" << command.command.quantity << ")" << std::endl;
 
   printOrderBookStatus();
 
@@ -16,6 +16,7 @@
 #include <vector>
 
 // Include the OrderBook headers
+#include "BookCommand.h"
 #include "IClient.h"
 #include "Order.h"
 #include "OrderBook.h"
@@ -33,6 +34,37 @@
 
 using namespace databento;
 
+/**
+ * @brief One feed record decoded into book terms
+ *
+ * DecodeRecord does the Databento-specific work (record types, MBO actions,
+ * price scaling) so whichever thread owns the book only applies the result.
+ * An MBO add, cancel or modify carries the BookCommand to apply, in book
+ * price units; other MBO actions still count towards their exchange event.
+ * A trade carries the print in command form (side, size, price) and a quote
+ * decodes into one entry per side. At 64 bytes it is a quarter of the raw
+ * record slot the ingress ring used to copy.
+ */
+struct FeedCommand {
+  enum class Kind : uint8_t {
+    Order,    // MBO add/cancel/modify: apply command
+    MboOther, // MBO fill, trade, clear or none: no book change
+    Trade,
+    QuoteBid,
+    QuoteAsk, // Follows its QuoteBid
+    Symbol    // Symbol mapping for instrument_id
+  };
+
+  // Timestamps are set for every kind; unused fields are zero
+  BookCommand command;
+  uint32_t instrument_id = 0;
+  Kind kind = Kind::MboOther;
+  // MBO records only: the last record of an exchange event (F_LAST)
+  bool ends_event = false;
+};
+
+static_assert(sizeof(FeedCommand) == 64, "FeedCommand should fill one cache line");
+
 /**
  * @brief MBO (Market By Order) client implementation for Databento integration
  *
@@ -47,8 +79,11 @@ private:
   std::atomic<bool> running_{false};
   std::atomic<uint64_t> next_order_id_{1000};
 
-  // Symbol mapping for Databento instrument IDs
-  PitSymbolMap symbol_mappings_;
+  // This client's instrument, from symbology; empty until its mapping is seen
+  std::string symbol_;
+  // Bid half of the quote being decoded
+  uint64_t quote_bid_price_ = 0;
+  uint64_t quote_bid_size_ = 0;
 
   // Track last prices for market making
   std::unordered_map<std::string, uint64_t> last_price_by_symbol_;
@@ -66,12 +101,15 @@ private:
   std::string current_symbol_;
   uint64_t tracked_user_id_;
   uint64_t last_mbo_timestamp_ = 0;
+  // Inside an MBO event (records seen since the last F_LAST)
+  bool in_mbo_event_ = false;
 
 public:
   DatabentoMboClient(
       uint64_t client_id, const std::string &name,
       std::shared_ptr<OrderBook> order_book, uint64_t tracked_user_id,
-      uint64_t slippage_delay_ns = 0); // slippage_delay_ns ignored
+      uint64_t slippage_delay_ns = 0, // slippage_delay_ns ignored
+      const std::string &file_tag = ""); // appended to CSV file names
 
   // ========== IClient Interface Implementation ==========
 
@@ -146,11 +184,31 @@ public:
    */
   KeepGoing ProcessMarketData(const Record &rec);
 
+  // Most FeedCommands one record decodes into (a quote's two sides)
+  static constexpr size_t kMaxCommandsPerRecord = 2;
+
+  /**
+   * @brief Decode a record without touching any client or book state
+   * @param rec The Databento record
+   * @param out Room for kMaxCommandsPerRecord commands
+   * @return Commands written; 0 for record types the client ignores
+   */
+  static size_t DecodeRecord(const Record &rec, FeedCommand *out);
+
+  /**
+   * @brief Apply one decoded record to the book and the client's trackers
+   * @return KeepGoing::Stop once the client is shut down
+   */
+  KeepGoing ProcessCommand(const FeedCommand &command);
+
+  // Name this client's instrument (from a symbol mapping record)
+  void SetSymbol(const std::string &symbol);
+
 private:
   uint64_t GenerateOrderId();
-  KeepGoing ProcessMboMessage(const MboMsg &mbo);
-  KeepGoing ProcessTradeMessage(const TradeMsg &trade);
-  KeepGoing ProcessQuoteMessage(const Mbp1Msg &mbp1);
+  KeepGoing ProcessMboCommand(const FeedCommand &command);
+  KeepGoing ProcessTradeCommand(const FeedCommand &command);
+  KeepGoing ProcessQuoteCommand(const FeedCommand &command);
   void PrintOrderBookStatus();
   void printOrderBookStatus(); // Alias for compatibility
 };
@@ -1,29 +1,170 @@
 #include "OrderBookManager.h"
+#include <iostream>
+#include <stdexcept>
+#include <string>
 
-OrderBookManager::OrderBookManager(uint64_t slippage_delay_ns) {
-    order_book_ = std::make_shared<OrderBook>();
+namespace {
+
+// Every book reads time from the feed; trade IDs come from each book's own
+// counter, namespaced by instrument ID by the registry
+OrderBookConfig MakeBookConfig(const std::shared_ptr<ReplayClock>& feed_clock) {
+    OrderBookConfig config;
+    config.clock = feed_clock;
+    return config;
+}
+
+}  // namespace
+
+OrderBookManager::OrderBookManager(uint64_t slippage_delay_ns)
+    : feed_clock_(std::make_shared<ReplayClock>()),
+      books_(MakeBookConfig(feed_clock_)),
+      slippage_delay_ns_(slippage_delay_ns) {
+    books_.SetBookCreatedCallback(
+        [this](size_t slot, uint32_t instrument_id, const std::shared_ptr<OrderBook>& book) {
+            OnBookCreated(slot, instrument_id, book);
+        });
+}
+
+void OrderBookManager::OnBookCreated(size_t slot, uint32_t instrument_id, const std::shared_ptr<OrderBook>& book) {
     // Use the user ID defaults to 0: the ID for non tracked users
     uint64_t tracked_user_id = 0;
-    client_ = std::make_shared<DatabentoMboClient>(1, "Databento MBO Client", order_book_, tracked_user_id, slippage_delay_ns);
+    auto client = std::make_shared<DatabentoMboClient>(
+        slot + 1, "Databento MBO Client " + std::to_string(instrument_id), book, tracked_user_id,
+        slippage_delay_ns_, "_" + std::to_string(instrument_id));
     // Register the client with the order book for callbacks
-    order_book_->RegisterClient(client_);
+    book->RegisterClient(client);
+    clients_.push_back(client);  // Slots are handed out in order, so this lands at clients_[slot]
+}
+
+OrderBookManager::~OrderBookManager() {
+    if (book_thread_.joinable()) {
+        ingress_->Close();
+        book_thread_.join();
+    }
+}
+
+void OrderBookManager::EnableIngressThread(size_t capacity, WaitStrategy wait_strategy, IngressOverflow overflow) {
+    if (book_thread_.joinable()) {
+        throw std::runtime_error("Cannot enable the ingress thread after Start");
+    }
+    ingress_ = std::make_unique<IngressRing<FeedCommand>>(capacity, wait_strategy);
+    overflow_ = overflow;
 }
 
 void OrderBookManager::Start() {
-    // Client is already initialized via RegisterClient
+    // Clients are initialized via RegisterClient as their books are created
+    if (ingress_ && !book_thread_.joinable()) {
+        book_thread_ = std::thread(&OrderBookManager::RunBookThread, this);
+    }
 }
 
 void OrderBookManager::Stop() {
-    // Client will be shutdown via UnregisterClient in OrderBook destructor
-    order_book_->UnregisterClient(client_->GetClientId());
+    // The feed has stopped pushing (see the header), so closing the ring
+    // here lets the book thread finish everything the feed handed over
+    if (book_thread_.joinable()) {
+        ingress_->Close();
+        book_thread_.join();
+        IngressRingStats stats = ingress_->GetStats();
+        std::cout << "[OrderBookManager] Ingress: " << stats.pushed << " commands, " << stats.batches
+                  << " batches, " << stats.overflows
+                  << (overflow_ == IngressOverflow::Drop ? " dropped" : " overflows") << ", high water "
+                  << stats.high_water << std::endl;
+    }
+    
+    // Clients will be shutdown via UnregisterClient
+    for (size_t slot = 0; slot < clients_.size(); ++slot) {
+        books_.BookAt(slot).UnregisterClient(clients_[slot]->GetClientId());
+    }
 }
 
 // Bridge method for Databento callbacks
 KeepGoing OrderBookManager::OnMarketData(const Record& record) {
-    return client_->ProcessMarketData(record);
+    if (ingress_ && ingress_->IsClosed()) {
+        return KeepGoing::Stop;  // Stopped; nothing will drain further records
+    }
+    
+    // Feed thread: decode here so the book thread only applies commands
+    FeedCommand commands[DatabentoMboClient::kMaxCommandsPerRecord];
+    size_t count = DatabentoMboClient::DecodeRecord(record, commands);
+    if (record.RType() == RType::SymbolMapping) {
+        std::lock_guard<std::mutex> lock(symbols_mutex_);
+        symbols_[record.Header().instrument_id] = record.Get<SymbolMappingMsg>().STypeOutSymbol();
+    }
+    
+    if (!ingress_) {
+        for (size_t i = 0; i < count; ++i) {
+            if (RouteCommand(commands[i]) == KeepGoing::Stop) {
+                return KeepGoing::Stop;
+            }
+        }
+        return KeepGoing::Continue;
+    }
+    
+    for (size_t i = 0; i < count; ++i) {
+        if (overflow_ == IngressOverflow::Drop) {
+            ingress_->TryPush(commands[i]);  // A full ring counts the overflow
+        } else {
+            ingress_->Push(commands[i]);
+        }
+    }
+    return KeepGoing::Continue;
+}
+
+void OrderBookManager::RunBookThread() {
+    std::vector<FeedCommand> batch(256);
+    while (size_t count = ingress_->WaitPopBatch(batch.data(), batch.size())) {
+        for (size_t i = 0; i < count; ++i) {
+            RouteCommand(batch[i]);
+        }
+    }
+}
+
+// Route each command to its instrument's client
+KeepGoing OrderBookManager::RouteCommand(const FeedCommand& command) {
+    uint32_t instrument_id = command.instrument_id;
+    size_t slot;
+    switch (command.kind) {
+    case FeedCommand::Kind::Order:
+    case FeedCommand::Kind::MboOther:
+        feed_clock_->Advance(command.command.ts_received);
+        slot = books_.GetOrCreateSlot(instrument_id);
+        break;
+    case FeedCommand::Kind::Symbol: {
+        // Order flow and symbology introduce an instrument
+        slot = books_.GetOrCreateSlot(instrument_id);
+        std::lock_guard<std::mutex> lock(symbols_mutex_);
+        auto it = symbols_.find(instrument_id);
+        if (it != symbols_.end()) {
+            clients_[slot]->SetSymbol(it->second);
+        }
+        break;
+    }
+    default:
+        // Trades, quotes and anything else only matter for instruments we already book
+        slot = books_.FindSlot(instrument_id);
+        if (slot == OrderBookRegistry::npos) {
+            return KeepGoing::Continue;
+        }
+        break;
+    }
+    return clients_[slot]->ProcessCommand(command);
 }
 
 // Provide access to client for additional operations
 std::shared_ptr<IClient> OrderBookManager::GetClient() {
-    return client_;
+    return clients_.empty() ? nullptr : clients_.front();
+}
+
+std::shared_ptr<IClient> OrderBookManager::GetClient(uint32_t instrument_id) {
+    size_t slot = books_.FindSlot(instrument_id);
+    return slot != OrderBookRegistry::npos ? clients_[slot] : nullptr;
 }
+
+size_t OrderBookManager::GetInstrumentCount() const {
+    return books_.Size();
+}
+
+IngressRingStats OrderBookManager::GetIngressStats() const {
+    return ingress_ ? ingress_->GetStats() : IngressRingStats{};
+}
+
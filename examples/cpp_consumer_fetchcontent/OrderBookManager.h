@@ -1,8 +1,18 @@
 #pragma once
 
+#include <atomic>
+#include <cstddef>
 #include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "BookClock.h"
 #include "DatabentoMboClient.h"
+#include "IngressRing.h"
 #include "OrderBook.h"
+#include "OrderBookRegistry.h"
 #include "IClient.h"
 
 // Include Databento headers
@@ -14,26 +24,87 @@
 
 using namespace databento;
 
+// What the feed thread does when the ingress ring is full
+enum class IngressOverflow : uint8_t {
+    Block,  // Wait for the book thread (back-pressures the feed; nothing is lost)
+    Drop    // Count the command in overflows and drop it (the books drift from the exchange's)
+};
+
 /**
  * @brief Manager class to coordinate Databento data with the client
  * 
  * This class serves as a bridge between Databento data feeds and the client,
- * handling the data flow and client lifecycle management.
+ * handling the data flow and client lifecycle management. Each Databento
+ * instrument_id gets its own OrderBook and client (with its own portfolio
+ * and TOB tracker), created when the instrument first appears in the feed,
+ * so a parent subscription such as ES.FUT keeps every contract and spread
+ * in a separate book.
+ *
+ * With EnableIngressThread, OnMarketData only decodes the record into
+ * FeedCommands, pushes them onto an IngressRing and returns, so the feed
+ * thread never waits on matching, portfolio updates or CSV writes; a
+ * dedicated book thread drains the ring in batches and applies them. Symbol
+ * names, which do not fit a fixed-size command, are handed over through a
+ * locked map that only symbol mapping records touch.
  */
 class OrderBookManager {
 private:
-    std::shared_ptr<DatabentoMboClient> client_;
-    std::shared_ptr<OrderBook> order_book_;
+    // Advanced to each MBO record's ts_recv, so the books' own timestamps
+    // (and, with per-book trade IDs, their trades) repeat exactly on replay
+    std::shared_ptr<ReplayClock> feed_clock_;
+    OrderBookRegistry books_;
+    // Indexed by registry slot
+    std::vector<std::shared_ptr<DatabentoMboClient>> clients_;
+    uint64_t slippage_delay_ns_;
+    
+    // Feed thread -> book thread handoff (only when enabled)
+    std::unique_ptr<IngressRing<FeedCommand>> ingress_;
+    IngressOverflow overflow_ = IngressOverflow::Block;
+    std::thread book_thread_;
+    
+    // Written by the feed thread, read by whichever thread applies commands
+    std::mutex symbols_mutex_;
+    std::unordered_map<uint32_t, std::string> symbols_;
+    
+    void OnBookCreated(size_t slot, uint32_t instrument_id, const std::shared_ptr<OrderBook>& book);
+    KeepGoing RouteCommand(const FeedCommand& command);
+    void RunBookThread();
     
 public:
     OrderBookManager(uint64_t slippage_delay_ns = 1000000);  // Default 1ms slippage
+    ~OrderBookManager();
+    
+    /**
+     * @brief Process records on a dedicated book thread instead of the caller's
+     * @param capacity Commands the ring buffers before it is full
+     * @param wait_strategy How the idle book thread (and a feed thread blocked on a full ring) waits
+     * @param overflow Whether a full ring blocks the feed thread or drops the command
+     * Must be called before Start().
+     */
+    void EnableIngressThread(size_t capacity = 65536, WaitStrategy wait_strategy = WaitStrategy::Park,
+                             IngressOverflow overflow = IngressOverflow::Block);
     
     void Start();
+    /**
+     * @brief Drain the ingress ring, join the book thread and detach clients
+     *
+     * Stop the feed first (e.g. destroy the live client or let the replay
+     * return): the ring is closed here on the feed's behalf, which is only
+     * safe once nothing is pushing into it any more, and any record pushed
+     * after the close would never be processed.
+     */
     void Stop();
     
     // Bridge method for Databento callbacks
     KeepGoing OnMarketData(const Record& record);
     
-    // Provide access to client for additional operations
+    // Provide access to client for additional operations (first instrument seen)
     std::shared_ptr<IClient> GetClient();
+    // Client for one instrument, or nullptr if it has not appeared in the feed
+    std::shared_ptr<IClient> GetClient(uint32_t instrument_id);
+    size_t GetInstrumentCount() const;
+    
+    // Ingress ring counters (all zero unless the ingress thread is enabled);
+    // with IngressOverflow::Drop, overflows is the number of commands dropped
+    IngressRingStats GetIngressStats() const;
 };
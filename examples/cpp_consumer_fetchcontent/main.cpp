@@ -48,33 +48,39 @@ void runLiveDataDemo() {
     try {
         // Initialize with 500 microseconds slippage for live data
         OrderBookManager manager(500000);  // 0.5ms slippage delay
-        
-        auto client = LiveBuilder{}
-                          .SetKeyFromEnv()
-                          .SetDataset(Dataset::GlbxMdp3)
-                          .BuildThreaded();
-        
-        auto handler = [&manager](const Record& rec) {
-            return manager.OnMarketData(rec);
-        };
-        
-        std::cout << "Starting live data stream for ES futures..." << std::endl;
-        
-        // Subscribe to MBO (Market By Order) data for full order book reconstruction
-        client.Subscribe({"ES.FUT"}, Schema::Mbo, SType::Parent);
-        
-        // Also subscribe to trades and quotes for comparison and market context
-        client.Subscribe({"ES.FUT"}, Schema::Trades, SType::Parent);
-        client.Subscribe({"ES.FUT"}, Schema::Mbp1, SType::Parent);
+        // Keep matching and CSV output off the feed thread
+        manager.EnableIngressThread();
         
         manager.Start();
-        client.Start(handler);
-        
-        // Run for 30 seconds
-        std::this_thread::sleep_for(std::chrono::seconds{30});
+        {
+            auto client = LiveBuilder{}
+                              .SetKeyFromEnv()
+                              .SetDataset(Dataset::GlbxMdp3)
+                              .BuildThreaded();
+            
+            auto handler = [&manager](const Record& rec) {
+                return manager.OnMarketData(rec);
+            };
+            
+            std::cout << "Starting live data stream for ES futures..." << std::endl;
+            
+            // Subscribe to MBO (Market By Order) data for full order book reconstruction
+            client.Subscribe({"ES.FUT"}, Schema::Mbo, SType::Parent);
+            
+            // Also subscribe to trades and quotes for comparison and market context
+            client.Subscribe({"ES.FUT"}, Schema::Trades, SType::Parent);
+            client.Subscribe({"ES.FUT"}, Schema::Mbp1, SType::Parent);
+            
+            client.Start(handler);
+            
+            // Run for 30 seconds
+            std::this_thread::sleep_for(std::chrono::seconds{30});
+        }  // Destroying the client stops and joins its feed thread
         
+        // Only once the feed thread is gone may the manager close the ring
         manager.Stop();
-        std::cout << "Live data demo completed." << std::endl;
+        std::cout << "Live data demo completed (" << manager.GetInstrumentCount()
+                  << " instruments booked)." << std::endl;
         
     } catch (const std::exception& e) {
         std::cout << "Live data demo error: " << e.what() << std::endl;
@@ -0,0 +1,1226 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "PriceLevel.h"
+#include "PriceLadder.h"
+#include "OrderPool.h"
+#include "OrderIndex.h"
+#include "OrderResult.h"
+#include "BookCheckpoint.h"
+#include "BookClock.h"
+#include "BookCommand.h"
+#include "BookListener.h"
+#include "CommandJournal.h"
+#include "ExecutionIdSource.h"
+#include "Helpers.h"
+#include "MarketDepth.h"
+#include "SidePolicy.h"
+#include "Trade.h"
+// Forward declaration
+struct Order;
+struct Trade;
+class IClient;
+
+// Best prices and the volume resting at each (zeros for an empty side)
+struct TopOfBook {
+    uint64_t best_bid = 0;
+    uint64_t best_ask = 0;
+    uint64_t bid_volume = 0;
+    uint64_t ask_volume = 0;
+
+    bool operator==(const TopOfBook& other) const {
+        return best_bid == other.best_bid && best_ask == other.best_ask && bid_volume == other.bid_volume &&
+               ask_volume == other.ask_volume;
+    }
+    bool operator!=(const TopOfBook& other) const { return !(*this == other); }
+};
+
+// Construction-time settings for an OrderBook
+struct OrderBookConfig {
+    OrderPoolConfig order_pool;
+    // Level storage backend (std::map or flat tick array), chosen per instrument
+    PriceLadderConfig price_ladder;
+    // Time source; null means the wall clock. Inject a ReplayClock to make
+    // replays reproducible.
+    std::shared_ptr<BookClock> clock;
+    // Trade ID source; null (the default) means the book's own plain counter,
+    // 1, 2, ..., which needs no atomics and repeats exactly on replay.
+    // GlobalExecutionIdSource restores one process-wide sequence.
+    std::shared_ptr<ExecutionIdSource> execution_ids;
+    // Namespaces the book's own counter: a non-zero book_id makes IDs
+    // (book_id << 32) | sequence, unique across books without a shared
+    // counter. OrderBookRegistry sets it to the instrument ID. Such a book
+    // has 2^32 - 1 IDs; once a command could run past the last one it is
+    // rejected with ExecutionIdsExhausted rather than reuse the next book's.
+    uint32_t book_id = 0;
+    // A clock or ID source is shared by every book built from this config
+    // and called without locking, so books on different threads need their own
+};
+
+/**
+ * @brief Limit order book whose events go to a compile-time Listener
+ *
+ * Every trade, ack, cancel, modify, rejection and top-of-book change is
+ * reported by calling the matching hook on the book's Listener (see
+ * BookListener). The hooks are resolved statically, so a listener known at
+ * compile time costs no virtual calls, no map walk and no exception frames.
+ * OrderBook (BasicOrderBook<ClientRegistryListener>) keeps the runtime
+ * RegisterClient/UnregisterClient API on top of the same code.
+ */
+template <typename Listener>
+class BasicOrderBook {
+public:
+    // Constructor and destructor
+    explicit BasicOrderBook(const OrderBookConfig& config = OrderBookConfig(), Listener listener = Listener());
+    ~BasicOrderBook() = default; // Orders are owned by the pool and freed with it
+    
+    // Disable copy/move to avoid issues with raw pointers
+    BasicOrderBook(const BasicOrderBook&) = delete;
+    BasicOrderBook& operator=(const BasicOrderBook&) = delete;
+    BasicOrderBook(BasicOrderBook&&) = delete;
+    BasicOrderBook& operator=(BasicOrderBook&&) = delete;
+    
+    // Public API for users; these throw std::invalid_argument / std::runtime_error
+    // on rejection and are thin wrappers over the Try* API below
+    void AddOrder(uint64_t order_id, uint64_t user_id, bool is_buy, uint64_t quantity, uint64_t price, 
+                  uint64_t ts_received, uint64_t ts_executed);
+    void AddOrder(uint64_t order_id, uint64_t user_id, bool is_buy, uint64_t quantity, uint64_t price); // Legacy version
+    void CancelOrder(uint64_t order_id);
+    void ModifyOrder(uint64_t order_id, uint64_t new_quantity, uint64_t new_price);
+
+    // Non-throwing API for feed replay, where duplicate and unknown IDs are
+    // routine: rejections come back as an OrderStatus instead of an exception.
+    // Clients are notified exactly as with the throwing versions. Orders hold
+    // a 32-bit quantity, so anything above UINT32_MAX is QuantityTooLarge. An
+    // add or modify claims any memory it needs (pool slot, index entry, price
+    // level) before it changes the book, and is rejected with
+    // CapacityExhausted if that fails; a cancel never allocates. The calls
+    // are noexcept, so an exception from a listener or the clock still
+    // terminates the process.
+    // An add priced off the tick grid is refused outright; one on the grid
+    // but outside what the ladder can hold still trades, and only a
+    // remainder that would have to rest there is dropped (PriceOffGrid,
+    // state Cancelled, with filled_quantity set).
+    OrderResult TryAddOrder(uint64_t order_id, uint64_t user_id, bool is_buy, uint64_t quantity, uint64_t price,
+                            uint64_t ts_received, uint64_t ts_executed) noexcept;
+    OrderResult TryCancelOrder(uint64_t order_id) noexcept;
+    // A modify that loses time priority stamps the order's ts_executed with
+    // the given time, or with the book's clock if it is 0 (as the 3-argument
+    // version always does)
+    OrderResult TryModifyOrder(uint64_t order_id, uint64_t new_quantity, uint64_t new_price) noexcept {
+        return TryModifyOrder(order_id, new_quantity, new_price, 0);
+    }
+    OrderResult TryModifyOrder(uint64_t order_id, uint64_t new_quantity, uint64_t new_price,
+                               uint64_t ts_executed) noexcept;
+
+    // Run a single command through the matching Try* call
+    OrderResult Apply(const BookCommand& command) noexcept;
+
+    /**
+     * @brief Apply a contiguous run of commands with one client fan-out
+     *
+     * Commands are applied in order exactly as the Try* calls would, but the
+     * resulting callbacks (trades, acks, cancels, modifies, rejections) are
+     * collected in reusable buffers and delivered once the whole batch is done,
+     * each client receiving them in order, followed by a single top-of-book
+     * update if any command changed the book. If results is not null it must
+     * have room for count entries and receives each command's outcome.
+     * Returns the number of commands that succeeded. Should a buffer fail to
+     * grow, everything held back so far is delivered on the spot and the
+     * batch carries on from there, so clients still see every callback, in
+     * order, just in more than one burst.
+     */
+    size_t ApplyBatch(const BookCommand* commands, size_t count, OrderResult* results = nullptr) noexcept;
+    // Sizes *results first, so if that throws nothing has been applied
+    size_t ApplyBatch(const std::vector<BookCommand>& commands, std::vector<OrderResult>* results = nullptr) {
+        if (results) results->resize(commands.size());
+        return ApplyBatch(commands.data(), commands.size(), results ? results->data() : nullptr);
+    }
+
+    /**
+     * @brief Group operations that make up one exchange event
+     *
+     * Between BeginEvent and the matching EndEvent, top-of-book changes are
+     * held back and published once, at EndEvent, if the top differs from the
+     * last one published (e.g. a Databento MBO event runs up to the record
+     * flagged F_LAST). Other callbacks are delivered as usual. Calls nest.
+     */
+    void BeginEvent() { ++event_depth_; }
+    void EndEvent();
+
+    /**
+     * @brief Record every accepted command in a write-ahead journal
+     *
+     * Adds, cancels and modifies that succeed are appended to journal
+     * before they change the book; rejections are not journaled. A command
+     * the journal cannot take (e.g. disk full) is rejected with
+     * OrderStatus::JournalWriteFailed and leaves the book unchanged. A
+     * modify is journaled with the time it stamps, so recovery reproduces
+     * the book's timestamps whatever clock the recovering book has. The
+     * journal is not owned and must outlive the book or be detached with
+     * SetJournal(nullptr). Rebuild a book from it with RecoverFromJournal.
+     */
+    void SetJournal(CommandJournal* journal) { journal_ = journal; }
+    CommandJournal* GetJournal() const { return journal_; }
+
+    // The book's event sink
+    Listener& GetListener() { return listener_; }
+    const Listener& GetListener() const { return listener_; }
+
+    // Client management (only for listeners with a runtime client registry,
+    // i.e. OrderBook)
+    void RegisterClient(std::shared_ptr<IClient> client) { listener_.RegisterClient(std::move(client)); }
+    void UnregisterClient(uint64_t client_id) { listener_.UnregisterClient(client_id); }
+
+    // Public API for data retrieval
+    uint64_t GetBestBid() const;
+    uint64_t GetBestAsk() const;
+
+    /**
+     * @brief Copy the best max_levels levels of one side into out, best first
+     *
+     * out must have room for max_levels entries; nothing is allocated.
+     * Returns the number of levels written (fewer if the side is shallower).
+     */
+    size_t GetDepth(BookSide side, size_t max_levels, DepthLevel* out) const;
+
+    // Volume resting at the best price (0 if the side is empty)
+    uint64_t GetBestBidVolume() const;
+    uint64_t GetBestAskVolume() const;
+
+    TopOfBook GetTopOfBook() const {
+        return TopOfBook{GetBestBid(), GetBestAsk(), GetBestBidVolume(), GetBestAskVolume()};
+    }
+
+    uint64_t GetTotalBidVolume() const { return total_bid_volume_; }
+    uint64_t GetTotalAskVolume() const { return total_ask_volume_; }
+
+    // Order storage statistics (capacity, orders in use, growth)
+    const OrderPool& GetOrderPool() const { return order_pool_; }
+
+    /**
+     * @brief Write every resting order to a binary checkpoint
+     *
+     * Levels are written best first and each level's orders in time
+     * priority, together with info, so LoadCheckpoint rebuilds the same
+     * book (see BookCheckpoint.h for the format). Throws std::runtime_error
+     * if the output cannot be written.
+     */
+    void SaveCheckpoint(std::ostream& out, const CheckpointInfo& info = CheckpointInfo()) const;
+    void SaveCheckpoint(const std::string& path, const CheckpointInfo& info = CheckpointInfo()) const;
+
+    /**
+     * @brief Rebuild an empty book from a checkpoint and return its info
+     *
+     * Orders are linked straight into their levels in saved order: nothing
+     * is matched and no per-order callbacks are made. The book's execution
+     * sequence resumes from the saved one, so trade IDs are not reissued. A listener that wants
+     * level updates gets an Add for each level, then the top of book is
+     * published once. Throws std::runtime_error if the book is not empty or
+     * the checkpoint is damaged (level order counts that disagree with the
+     * header, records left over) or does not fit this book (price the ladder
+     * cannot hold, quantity over 32 bits, levels out of order, duplicate
+     * order IDs, crossed book);
+     * the book is left empty in that case.
+     */
+    CheckpointInfo LoadCheckpoint(std::istream& in);
+    CheckpointInfo LoadCheckpoint(const std::string& path);
+
+private:
+    // Owns every Order in the book; declared first so it outlives order_map_
+    OrderPool order_pool_;
+    // The core hybrid data structure: order ID -> resting order
+    OrderIndex order_map_;
+    // Price levels per side, best price first
+    std::unique_ptr<PriceLadder> bids_;
+    std::unique_ptr<PriceLadder> asks_;
+    // Timestamps for commands that arrive without one
+    std::shared_ptr<BookClock> clock_;
+    // Trade IDs: an injected source if any, else base + per-book sequence
+    std::shared_ptr<ExecutionIdSource> execution_ids_;
+    uint64_t execution_id_base_ = 0;
+    uint64_t last_execution_sequence_ = 0;
+    uint64_t max_execution_sequence_ = UINT64_MAX;
+    
+    // Market data maintained incrementally on every mutation so the getters
+    // above are O(1). The best-level pointers are refreshed from the ladder
+    // whenever a level is created or erased (which is also the only time a
+    // ladder can move its level slab).
+    uint64_t total_bid_volume_ = 0;
+    uint64_t total_ask_volume_ = 0;
+    PriceLevel* best_bid_level_ = nullptr;
+    PriceLevel* best_ask_level_ = nullptr;
+    
+    // Callbacks held back while ApplyBatch runs; the buffers keep their
+    // capacity between batches
+    struct PendingNotification {
+        enum class Kind : uint8_t { Trade, Acknowledged, Cancelled, Modified, Rejected, LevelUpdate };
+        Kind kind;
+        OrderStatus status;     // Rejected
+        uint64_t order_id;
+        uint64_t quantity;      // Modified
+        uint64_t price;         // Modified
+        size_t index;           // Trade / LevelUpdate: index into pending_trades_ / pending_level_updates_
+    };
+    bool deferring_notifications_ = false;
+    bool top_of_book_pending_ = false;
+    // Open BeginEvent calls
+    unsigned event_depth_ = 0;
+    // Write-ahead journal for accepted commands (not owned; null when off)
+    CommandJournal* journal_ = nullptr;
+    // Last top of book handed to the listener; an update that would repeat
+    // it (e.g. a cancel below the best level) is dropped
+    TopOfBook published_top_of_book_;
+    std::vector<PendingNotification> pending_notifications_;
+    std::vector<Trade> pending_trades_;
+    std::vector<LevelUpdate> pending_level_updates_;
+    
+    // Per-side state, selected at compile time
+    template <BookSide Side> PriceLadder& Ladder();
+    template <BookSide Side> PriceLevel*& BestLevel();
+    template <BookSide Side> uint64_t& SideVolume();
+
+    // Link an order into / out of its price level, keeping the side's volume
+    // and best level up to date (the order map is left to the caller). The
+    // untemplated versions dispatch on the order's side.
+    void AddRestingOrder(OrderHandle handle);
+    void RemoveRestingOrder(OrderHandle handle);
+    template <BookSide Side> void AddRestingOrder(OrderHandle handle);
+    template <BookSide Side> void RemoveRestingOrder(OrderHandle handle);
+    // Level a resting order is queued in, straight from the handle it carries
+    PriceLevel* RestingLevel(const Order& order);
+    // Allocate ahead whatever resting an order at price on its side may
+    // need, so a command cannot run out of memory part way through; false
+    // if the memory could not be had
+    bool PrepareToRest(bool is_buy, uint64_t price) noexcept;
+
+    // Checkpoint helpers: one side's levels out / back in, and dropping
+    // everything if a restore fails part way
+    void WriteCheckpoint(CheckpointWriter& writer, const CheckpointInfo& info) const;
+    CheckpointInfo RestoreCheckpoint(CheckpointReader& reader);
+    template <BookSide Side> void WriteCheckpointSide(CheckpointWriter& writer) const;
+    template <BookSide Side> void RestoreCheckpointSide(CheckpointReader& reader, uint64_t level_count);
+    void ClearBook();
+
+    // Whether an order at this price would trade with the opposite best level
+    bool CrossesOppositeBest(bool is_buy, uint64_t price) const;
+    // Whether the book's own execution sequence can cover any match: one
+    // trade at most per resting order (always true with an injected source)
+    bool HasExecutionIdsForMatch() const {
+        return execution_ids_ || max_execution_sequence_ - last_execution_sequence_ >= order_map_.Size();
+    }
+    // Matching logic; trades are reported to clients as they execute.
+    // Returns the quantity filled.
+    uint64_t MatchOrders(OrderHandle incoming);
+    template <BookSide Side> uint64_t MatchOrders(OrderHandle incoming);
+    // Notify clients of a rejection and build the matching result
+    OrderResult Reject(uint64_t order_id, OrderStatus status) noexcept;
+    
+    // Client notification methods
+    void NotifyTradeExecuted(const Trade& trade);
+    void NotifyOrderAcknowledged(uint64_t order_id);
+    void NotifyOrderCancelled(uint64_t order_id);
+    void NotifyOrderModified(uint64_t order_id, uint64_t new_quantity, uint64_t new_price);
+    void NotifyOrderRejected(uint64_t order_id, OrderStatus status);
+    // Report a level's new aggregate state; for Remove, level is null
+    void NotifyLevelUpdate(BookSide side, LevelAction action, uint64_t price, const PriceLevel* level);
+    // Publish the top of book if it changed (held back during batches and events)
+    void NotifyTopOfBookUpdate();
+    // Hold a callback back for the end of the batch (a trade or level update
+    // passes its payload). Returns false if the buffers could not grow: what
+    // was held back has then been delivered, and the caller delivers this
+    // callback directly, so the order clients see is unchanged.
+    bool Defer(typename PendingNotification::Kind kind, uint64_t order_id, uint64_t quantity = 0,
+               uint64_t price = 0, OrderStatus status = OrderStatus::Ok, const Trade* trade = nullptr,
+               const LevelUpdate* update = nullptr);
+    // Deliver the callbacks held back so far
+    void DeliverPending();
+    // Deliver everything held back during a batch, then the top of book
+    void FlushNotifications();
+    // Map a rejected result onto the exception the throwing API has always used
+    static void ThrowIfRejected(const OrderResult& result);
+
+    // Declared last so it is destroyed first, while the book is still intact
+    Listener listener_;
+};
+
+
+template <typename Listener>
+BasicOrderBook<Listener>::BasicOrderBook(const OrderBookConfig& config, Listener listener)
+    : order_pool_(config.order_pool),
+      order_map_(config.order_pool.initial_capacity),
+      bids_(MakePriceLadder(BookSide::Bid, config.price_ladder)),
+      asks_(MakePriceLadder(BookSide::Ask, config.price_ladder)),
+      clock_(config.clock ? config.clock : std::make_shared<SystemBookClock>()),
+      execution_ids_(config.execution_ids),
+      execution_id_base_(static_cast<uint64_t>(config.book_id) << 32),
+      max_execution_sequence_(config.book_id != 0 ? UINT32_MAX : UINT64_MAX),
+      listener_(std::move(listener)) {
+}
+
+template <typename Listener>
+void BasicOrderBook<Listener>::ThrowIfRejected(const OrderResult& result) {
+    switch (result.status) {
+        case OrderStatus::Ok:
+            return;
+        case OrderStatus::ZeroQuantity:
+        case OrderStatus::ZeroModifiedQuantity:
+        case OrderStatus::QuantityTooLarge:
+        case OrderStatus::PriceOffGrid:
+            throw std::invalid_argument(ToString(result.status));
+        default:
+            throw std::runtime_error(ToString(result.status));
+    }
+}
+
+// Simplified AddOrder logic for illustration
+template <typename Listener>
+void BasicOrderBook<Listener>::AddOrder(uint64_t order_id, uint64_t user_id, bool is_buy, uint64_t quantity, uint64_t price) {
+    // Stamp the order from the book's clock - use for both received and executed
+    uint64_t timestamp = clock_->Now();
+    ThrowIfRejected(TryAddOrder(order_id, user_id, is_buy, quantity, price, timestamp, timestamp));
+}
+
+// Timestamp-aware AddOrder that uses historical timestamps
+template <typename Listener>
+void BasicOrderBook<Listener>::AddOrder(uint64_t order_id, uint64_t user_id, bool is_buy, uint64_t quantity, uint64_t price, 
+                        uint64_t ts_received, uint64_t ts_executed) {
+    ThrowIfRejected(TryAddOrder(order_id, user_id, is_buy, quantity, price, ts_received, ts_executed));
+}
+
+template <typename Listener>
+void BasicOrderBook<Listener>::CancelOrder(uint64_t order_id) {
+    ThrowIfRejected(TryCancelOrder(order_id));
+}
+
+template <typename Listener>
+void BasicOrderBook<Listener>::ModifyOrder(uint64_t order_id, uint64_t new_quantity, uint64_t new_price) {
+    ThrowIfRejected(TryModifyOrder(order_id, new_quantity, new_price));
+}
+
+template <typename Listener>
+OrderResult BasicOrderBook<Listener>::TryAddOrder(uint64_t order_id, uint64_t user_id, bool is_buy, uint64_t quantity, uint64_t price,
+                                   uint64_t ts_received, uint64_t ts_executed) noexcept {
+    // 1. Validate inputs
+    if (quantity == 0) {
+        return Reject(order_id, OrderStatus::ZeroQuantity);
+    }
+    if (quantity > UINT32_MAX) {
+        return Reject(order_id, OrderStatus::QuantityTooLarge);
+    }
+    
+    // Off-grid prices are refused outright. Whether the ladder's window can
+    // hold the price only matters for a remainder that rests; matching never
+    // changes this side, so it can be decided now.
+    const PriceLadder& own_side = is_buy ? *bids_ : *asks_;
+    if (!own_side.OnGrid(price)) {
+        return Reject(order_id, OrderStatus::PriceOffGrid);
+    }
+    const bool can_rest = own_side.Accepts(price);
+    const bool crosses = CrossesOppositeBest(is_buy, price);
+    if (!crosses && !can_rest) {
+        return Reject(order_id, OrderStatus::PriceOffGrid);
+    }
+    if (crosses && !HasExecutionIdsForMatch()) {
+        return Reject(order_id, OrderStatus::ExecutionIdsExhausted);
+    }
+
+    // 2. Claim everything the add may allocate before anything changes: the
+    //    level a remainder would rest in, then a new order object from the
+    //    pool using provided timestamps, then its index entry. The insert
+    //    doubles as the duplicate-ID check, so an add touches the order
+    //    index exactly once.
+    if (can_rest && !PrepareToRest(is_buy, price)) {
+        return Reject(order_id, OrderStatus::CapacityExhausted);
+    }
+    OrderHandle new_handle = order_pool_.TryAcquire(Order{order_id, price, static_cast<uint32_t>(quantity), is_buy},
+                                                    OrderDetails{user_id, ts_received, ts_executed});
+    if (new_handle == kNoOrder) {
+        return Reject(order_id, OrderStatus::CapacityExhausted);
+    }
+    bool indexed = false;
+    try {
+        indexed = order_map_.Insert(order_id, new_handle);
+    } catch (const std::exception&) {
+        // Growing the index failed; it is unchanged
+        order_pool_.Release(new_handle);
+        return Reject(order_id, OrderStatus::CapacityExhausted);
+    }
+    if (!indexed) {
+        order_pool_.Release(new_handle);
+        return Reject(order_id, OrderStatus::DuplicateOrderId);
+    }
+    if (journal_ != nullptr &&
+        journal_->Append(BookCommand::Add(order_id, user_id, is_buy, quantity, price, ts_received, ts_executed)) == 0) {
+        order_map_.Erase(order_id);
+        order_pool_.Release(new_handle);
+        return Reject(order_id, OrderStatus::JournalWriteFailed);
+    }
+    Order& new_order = order_pool_.Get(new_handle);
+
+    // 3. Match against the book only if the order can reach the opposite
+    //    best price; passive adds (most of an MBO feed) skip matching entirely.
+    //    Clients are notified of each trade as it executes.
+    OrderResult result;
+    if (crosses) {
+        result.filled_quantity = MatchOrders(new_handle);
+    }
+
+    // 4. If order has remaining quantity, add it as a resting order
+    if (new_order.quantity > 0 && !can_rest) {
+        // Priced beyond what this side can hold: the fills stand, the rest is dropped
+        result.status = OrderStatus::PriceOffGrid;
+        result.state = OrderState::Cancelled;
+        order_map_.Erase(order_id);
+        order_pool_.Release(new_handle);
+        NotifyOrderRejected(order_id, OrderStatus::PriceOffGrid);
+    } else if (new_order.quantity > 0) {
+        result.state = OrderState::Resting;
+        result.resting_quantity = new_order.quantity;
+        AddRestingOrder(new_handle);
+        // Notify clients that order was acknowledged
+        NotifyOrderAcknowledged(order_id);
+    } else {
+        // Order fully filled, drop it from the index and return it to the pool
+        result.state = OrderState::Filled;
+        order_map_.Erase(order_id);
+        order_pool_.Release(new_handle);
+    }
+    // Resting or trading may have moved the top of book (published only if it did)
+    NotifyTopOfBookUpdate();
+    return result;
+}
+
+// Simplified cancellation logic
+template <typename Listener>
+OrderResult BasicOrderBook<Listener>::TryCancelOrder(uint64_t order_id) noexcept {
+    OrderHandle order_to_cancel = order_map_.Find(order_id);
+    if (order_to_cancel == kNoOrder) {
+        return Reject(order_id, OrderStatus::OrderNotFound);
+    }
+    if (journal_ != nullptr && journal_->Append(BookCommand::Cancel(order_id)) == 0) {
+        return Reject(order_id, OrderStatus::JournalWriteFailed);
+    }
+
+    // O(1) removal from the PriceLevel's list, dropping the level if it is now empty
+    RemoveRestingOrder(order_to_cancel);
+
+    // O(1) removal from the main map
+    order_map_.Erase(order_id);
+
+    // Release memory (back to the pool)
+    order_pool_.Release(order_to_cancel);
+    
+    // Notify clients
+    NotifyOrderCancelled(order_id);
+    NotifyTopOfBookUpdate();
+
+    OrderResult result;
+    result.state = OrderState::Cancelled;
+    return result;
+}
+
+template <typename Listener>
+OrderResult BasicOrderBook<Listener>::Apply(const BookCommand& command) noexcept {
+    switch (command.type) {
+        case BookCommandType::Add:
+            return TryAddOrder(command.order_id, command.user_id, command.is_buy, command.quantity, command.price,
+                               command.ts_received, command.ts_executed);
+        case BookCommandType::Cancel:
+            return TryCancelOrder(command.order_id);
+        case BookCommandType::Modify:
+            return TryModifyOrder(command.order_id, command.quantity, command.price, command.ts_executed);
+    }
+    return OrderResult{};
+}
+
+template <typename Listener>
+size_t BasicOrderBook<Listener>::ApplyBatch(const BookCommand* commands, size_t count, OrderResult* results) noexcept {
+    deferring_notifications_ = true;
+    size_t applied = 0;
+    for (size_t i = 0; i < count; ++i) {
+        // Start pulling the next command's index slot into cache while this one runs
+        if (i + 1 < count) {
+            order_map_.Prefetch(commands[i + 1].order_id);
+        }
+        OrderResult result = Apply(commands[i]);
+        applied += result.Ok() ? 1 : 0;
+        if (results) {
+            results[i] = result;
+        }
+    }
+    deferring_notifications_ = false;
+    FlushNotifications();
+    return applied;
+}
+
+template <typename Listener>
+OrderResult BasicOrderBook<Listener>::Reject(uint64_t order_id, OrderStatus status) noexcept {
+    NotifyOrderRejected(order_id, status);
+    OrderResult result;
+    result.status = status;
+    return result;
+}
+
+template <typename Listener>
+template <BookSide Side>
+PriceLadder& BasicOrderBook<Listener>::Ladder() {
+    return Side == BookSide::Bid ? *bids_ : *asks_;
+}
+
+template <typename Listener>
+template <BookSide Side>
+PriceLevel*& BasicOrderBook<Listener>::BestLevel() {
+    return Side == BookSide::Bid ? best_bid_level_ : best_ask_level_;
+}
+
+template <typename Listener>
+template <BookSide Side>
+uint64_t& BasicOrderBook<Listener>::SideVolume() {
+    return Side == BookSide::Bid ? total_bid_volume_ : total_ask_volume_;
+}
+
+template <typename Listener>
+bool BasicOrderBook<Listener>::CrossesOppositeBest(bool is_buy, uint64_t price) const {
+    if (is_buy) {
+        return best_ask_level_ != nullptr && SidePolicy<BookSide::Bid>::Crosses(price, best_ask_level_->GetPrice());
+    }
+    return best_bid_level_ != nullptr && SidePolicy<BookSide::Ask>::Crosses(price, best_bid_level_->GetPrice());
+}
+
+template <typename Listener>
+uint64_t BasicOrderBook<Listener>::MatchOrders(OrderHandle incoming) {
+    return order_pool_.Get(incoming).IsBuy() ? MatchOrders<BookSide::Bid>(incoming)
+                                                 : MatchOrders<BookSide::Ask>(incoming);
+}
+
+// Match an incoming order on Side against the opposite side, best level first
+template <typename Listener>
+template <BookSide Side>
+uint64_t BasicOrderBook<Listener>::MatchOrders(OrderHandle incoming) {
+    constexpr BookSide Opposite = SidePolicy<Side>::Opposite;
+    PriceLadder& resting_side = Ladder<Opposite>();
+    PriceLevel*& best_level = BestLevel<Opposite>();
+    uint64_t& resting_volume = SideVolume<Opposite>();
+    Order& incoming_order = order_pool_.Get(incoming);
+    uint64_t initial_quantity = incoming_order.quantity;
+    // Read once from the pool's cold array; every trade below carries them
+    const OrderDetails incoming_details = order_pool_.Details(incoming);
+
+    // Called by the level for every execution: reclaim fully filled resting
+    // orders and notify clients straight away, with no trade buffer. The
+    // level reports completion itself, so partial fills never touch the
+    // order index and a completed order costs a single erase.
+    auto on_trade = [this](const Trade& trade, OrderHandle completed_order) {
+        if (completed_order != kNoOrder) {
+            // Order fully filled, remove from map and return to the pool
+            order_map_.Erase(trade.resting_order_id);
+            order_pool_.Release(completed_order);
+        }
+        NotifyTradeExecuted(trade);
+    };
+    auto next_execution_id = [this] {
+        return execution_ids_ ? execution_ids_->Next() : execution_id_base_ + ++last_execution_sequence_;
+    };
+
+    PriceLevel* price_level = best_level;
+    while (price_level != nullptr && incoming_order.quantity > 0) {
+        uint64_t level_price = price_level->GetPrice();
+
+        // Stop at the first level the incoming limit does not reach
+        if (!SidePolicy<Side>::Crosses(incoming_order.price, level_price)) {
+            break;
+        }
+
+        // Fill as much as possible at this price level
+        uint32_t quantity_to_fill =
+            static_cast<uint32_t>(std::min<uint64_t>(incoming_order.quantity, price_level->GetTotalVolume()));
+
+        // Reduce incoming order quantity and the resting side's total up
+        // front, so clients notified mid-fill see the post-trade totals
+        incoming_order.quantity -= quantity_to_fill;
+        resting_volume -= quantity_to_fill;
+
+        // Fill from this price level, handling each trade as it executes
+        price_level->FillOrder(order_pool_, incoming_order, quantity_to_fill, incoming_details, next_execution_id,
+                               on_trade);
+
+        // A level that is not emptied has absorbed the rest of the order
+        if (price_level->GetTotalVolume() != 0) {
+            NotifyLevelUpdate(Opposite, LevelAction::Update, level_price, price_level);
+            break;
+        }
+        // Remove the empty level and move on to the next best one
+        NotifyLevelUpdate(Opposite, LevelAction::Remove, level_price, nullptr);
+        resting_side.Erase(level_price);
+        best_level = resting_side.Best();
+        price_level = best_level;
+    }
+
+    return initial_quantity - incoming_order.quantity;
+}
+
+template <typename Listener>
+uint64_t BasicOrderBook<Listener>::GetBestAsk() const {
+    if (best_ask_level_ == nullptr) {
+        return 0; // No asks available
+    }
+    return best_ask_level_->GetPrice(); // Return the lowest ask price
+}
+template <typename Listener>
+uint64_t BasicOrderBook<Listener>::GetBestBid() const {
+    if (best_bid_level_ == nullptr) {
+        return 0; // No bids available
+    }
+    return best_bid_level_->GetPrice(); // Return the highest bid price
+}
+template <typename Listener>
+uint64_t BasicOrderBook<Listener>::GetBestAskVolume() const {
+    return best_ask_level_ ? best_ask_level_->GetTotalVolume() : 0;
+}
+template <typename Listener>
+uint64_t BasicOrderBook<Listener>::GetBestBidVolume() const {
+    return best_bid_level_ ? best_bid_level_->GetTotalVolume() : 0;
+}
+
+template <typename Listener>
+size_t BasicOrderBook<Listener>::GetDepth(BookSide side, size_t max_levels, DepthLevel* out) const {
+    const PriceLadder& ladder = side == BookSide::Bid ? *bids_ : *asks_;
+    const PriceLevel* level = side == BookSide::Bid ? best_bid_level_ : best_ask_level_;
+    size_t count = 0;
+    while (level != nullptr && count < max_levels) {
+        out[count++] = DepthLevel{level->GetPrice(), level->GetTotalVolume(), level->GetOrderCount()};
+        level = ladder.NextWorse(level->GetPrice());
+    }
+    return count;
+}
+
+template <typename Listener>
+void BasicOrderBook<Listener>::SaveCheckpoint(std::ostream& out, const CheckpointInfo& info) const {
+    CheckpointWriter writer(out);
+    WriteCheckpoint(writer, info);
+}
+
+template <typename Listener>
+void BasicOrderBook<Listener>::SaveCheckpoint(const std::string& path, const CheckpointInfo& info) const {
+    CheckpointWriter writer(path);
+    WriteCheckpoint(writer, info);
+}
+
+template <typename Listener>
+void BasicOrderBook<Listener>::WriteCheckpoint(CheckpointWriter& writer, const CheckpointInfo& info) const {
+    CheckpointHeader header;
+    header.sequence = info.sequence;
+    header.timestamp = info.timestamp;
+    header.bid_levels = bids_->LevelCount();
+    header.ask_levels = asks_->LevelCount();
+    header.orders = order_map_.Size();
+    header.execution_sequence = last_execution_sequence_;
+    writer.WriteHeader(header);
+    WriteCheckpointSide<BookSide::Bid>(writer);
+    WriteCheckpointSide<BookSide::Ask>(writer);
+    writer.Finish();
+}
+
+template <typename Listener>
+template <BookSide Side>
+void BasicOrderBook<Listener>::WriteCheckpointSide(CheckpointWriter& writer) const {
+    const PriceLadder& ladder = Side == BookSide::Bid ? *bids_ : *asks_;
+    for (const PriceLevel* level = ladder.Best(); level != nullptr; level = ladder.NextWorse(level->GetPrice())) {
+        writer.WriteLevel(CheckpointLevel{level->GetPrice(), level->GetOrderCount()});
+        for (OrderHandle handle = level->GetTopOrder(); handle != kNoOrder;
+             handle = order_pool_.Get(handle).next_in_level) {
+            const Order& order = order_pool_.Get(handle);
+            const OrderDetails& details = order_pool_.Details(handle);
+            writer.WriteOrder(CheckpointOrder{order.order_id, details.user_id, order.quantity, details.ts_received,
+                                              details.ts_executed});
+        }
+    }
+}
+
+template <typename Listener>
+CheckpointInfo BasicOrderBook<Listener>::LoadCheckpoint(std::istream& in) {
+    CheckpointReader reader(in);
+    return RestoreCheckpoint(reader);
+}
+
+template <typename Listener>
+CheckpointInfo BasicOrderBook<Listener>::LoadCheckpoint(const std::string& path) {
+    CheckpointReader reader(path);
+    return RestoreCheckpoint(reader);
+}
+
+template <typename Listener>
+CheckpointInfo BasicOrderBook<Listener>::RestoreCheckpoint(CheckpointReader& reader) {
+    if (!order_map_.Empty()) {
+        throw std::runtime_error("A checkpoint can only be loaded into an empty book");
+    }
+    const CheckpointHeader& header = reader.Header();
+
+    if (header.execution_sequence > max_execution_sequence_) {
+        throw std::runtime_error("Checkpoint execution sequence " + std::to_string(header.execution_sequence) +
+                                 " is beyond this book's execution ID range");
+    }
+    // Size the pool and index once instead of growing them order by order
+    order_pool_.Reserve(header.orders);
+    order_map_.Reserve(header.orders);
+    try {
+        RestoreCheckpointSide<BookSide::Bid>(reader, header.bid_levels);
+        RestoreCheckpointSide<BookSide::Ask>(reader, header.ask_levels);
+        // The file size only pins the total; the levels' own counts must
+        // account for exactly the header's orders and nothing may be left over
+        if (order_map_.Size() != header.orders || !reader.AtEnd()) {
+            throw std::runtime_error("Checkpoint levels hold " + std::to_string(order_map_.Size()) +
+                                     " orders, but its header says " + std::to_string(header.orders));
+        }
+        if (best_bid_level_ != nullptr && best_ask_level_ != nullptr &&
+            SidePolicy<BookSide::Bid>::Crosses(best_bid_level_->GetPrice(), best_ask_level_->GetPrice())) {
+            throw std::runtime_error("Checkpoint book is crossed");
+        }
+    } catch (...) {
+        ClearBook();
+        throw;
+    }
+    // Trades after the restore continue the saved sequence; a book that has
+    // traded since it was last non-empty never goes back
+    last_execution_sequence_ = std::max(last_execution_sequence_, header.execution_sequence);
+
+    if (listener_.WantsLevelUpdates()) {
+        for (BookSide side : {BookSide::Bid, BookSide::Ask}) {
+            const PriceLadder& ladder = side == BookSide::Bid ? *bids_ : *asks_;
+            for (const PriceLevel* level = ladder.Best(); level != nullptr;
+                 level = ladder.NextWorse(level->GetPrice())) {
+                NotifyLevelUpdate(side, LevelAction::Add, level->GetPrice(), level);
+            }
+        }
+    }
+    NotifyTopOfBookUpdate();
+    return CheckpointInfo{header.sequence, header.timestamp};
+}
+
+template <typename Listener>
+template <BookSide Side>
+void BasicOrderBook<Listener>::RestoreCheckpointSide(CheckpointReader& reader, uint64_t level_count) {
+    PriceLadder& ladder = Ladder<Side>();
+    uint64_t& side_volume = SideVolume<Side>();
+    typename SidePolicy<Side>::Compare better;
+    uint64_t previous_price = 0;
+
+    for (uint64_t i = 0; i < level_count; ++i) {
+        const CheckpointLevel saved_level = reader.NextLevel();
+        if (saved_level.order_count == 0 || !ladder.Accepts(saved_level.price) ||
+            (i > 0 && !better(previous_price, saved_level.price))) {
+            throw std::runtime_error("Checkpoint level at price " + std::to_string(saved_level.price) +
+                                     " is empty, out of order or off this book's price grid");
+        }
+
+        // Every order is indexed before the level is created, so a failure
+        // never leaves an empty level behind for ClearBook to trip over
+        PriceLevel* level = nullptr;
+        for (uint64_t j = 0; j < saved_level.order_count; ++j) {
+            const CheckpointOrder saved = reader.NextOrder();
+            if (saved.quantity == 0 || saved.quantity > UINT32_MAX) {
+                throw std::runtime_error("Checkpoint order " + std::to_string(saved.order_id) +
+                                         " has no quantity or more than a 32-bit quantity");
+            }
+            OrderHandle handle = order_pool_.Acquire(
+                Order{saved.order_id, saved_level.price, static_cast<uint32_t>(saved.quantity), SidePolicy<Side>::IsBuy},
+                OrderDetails{saved.user_id, saved.ts_received, saved.ts_executed});
+            if (!order_map_.Insert(saved.order_id, handle)) {
+                order_pool_.Release(handle);
+                throw std::runtime_error("Checkpoint repeats order ID " + std::to_string(saved.order_id));
+            }
+            if (level == nullptr) {
+                level = &ladder.GetOrCreate(saved_level.price);
+            }
+            level->AddOrder(order_pool_, handle);
+            side_volume += saved.quantity;
+        }
+        previous_price = saved_level.price;
+    }
+    // Looked up once at the end: creating a level can move the ladder's level slab
+    BestLevel<Side>() = ladder.Best();
+}
+
+template <typename Listener>
+void BasicOrderBook<Listener>::ClearBook() {
+    for (PriceLadder* ladder : {bids_.get(), asks_.get()}) {
+        while (PriceLevel* level = ladder->Best()) {
+            const uint64_t price = level->GetPrice();
+            for (OrderHandle handle = level->GetTopOrder(); handle != kNoOrder; handle = level->GetTopOrder()) {
+                level->RemoveOrder(order_pool_, handle);
+                order_map_.Erase(order_pool_.Get(handle).order_id);
+                order_pool_.Release(handle);
+            }
+            ladder->Erase(price);
+        }
+    }
+    total_bid_volume_ = 0;
+    total_ask_volume_ = 0;
+    best_bid_level_ = nullptr;
+    best_ask_level_ = nullptr;
+}
+
+template <typename Listener>
+void BasicOrderBook<Listener>::AddRestingOrder(OrderHandle handle) {
+    if (order_pool_.Get(handle).IsBuy()) {
+        AddRestingOrder<BookSide::Bid>(handle);
+    } else {
+        AddRestingOrder<BookSide::Ask>(handle);
+    }
+}
+
+template <typename Listener>
+void BasicOrderBook<Listener>::RemoveRestingOrder(OrderHandle handle) {
+    if (order_pool_.Get(handle).IsBuy()) {
+        RemoveRestingOrder<BookSide::Bid>(handle);
+    } else {
+        RemoveRestingOrder<BookSide::Ask>(handle);
+    }
+}
+
+template <typename Listener>
+template <BookSide Side>
+void BasicOrderBook<Listener>::AddRestingOrder(OrderHandle handle) {
+    const Order& order = order_pool_.Get(handle);
+    PriceLadder& side = Ladder<Side>();
+    PriceLevel& price_level = side.GetOrCreate(order.price);
+    bool new_level = (price_level.GetOrderCount() == 0);
+    price_level.AddOrder(order_pool_, handle);
+    SideVolume<Side>() += order.quantity;
+
+    // Creating a level may change the best price (and move the ladder's level
+    // slab), so refresh it before clients can look
+    if (new_level) {
+        BestLevel<Side>() = side.Best();
+    }
+    NotifyLevelUpdate(Side, new_level ? LevelAction::Add : LevelAction::Update, order.price, &price_level);
+}
+
+template <typename Listener>
+template <BookSide Side>
+void BasicOrderBook<Listener>::RemoveRestingOrder(OrderHandle handle) {
+    const Order& order = order_pool_.Get(handle);
+    if (!order.IsResting()) {
+        return;
+    }
+    PriceLevel* price_level = &Ladder<Side>().Level(order.Level());
+    price_level->RemoveOrder(order_pool_, handle);
+    SideVolume<Side>() -= order.quantity;
+
+    // Report the level's new size; if it is now empty, remove it from the ladder
+    if (price_level->GetTotalVolume() != 0) {
+        NotifyLevelUpdate(Side, LevelAction::Update, order.price, price_level);
+    } else {
+        NotifyLevelUpdate(Side, LevelAction::Remove, order.price, nullptr);
+        PriceLadder& side = Ladder<Side>();
+        side.Erase(order.price);
+        PriceLevel*& best_level = BestLevel<Side>();
+        if (best_level == price_level) {
+            best_level = side.Best();
+        }
+    }
+}
+
+template <typename Listener>
+PriceLevel* BasicOrderBook<Listener>::RestingLevel(const Order& order) {
+    return &(order.IsBuy() ? bids_ : asks_)->Level(order.Level());
+}
+
+template <typename Listener>
+bool BasicOrderBook<Listener>::PrepareToRest(bool is_buy, uint64_t price) noexcept {
+    PriceLadder& side = is_buy ? *bids_ : *asks_;
+    try {
+        // Growing the level slab moves every level, the best one included
+        if (side.PrepareLevel(price)) {
+            (is_buy ? best_bid_level_ : best_ask_level_) = side.Best();
+        }
+        return true;
+    } catch (const std::exception&) {
+        return false;
+    }
+}
+
+// Order modification logic
+template <typename Listener>
+OrderResult BasicOrderBook<Listener>::TryModifyOrder(uint64_t order_id, uint64_t new_quantity, uint64_t new_price,
+                                                     uint64_t ts_executed) noexcept {
+    // 1. Validate inputs
+    if (new_quantity == 0) {
+        return Reject(order_id, OrderStatus::ZeroModifiedQuantity);
+    }
+    if (new_quantity > UINT32_MAX) {
+        return Reject(order_id, OrderStatus::QuantityTooLarge);
+    }
+    
+    // 2. Find the existing order
+    OrderHandle handle = order_map_.Find(order_id);
+    if (handle == kNoOrder) {
+        return Reject(order_id, OrderStatus::OrderNotFound);
+    }
+    Order& existing_order = order_pool_.Get(handle);
+    
+    // 3. Check if order was already filled (it would no longer be resting)
+    if (!existing_order.IsResting()) {
+        return Reject(order_id, OrderStatus::OrderNotResting);
+    }
+
+    // Check the new price can rest on this side of the book (tick grid / ladder range)
+    if (!(existing_order.IsBuy() ? bids_ : asks_)->Accepts(new_price)) {
+        return Reject(order_id, OrderStatus::PriceOffGrid);
+    }
+    // A resting order cannot cross, so only a price change can trade
+    if (new_price != existing_order.price && CrossesOppositeBest(existing_order.IsBuy(), new_price) &&
+        !HasExecutionIdsForMatch()) {
+        return Reject(order_id, OrderStatus::ExecutionIdsExhausted);
+    }
+    // A price change re-queues the order at a level that may not exist yet
+    if (new_price != existing_order.price && !PrepareToRest(existing_order.IsBuy(), new_price)) {
+        return Reject(order_id, OrderStatus::CapacityExhausted);
+    }
+    bool is_buy = existing_order.IsBuy();
+    uint64_t original_quantity = existing_order.quantity;
+    uint64_t& side_volume = is_buy ? total_bid_volume_ : total_ask_volume_;
+    OrderResult result;
+    // Only a modify that loses time priority takes a new timestamp; it is
+    // read before journaling so the journal records the same one
+    const bool keeps_priority = new_price == existing_order.price && new_quantity <= original_quantity;
+    if (!keeps_priority && ts_executed == 0) {
+        ts_executed = clock_->Now();
+    }
+
+    // Every path from here on succeeds, once the journal has the command
+    if (journal_ != nullptr &&
+        journal_->Append(BookCommand::Modify(order_id, new_quantity, new_price, ts_executed)) == 0) {
+        return Reject(order_id, OrderStatus::JournalWriteFailed);
+    }
+
+    // 4. Same-price size reduction: update in place, keeping queue position
+    //    and the original timestamps
+    if (keeps_priority) {
+        PriceLevel* level = RestingLevel(existing_order);
+        level->ReduceOrderQuantity(existing_order, static_cast<uint32_t>(new_quantity));
+        side_volume -= original_quantity - new_quantity;
+        NotifyLevelUpdate(is_buy ? BookSide::Bid : BookSide::Ask, LevelAction::Update, new_price, level);
+        result.state = OrderState::Resting;
+        result.resting_quantity = new_quantity;
+        NotifyOrderModified(order_id, new_quantity, new_price);
+        NotifyTopOfBookUpdate();
+        return result;
+    }
+
+    // 5. Anything else loses time priority. The same Order object is moved
+    //    to the back of its new level; only a modify that crosses the spread
+    //    goes through matching.
+    order_pool_.Details(handle).ts_executed = ts_executed;
+
+    if (new_price == existing_order.price) {
+        // Size increase at the same price: re-queue at the back of the level
+        PriceLevel* level = RestingLevel(existing_order);
+        level->RemoveOrder(order_pool_, handle);
+        existing_order.quantity = static_cast<uint32_t>(new_quantity);
+        level->AddOrder(order_pool_, handle);
+        side_volume += new_quantity - original_quantity;
+        NotifyLevelUpdate(is_buy ? BookSide::Bid : BookSide::Ask, LevelAction::Update, new_price, level);
+        result.state = OrderState::Resting;
+        result.resting_quantity = new_quantity;
+        NotifyOrderModified(order_id, new_quantity, new_price);
+        NotifyTopOfBookUpdate();
+        return result;
+    }
+
+    // Take the order out of its level (dropping the level if empty) but keep
+    // it in the order map
+    RemoveRestingOrder(handle);
+    existing_order.quantity = static_cast<uint32_t>(new_quantity);
+    existing_order.price = new_price;
+
+    if (CrossesOppositeBest(is_buy, new_price)) {
+        // Match against the book (notifies clients of each trade as it executes)
+        result.filled_quantity = MatchOrders(handle);
+    }
+
+    // If order has remaining quantity, rest it at the new price
+    if (existing_order.quantity > 0) {
+        result.state = OrderState::Resting;
+        result.resting_quantity = existing_order.quantity;
+        AddRestingOrder(handle);
+        // Notify clients that order was modified successfully
+        NotifyOrderModified(order_id, new_quantity, new_price);
+    } else {
+        // Order fully filled, remove from map and return it to the pool
+        result.state = OrderState::Filled;
+        order_map_.Erase(order_id);
+        order_pool_.Release(handle);
+    }
+    
+    // Notify top of book update
+    NotifyTopOfBookUpdate();
+    return result;
+}
+
+// Client notification methods: report straight to the listener, or buffer
+// while a batch is running
+template <typename Listener>
+void BasicOrderBook<Listener>::NotifyTradeExecuted(const Trade& trade) {
+    if (deferring_notifications_ &&
+        Defer(PendingNotification::Kind::Trade, trade.aggressor_order_id, 0, 0, OrderStatus::Ok, &trade)) {
+        return;
+    }
+    listener_.OnTrade(trade);
+}
+
+template <typename Listener>
+void BasicOrderBook<Listener>::NotifyOrderAcknowledged(uint64_t order_id) {
+    if (deferring_notifications_ && Defer(PendingNotification::Kind::Acknowledged, order_id)) {
+        return;
+    }
+    listener_.OnOrderAcknowledged(order_id);
+}
+
+template <typename Listener>
+void BasicOrderBook<Listener>::NotifyOrderCancelled(uint64_t order_id) {
+    if (deferring_notifications_ && Defer(PendingNotification::Kind::Cancelled, order_id)) {
+        return;
+    }
+    listener_.OnOrderCancelled(order_id);
+}
+
+template <typename Listener>
+void BasicOrderBook<Listener>::NotifyOrderModified(uint64_t order_id, uint64_t new_quantity, uint64_t new_price) {
+    if (deferring_notifications_ && Defer(PendingNotification::Kind::Modified, order_id, new_quantity, new_price)) {
+        return;
+    }
+    listener_.OnOrderModified(order_id, new_quantity, new_price);
+}
+
+template <typename Listener>
+void BasicOrderBook<Listener>::NotifyOrderRejected(uint64_t order_id, OrderStatus status) {
+    if (deferring_notifications_ && Defer(PendingNotification::Kind::Rejected, order_id, 0, 0, status)) {
+        return;
+    }
+    listener_.OnOrderRejected(order_id, status);
+}
+
+template <typename Listener>
+void BasicOrderBook<Listener>::NotifyLevelUpdate(BookSide side, LevelAction action, uint64_t price,
+                                                 const PriceLevel* level) {
+    if (!listener_.WantsLevelUpdates()) {
+        return;
+    }
+    LevelUpdate update;
+    update.side = side;
+    update.action = action;
+    update.price = price;
+    if (level != nullptr) {
+        update.quantity = level->GetTotalVolume();
+        update.order_count = level->GetOrderCount();
+    }
+    if (deferring_notifications_ &&
+        Defer(PendingNotification::Kind::LevelUpdate, 0, 0, 0, OrderStatus::Ok, nullptr, &update)) {
+        return;
+    }
+    listener_.OnLevelUpdate(update);
+}
+
+template <typename Listener>
+void BasicOrderBook<Listener>::NotifyTopOfBookUpdate() {
+    // In a batch or event only the final state is reported
+    if (deferring_notifications_ || event_depth_ > 0) {
+        top_of_book_pending_ = true;
+        return;
+    }
+    if (!listener_.IsListening()) {
+        return;
+    }
+    TopOfBook top = GetTopOfBook();
+    if (top == published_top_of_book_) {
+        return;
+    }
+    published_top_of_book_ = top;
+    listener_.OnTopOfBook(top.best_bid, top.best_ask, top.bid_volume, top.ask_volume);
+}
+
+template <typename Listener>
+void BasicOrderBook<Listener>::EndEvent() {
+    if (event_depth_ == 0 || --event_depth_ > 0) {
+        return;
+    }
+    if (top_of_book_pending_ && !deferring_notifications_) {
+        top_of_book_pending_ = false;
+        NotifyTopOfBookUpdate();
+    }
+}
+
+template <typename Listener>
+bool BasicOrderBook<Listener>::Defer(typename PendingNotification::Kind kind, uint64_t order_id, uint64_t quantity,
+                                     uint64_t price, OrderStatus status, const Trade* trade,
+                                     const LevelUpdate* update) {
+    if (!listener_.IsListening()) {
+        return true;
+    }
+    try {
+        size_t index = 0;
+        if (trade != nullptr) {
+            index = pending_trades_.size();
+            pending_trades_.push_back(*trade);
+        } else if (update != nullptr) {
+            index = pending_level_updates_.size();
+            pending_level_updates_.push_back(*update);
+        }
+        pending_notifications_.push_back(PendingNotification{kind, status, order_id, quantity, price, index});
+        return true;
+    } catch (const std::exception&) {
+        // Out of memory mid-batch. A payload pushed without its entry is
+        // dropped with the rest of the buffers.
+        DeliverPending();
+        return false;
+    }
+}
+
+template <typename Listener>
+void BasicOrderBook<Listener>::DeliverPending() {
+    for (const PendingNotification& pending : pending_notifications_) {
+        switch (pending.kind) {
+            case PendingNotification::Kind::Trade:
+                listener_.OnTrade(pending_trades_[pending.index]);
+                break;
+            case PendingNotification::Kind::Acknowledged:
+                listener_.OnOrderAcknowledged(pending.order_id);
+                break;
+            case PendingNotification::Kind::Cancelled:
+                listener_.OnOrderCancelled(pending.order_id);
+                break;
+            case PendingNotification::Kind::Modified:
+                listener_.OnOrderModified(pending.order_id, pending.quantity, pending.price);
+                break;
+            case PendingNotification::Kind::Rejected:
+                listener_.OnOrderRejected(pending.order_id, pending.status);
+                break;
+            case PendingNotification::Kind::LevelUpdate:
+                listener_.OnLevelUpdate(pending_level_updates_[pending.index]);
+                break;
+        }
+    }
+    pending_notifications_.clear();
+    pending_trades_.clear();
+    pending_level_updates_.clear();
+}
+
+template <typename Listener>
+void BasicOrderBook<Listener>::FlushNotifications() {
+    DeliverPending();
+
+    // Inside an event the update waits for EndEvent
+    if (top_of_book_pending_ && event_depth_ == 0) {
+        top_of_book_pending_ = false;
+        NotifyTopOfBookUpdate();
+    }
+}
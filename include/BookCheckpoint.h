@@ -0,0 +1,137 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iosfwd>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Where the feed stood when a checkpoint was taken; recorded verbatim so a
+// restarted process knows which part of the feed to replay on top of it
+struct CheckpointInfo {
+    uint64_t sequence = 0;   // Last feed sequence number applied to the book
+    uint64_t timestamp = 0;  // Timestamp of that record (e.g. ts_recv)
+};
+
+/**
+ * @brief On-disk layout of a book checkpoint
+ *
+ * A checkpoint is a CheckpointHeader, then every bid level best first, then
+ * every ask level best first. Each level is a CheckpointLevel followed by its
+ * orders in time priority. The file ends with a 64-bit checksum of everything
+ * before it. All fields are 64-bit words in host byte order; a file written
+ * on a host with the other byte order fails the magic check.
+ */
+struct CheckpointHeader {
+    static constexpr uint64_t kMagic = 0x31304B434B42524Full;  // "ORBKCK01"
+    static constexpr uint32_t kVersion = 1;
+
+    uint64_t magic = kMagic;
+    uint32_t version = kVersion;
+    uint32_t flags = 0;
+    uint64_t sequence = 0;
+    uint64_t timestamp = 0;
+    uint64_t bid_levels = 0;
+    uint64_t ask_levels = 0;
+    uint64_t orders = 0;
+    // The book's last execution sequence, so trade IDs continue after a
+    // restore instead of repeating ones already published (0 in files
+    // written before it was recorded)
+    uint64_t execution_sequence = 0;
+};
+
+struct CheckpointLevel {
+    uint64_t price;
+    uint64_t order_count;
+};
+
+// A resting order; its side and price come from the enclosing level
+struct CheckpointOrder {
+    uint64_t order_id;
+    uint64_t user_id;
+    uint64_t quantity;
+    uint64_t ts_received;
+    uint64_t ts_executed;
+};
+
+static_assert(sizeof(CheckpointHeader) == 64, "CheckpointHeader layout is part of the file format");
+static_assert(sizeof(CheckpointLevel) == 16, "CheckpointLevel layout is part of the file format");
+static_assert(sizeof(CheckpointOrder) == 40, "CheckpointOrder layout is part of the file format");
+
+/**
+ * @brief Streams checkpoint records to a file or std::ostream
+ *
+ * Records are staged in a buffer that is written out in large blocks, and
+ * the checksum is folded in as they are appended. Finish() writes the
+ * checksum and flushes; a writer destroyed without Finish() leaves an
+ * incomplete file that CheckpointReader will reject.
+ * Throws std::runtime_error if the output cannot be opened or written.
+ */
+class CheckpointWriter {
+public:
+    explicit CheckpointWriter(std::ostream& out);
+    explicit CheckpointWriter(const std::string& path);
+    ~CheckpointWriter();
+
+    CheckpointWriter(const CheckpointWriter&) = delete;
+    CheckpointWriter& operator=(const CheckpointWriter&) = delete;
+
+    void WriteHeader(const CheckpointHeader& header) { Append(&header, sizeof(header)); }
+    void WriteLevel(const CheckpointLevel& level) { Append(&level, sizeof(level)); }
+    void WriteOrder(const CheckpointOrder& order) { Append(&order, sizeof(order)); }
+    void Finish();
+
+private:
+    void Append(const void* data, size_t size);
+    void FlushBuffer();
+
+    std::unique_ptr<std::ofstream> file_;  // Set when the writer opened the file itself
+    std::ostream* out_;
+    std::vector<char> buffer_;
+    uint64_t checksum_;
+};
+
+/**
+ * @brief Reads a checkpoint back from a file or std::istream
+ *
+ * The whole checkpoint is read into memory with one read and verified
+ * (magic, version, size implied by the header's counts, checksum) before
+ * any record is handed out, so a caller restoring from it never sees a
+ * truncated or corrupted file part way through.
+ * Throws std::runtime_error if the input cannot be read or fails verification.
+ */
+class CheckpointReader {
+public:
+    explicit CheckpointReader(std::istream& in);
+    explicit CheckpointReader(const std::string& path);
+
+    const CheckpointHeader& Header() const { return header_; }
+
+    // Records in file order; throws std::runtime_error past the last one
+    CheckpointLevel NextLevel() { return Next<CheckpointLevel>(); }
+    CheckpointOrder NextOrder() { return Next<CheckpointOrder>(); }
+    // Whether every record has been read (only the checksum is left)
+    bool AtEnd() const { return position_ == end_; }
+
+private:
+    void Load(std::istream& in);
+    template <typename Record> Record Next();
+
+    std::vector<char> data_;
+    CheckpointHeader header_;
+    size_t position_ = 0;
+    size_t end_ = 0;  // Start of the checksum trailer
+};
+
+template <typename Record>
+Record CheckpointReader::Next() {
+    if (end_ - position_ < sizeof(Record)) {
+        throw std::runtime_error("Read past the end of the checkpoint");
+    }
+    Record record;
+    std::memcpy(&record, data_.data() + position_, sizeof(Record));
+    position_ += sizeof(Record);
+    return record;
+}
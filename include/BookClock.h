@@ -0,0 +1,52 @@
+#pragma once
+#include <cstdint>
+
+#include "Helpers.h"
+
+/**
+ * @brief Where a book gets the time when it has to stamp something itself
+ *
+ * The book only reads its clock when no timestamp comes with the command:
+ * the legacy AddOrder overload and a modify that loses queue priority. A
+ * clock is called from the thread that owns the book, without locking.
+ */
+class BookClock {
+public:
+    virtual ~BookClock() = default;
+    virtual uint64_t Now() = 0;
+};
+
+// Wall-clock milliseconds from Helpers::GetTimeStamp; the default
+class SystemBookClock : public BookClock {
+public:
+    uint64_t Now() override { return Helpers::GetTimeStamp(); }
+};
+
+// Unix-epoch nanoseconds from the shared TscClock, for stamping live orders
+class TscBookClock : public BookClock {
+public:
+    uint64_t Now() override { return Helpers::GetTimeStampNs(); }
+};
+
+/**
+ * @brief Clock that only moves when the feed says so
+ *
+ * The feed handler advances it to each record's receive timestamp (e.g.
+ * Databento ts_recv) before applying the record, so every timestamp the
+ * book makes up is a function of the input and two replays of the same
+ * file stamp identically. Time never goes backwards.
+ */
+class ReplayClock : public BookClock {
+public:
+    explicit ReplayClock(uint64_t start = 0) : now_(start) {}
+
+    void Advance(uint64_t timestamp) {
+        if (timestamp > now_) {
+            now_ = timestamp;
+        }
+    }
+    uint64_t Now() override { return now_; }
+
+private:
+    uint64_t now_;
+};
@@ -0,0 +1,45 @@
+#pragma once
+#include <cstdint>
+
+enum class BookCommandType : uint8_t { Add, Cancel, Modify };
+
+/**
+ * @brief One order operation, as a plain value for batch submission
+ *
+ * Fields that an operation does not use are ignored (a cancel only reads
+ * order_id; a modify reads order_id, quantity, price and ts_executed, the
+ * time it stamps on an order that loses priority, with 0 meaning the
+ * book's clock). Use the factory functions to build commands so unused
+ * fields are zeroed.
+ */
+struct BookCommand {
+    BookCommandType type = BookCommandType::Add;
+    bool is_buy = false;
+    uint64_t order_id = 0;
+    uint64_t user_id = 0;
+    uint64_t quantity = 0;
+    uint64_t price = 0;
+    uint64_t ts_received = 0;
+    uint64_t ts_executed = 0;
+
+    static BookCommand Add(uint64_t order_id, uint64_t user_id, bool is_buy, uint64_t quantity, uint64_t price,
+                           uint64_t ts_received, uint64_t ts_executed) {
+        return BookCommand{BookCommandType::Add, is_buy, order_id, user_id, quantity, price, ts_received, ts_executed};
+    }
+    static BookCommand Cancel(uint64_t order_id) {
+        BookCommand command;
+        command.type = BookCommandType::Cancel;
+        command.order_id = order_id;
+        return command;
+    }
+    static BookCommand Modify(uint64_t order_id, uint64_t new_quantity, uint64_t new_price,
+                              uint64_t ts_executed = 0) {
+        BookCommand command;
+        command.type = BookCommandType::Modify;
+        command.order_id = order_id;
+        command.quantity = new_quantity;
+        command.price = new_price;
+        command.ts_executed = ts_executed;
+        return command;
+    }
+};
@@ -0,0 +1,41 @@
+#pragma once
+#include <cstdint>
+
+#include "MarketDepth.h"
+#include "OrderResult.h"
+#include "Trade.h"
+
+/**
+ * @brief Compile-time event sink for BasicOrderBook
+ *
+ * BasicOrderBook<Listener> calls these hooks directly (no virtual dispatch,
+ * no client map), so a listener's hooks inline into the matching code.
+ * Derive from BookListener and hide only the hooks you need; the rest stay
+ * empty and compile away. Hooks run inside the book's noexcept operations
+ * and must not throw.
+ *
+ * IsListening() lets the book skip work nobody will see (buffering batched
+ * events, reading top of book); a listener that can be switched off at
+ * runtime returns false while it is off. Level updates are opt-in: a
+ * listener that wants OnLevelUpdate must also return true from
+ * WantsLevelUpdates().
+ */
+struct BookListener {
+    bool IsListening() const { return true; }
+    bool WantsLevelUpdates() const { return false; }
+
+    void OnTrade(const Trade&) {}
+    void OnOrderAcknowledged(uint64_t /*order_id*/) {}
+    void OnOrderCancelled(uint64_t /*order_id*/) {}
+    void OnOrderModified(uint64_t /*order_id*/, uint64_t /*new_quantity*/, uint64_t /*new_price*/) {}
+    void OnOrderRejected(uint64_t /*order_id*/, OrderStatus /*status*/) {}
+    void OnTopOfBook(uint64_t /*best_bid*/, uint64_t /*best_ask*/, uint64_t /*bid_volume*/,
+                     uint64_t /*ask_volume*/) {}
+    void OnLevelUpdate(const LevelUpdate&) {}
+};
+
+// Listener for books nobody observes (replay, benchmarks); every hook compiles away
+struct NullBookListener : BookListener {
+    static constexpr bool IsListening() { return false; }
+    static constexpr bool WantsLevelUpdates() { return false; }
+};
@@ -0,0 +1,54 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "BookListener.h"
+#include "MarketDepth.h"
+#include "OrderResult.h"
+#include "Trade.h"
+
+class IClient;
+
+/**
+ * @brief BookListener that fans events out to runtime-registered IClients
+ *
+ * This is the listener behind OrderBook: clients can be added and removed
+ * at any time, each event is delivered to every client through the virtual
+ * IClient interface, and an exception thrown by one client is logged
+ * without stopping delivery to the others. Code that knows its consumer at
+ * compile time can use BasicOrderBook with its own listener instead.
+ */
+class ClientRegistryListener : public BookListener {
+public:
+    ClientRegistryListener() = default;
+    ~ClientRegistryListener();  // Shuts down clients still registered
+
+    ClientRegistryListener(const ClientRegistryListener&) = delete;
+    ClientRegistryListener& operator=(const ClientRegistryListener&) = delete;
+    ClientRegistryListener(ClientRegistryListener&&) = default;
+    ClientRegistryListener& operator=(ClientRegistryListener&&) = delete;
+
+    // Replaces any client with the same ID, then initializes it
+    void RegisterClient(std::shared_ptr<IClient> client);
+    void UnregisterClient(uint64_t client_id);
+
+    bool IsListening() const { return !clients_.empty(); }
+    bool WantsLevelUpdates() const { return !level_update_clients_.empty(); }
+
+    void OnTrade(const Trade& trade);
+    void OnOrderAcknowledged(uint64_t order_id);
+    void OnOrderCancelled(uint64_t order_id);
+    void OnOrderModified(uint64_t order_id, uint64_t new_quantity, uint64_t new_price);
+    void OnOrderRejected(uint64_t order_id, OrderStatus status);
+    void OnTopOfBook(uint64_t best_bid, uint64_t best_ask, uint64_t bid_volume, uint64_t ask_volume);
+    void OnLevelUpdate(const LevelUpdate& update);
+
+private:
+    void DropLevelUpdateClient(uint64_t client_id);
+
+    std::unordered_map<uint64_t, std::shared_ptr<IClient>> clients_;
+    // Registered clients that asked for level updates (decided at registration)
+    std::vector<std::shared_ptr<IClient>> level_update_clients_;
+};
@@ -0,0 +1,214 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <condition_variable>
+#include <cstring>
+#include <functional>
+#include <initializer_list>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "BookCommand.h"
+
+// The journal needs mmap and a way to preallocate segment files (Linux,
+// the BSDs, macOS); elsewhere (e.g. Windows) CommandJournal cannot be opened
+#if defined(__unix__) || defined(__APPLE__)
+#define ORDERBOOK_HAS_JOURNAL 1
+#else
+#define ORDERBOOK_HAS_JOURNAL 0
+#endif
+
+// Construction-time settings for a CommandJournal
+struct JournalConfig {
+    // Directory holding the segment files; created if missing
+    std::string directory;
+    // Records per segment file (64 bytes each, so the default is 64 MiB)
+    size_t records_per_segment = size_t{1} << 20;
+    // msync a full segment (on the background thread, once the book has
+    // moved on to the next one); otherwise the kernel writes it back on its
+    // own schedule
+    bool sync_on_rollover = false;
+};
+
+/**
+ * @brief One journaled command as it sits in a segment file
+ *
+ * Sequence numbers start at 1 and are consecutive across segments, so a
+ * zero sequence marks a slot that was never written. The checksum covers
+ * every other field and catches a record torn by a crash mid-append.
+ */
+struct JournalRecord {
+    uint64_t sequence;
+    uint32_t checksum;
+    BookCommandType type;
+    uint8_t is_buy;
+    uint16_t reserved;
+    uint64_t order_id;
+    uint64_t user_id;
+    uint64_t quantity;
+    uint64_t price;
+    uint64_t ts_received;
+    uint64_t ts_executed;
+
+    static uint32_t Checksum(const JournalRecord& record) {
+        uint64_t hash = 0xCBF29CE484222325ull;
+        for (uint64_t word : {record.sequence,
+                              static_cast<uint64_t>(record.type) | (static_cast<uint64_t>(record.is_buy) << 8),
+                              record.order_id, record.user_id, record.quantity, record.price, record.ts_received,
+                              record.ts_executed}) {
+            hash = (hash ^ word) * 0x100000001B3ull;
+        }
+        return static_cast<uint32_t>(hash ^ (hash >> 32));
+    }
+};
+
+static_assert(sizeof(JournalRecord) == 64, "JournalRecord layout is part of the file format");
+
+/**
+ * @brief Write-ahead log of the commands a book accepted
+ *
+ * Records go into preallocated, memory-mapped segment files named after
+ * their first sequence number. Append copies a fixed-size record into the
+ * mapping, so journaling an event makes no system call. A background
+ * thread creates, preallocates and maps the next segment while the
+ * current one fills, and unmaps full ones, so moving to a new segment is
+ * a pointer swap too. The kernel writes dirty pages back on its own, which
+ * survives a process crash; call Sync (or set sync_on_rollover) for
+ * durability against power loss.
+ *
+ * Append never throws: if the next segment cannot be made (e.g. the disk
+ * is full) it returns 0 and the book rejects the command with
+ * OrderStatus::JournalWriteFailed. The background thread keeps retrying,
+ * and appends succeed again once it gets a segment.
+ *
+ * Opening a directory that already has segments continues the sequence
+ * after the last intact record, in a fresh segment. Attach the journal to
+ * a book with SetJournal; rebuild a book with RecoverFromJournal, on its
+ * own or on top of a checkpoint saved with LastSequence() as its sequence.
+ * The constructor throws std::runtime_error if the first segment cannot be
+ * created or mapped. Append, LastSequence and Sync belong to the thread
+ * that owns the book.
+ *
+ * POSIX only: where ORDERBOOK_HAS_JOURNAL is 0 the constructor, Sync and
+ * Replay throw std::runtime_error, so a book there runs unjournaled.
+ */
+class CommandJournal {
+public:
+    // Receives replayed commands in sequence order, a block at a time
+    using ReplayCallback = std::function<void(const BookCommand* commands, size_t count)>;
+
+    explicit CommandJournal(const JournalConfig& config);
+    ~CommandJournal();
+
+    CommandJournal(const CommandJournal&) = delete;
+    CommandJournal& operator=(const CommandJournal&) = delete;
+
+    // Record a command and return its sequence number, or 0 if no segment
+    // was available for it (see LastError)
+    uint64_t Append(const BookCommand& command) noexcept {
+        if (next_slot_ == config_.records_per_segment && !Rollover()) {
+            return 0;
+        }
+        JournalRecord record;
+        record.sequence = last_sequence_ + 1;
+        record.checksum = 0;
+        record.type = command.type;
+        record.is_buy = command.is_buy ? 1 : 0;
+        record.reserved = 0;
+        record.order_id = command.order_id;
+        record.user_id = command.user_id;
+        record.quantity = command.quantity;
+        record.price = command.price;
+        record.ts_received = command.ts_received;
+        record.ts_executed = command.ts_executed;
+        record.checksum = JournalRecord::Checksum(record);
+        std::memcpy(&records_[next_slot_], &record, sizeof(record));
+        ++next_slot_;
+        return ++last_sequence_;
+    }
+
+    // Flush the current segment to disk (blocks until written)
+    void Sync();
+
+    // Sequence of the last record appended, or of the last intact one found
+    // on open; 0 for an empty journal
+    uint64_t LastSequence() const { return last_sequence_; }
+    const std::string& Directory() const { return config_.directory; }
+    // Why the most recent attempt to make a segment failed; empty once one succeeds
+    std::string LastError() const;
+
+    /**
+     * @brief Read back every intact command after after_sequence
+     *
+     * Segments are memory-mapped read-only and walked in order, handing
+     * commands to apply in blocks. Replay stops at the first torn or missing
+     * record. Throws std::runtime_error if the journal's oldest segment
+     * starts after after_sequence + 1 (the commands in between are gone).
+     * Returns the sequence of the last command seen (after_sequence if none).
+     */
+    static uint64_t Replay(const std::string& directory, uint64_t after_sequence, const ReplayCallback& apply);
+
+private:
+    // One mapped segment file
+    struct Segment {
+        void* mapping = nullptr;
+        size_t size = 0;
+        uint64_t first_sequence = 0;
+        std::string path;
+    };
+    // Where the next segment is: being made, mapped and waiting, or failed
+    // (Retrying: a rollover found it failed and asked for another attempt)
+    enum class SpareState : uint8_t { Preparing, Ready, Failed, Retrying };
+
+    // Create, preallocate and map the segment whose first record will be
+    // first_sequence; false with error set if any step fails
+    bool CreateSegment(uint64_t first_sequence, Segment& segment, std::string& error) const;
+    static void CloseSegment(Segment& segment, bool sync);
+    void UseSegment(const Segment& segment);
+    // Swap in the spare segment; false if it is not available
+    bool Rollover() noexcept;
+    // Ask the background thread for the segment after the current one (mutex_ held)
+    void RequestSpare();
+    void RunPreparer();
+
+    JournalConfig config_;
+    uint64_t last_sequence_ = 0;
+    Segment current_;
+    JournalRecord* records_ = nullptr;
+    size_t next_slot_ = 0;
+
+    // Shared with the background thread
+    mutable std::mutex mutex_;
+    std::condition_variable wake_preparer_;
+    std::condition_variable spare_changed_;
+    SpareState spare_state_ = SpareState::Preparing;
+    bool spare_requested_ = false;
+    bool stopping_ = false;
+    Segment spare_;
+    Segment retired_;  // A full segment waiting to be unmapped
+    std::string last_error_;
+    std::thread preparer_;
+};
+
+/**
+ * @brief Rebuild a book from a journal directory
+ *
+ * Applies every journaled command after after_sequence (0 for all of them;
+ * a checkpoint's sequence to replay only its tail) through ApplyBatch. The
+ * book's own journal is detached meanwhile so replayed commands are not
+ * journaled again. Returns the last sequence applied.
+ */
+template <typename Book>
+uint64_t RecoverFromJournal(Book& book, const std::string& directory, uint64_t after_sequence = 0) {
+    struct JournalDetach {
+        Book& book;
+        CommandJournal* journal;
+        ~JournalDetach() { book.SetJournal(journal); }
+    } detach{book, book.GetJournal()};
+    book.SetJournal(nullptr);
+    return CommandJournal::Replay(directory, after_sequence,
+                                  [&book](const BookCommand* commands, size_t count) {
+                                      book.ApplyBatch(commands, count);
+                                  });
+}
@@ -0,0 +1,34 @@
+#pragma once
+#include <cstdint>
+
+#include "Helpers.h"
+
+/**
+ * @brief Where a book gets the execution ID stamped on each trade
+ *
+ * Called once per trade from the thread that owns the book, without locking.
+ */
+class ExecutionIdSource {
+public:
+    virtual ~ExecutionIdSource() = default;
+    virtual uint64_t Next() = 0;
+};
+
+// Process-wide counter shared by every book (Helpers::GenerateExecutionId)
+class GlobalExecutionIdSource : public ExecutionIdSource {
+public:
+    uint64_t Next() override { return Helpers::GenerateExecutionId(); }
+};
+
+// Plain counter: first, first + 1, ... so a replay numbers its trades identically
+class SequentialExecutionIdSource : public ExecutionIdSource {
+public:
+    explicit SequentialExecutionIdSource(uint64_t first = 1) : next_(first) {}
+
+    uint64_t Next() override { return next_++; }
+    // The ID the next trade will get
+    uint64_t Peek() const { return next_; }
+
+private:
+    uint64_t next_;
+};
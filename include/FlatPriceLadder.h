@@ -0,0 +1,63 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include "OccupancyBitmap.h"
+#include "PriceLadder.h"
+#include "PriceLevel.h"
+
+/**
+ * @brief PriceLadder indexed by a contiguous array of ticks
+ *
+ * Slot i holds the handle of the level at base_ + i * tick_size, so finding a
+ * level is an index computation and creating one only takes a slot from the
+ * level slab. When a price falls outside the window the ladder re-centers on
+ * the occupied range (doubling the window if needed, up to max_window_ticks)
+ * and moves the live handles across; the levels themselves stay put.
+ * Occupied slots are tracked in an OccupancyBitmap, so stepping to the next
+ * populated price skips any run of empty ticks in a few instructions.
+ */
+template <BookSide Side>
+class FlatPriceLadder final : public PriceLadder {
+public:
+    explicit FlatPriceLadder(const PriceLadderConfig& config);
+
+    bool OnGrid(uint64_t price) const override { return price % tick_size_ == 0; }
+    bool Accepts(uint64_t price) const override;
+    PriceLevel* Find(uint64_t price) override;
+    PriceLevel& GetOrCreate(uint64_t price) override;
+    void Erase(uint64_t price) override;
+    bool PrepareLevel(uint64_t price) override;
+    PriceLevel* Best() override;
+    PriceLevel* NextWorse(uint64_t price) override;
+    size_t LevelCount() const override { return level_count_; }
+
+    // Window introspection
+    uint64_t GetBasePrice() const { return base_; }
+    uint64_t GetTickSize() const { return tick_size_; }
+    size_t GetWindowTicks() const { return slots_.size(); }
+
+private:
+    bool InWindow(uint64_t price) const {
+        return price >= base_ && (price - base_) / tick_size_ < slots_.size();
+    }
+    size_t IndexOf(uint64_t price) const { return static_cast<size_t>((price - base_) / tick_size_); }
+    uint64_t PriceOf(size_t index) const { return base_ + index * tick_size_; }
+
+    // Move the window so it covers price and every occupied level
+    void Recenter(uint64_t price);
+
+    uint64_t tick_size_;
+    size_t max_window_ticks_;
+    uint64_t base_ = 0;
+    std::vector<LevelHandle> slots_;
+    OccupancyBitmap occupied_;
+    size_t level_count_ = 0;
+    // Lowest and highest occupied slots, cached so Best() is a single load
+    // (valid while level_count_ > 0)
+    size_t low_index_ = 0;
+    size_t high_index_ = 0;
+};
+
+extern template class FlatPriceLadder<BookSide::Bid>;
+extern template class FlatPriceLadder<BookSide::Ask>;
@@ -17,7 +17,11 @@ class Helpers {
         return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
             std::chrono::system_clock::now().time_since_epoch()).count());
     }
+    // Nanoseconds since the Unix epoch from the shared TscClock
+    static uint64_t GetTimeStampNs();
+    // Nanoseconds on a monotonic timeline, for measuring latencies
+    static uint64_t GetMonotonicNs();
     private:
     static std::atomic<uint64_t> last_order_number;
 
-};
\ No newline at end of file
+};
@@ -5,6 +5,8 @@
 #include <functional>
 #include <string>
 
+#include "MarketDepth.h"
+
 // Forward declarations
 struct Trade;
 struct Order;
@@ -173,6 +175,27 @@ public:
     virtual void OnTopOfBookUpdate(uint64_t best_bid, uint64_t best_ask, 
                                    uint64_t bid_volume, uint64_t ask_volume) = 0;
 
+    /**
+     * @brief Whether this client wants per-level depth updates
+     * 
+     * Checked once, when the client is registered. Books only build level
+     * updates while at least one registered client asks for them.
+     * 
+     * @return true to receive OnLevelUpdate callbacks
+     */
+    virtual bool WantsLevelUpdates() const { return false; }
+
+    /**
+     * @brief Callback for market-by-price depth changes
+     * 
+     * Called whenever a price level is created, changes size or is removed,
+     * in the order the changes happen. Applying the updates in order keeps a
+     * full L2 book in sync with the order book.
+     * 
+     * @param update Level side, price and new aggregate size
+     */
+    virtual void OnLevelUpdate(const LevelUpdate& update) { (void)update; }
+
     // ========== Client Lifecycle ==========
 
     /**
@@ -0,0 +1,188 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+#include "SpscRing.h"
+
+// How a consumer waits on an empty ring (and a producer on a full one)
+enum class WaitStrategy : uint8_t {
+    BusySpin,  // Poll continuously; lowest latency, needs a core per spinning thread
+    Yield,     // Poll, yielding the CPU between attempts
+    Park       // Yield briefly, then sleep until the producer signals
+};
+
+// Counters for one ring; producer and consumer fields are sampled without locking
+struct IngressRingStats {
+    uint64_t pushed = 0;      // Elements accepted
+    uint64_t overflows = 0;   // Pushes that found the ring full (dropped by TryPush, waited by Push)
+    uint64_t batches = 0;     // Non-empty consumer drains
+    uint64_t popped = 0;      // Elements drained
+    uint64_t high_water = 0;  // Deepest the ring has been when drained
+    uint64_t parks = 0;       // Times the consumer went to sleep (Park only)
+};
+
+/**
+ * @brief SpscRing plus the waiting and accounting a thread handoff needs
+ *
+ * The producer thread calls TryPush (never waits; a full ring counts an
+ * overflow and drops the element) or Push (counts the overflow, then waits
+ * for space). The consumer thread calls WaitPopBatch, which blocks per the
+ * WaitStrategy until there is work or the ring is closed, and returns 0 only
+ * once Close() has been called and everything pushed before it is drained.
+ */
+template <typename T>
+class IngressRing {
+public:
+    explicit IngressRing(size_t capacity, WaitStrategy wait_strategy = WaitStrategy::Yield)
+        : ring_(capacity), wait_strategy_(wait_strategy) {}
+
+    IngressRing(const IngressRing&) = delete;
+    IngressRing& operator=(const IngressRing&) = delete;
+
+    // Producer side
+    bool TryPush(const T& value) {
+        if (!ring_.TryPush(value)) {
+            Bump(producer_.overflows);
+            return false;
+        }
+        Bump(producer_.pushed);
+        WakeConsumer();
+        return true;
+    }
+    void Push(const T& value) {
+        if (!ring_.TryPush(value)) {
+            Bump(producer_.overflows);
+            do {
+                Pause();
+            } while (!ring_.TryPush(value));
+        }
+        Bump(producer_.pushed);
+        WakeConsumer();
+    }
+
+    // Producer side: after this, WaitPopBatch returns 0 once the ring is drained
+    void Close() {
+        closed_.store(true, std::memory_order_release);
+        if (wait_strategy_ == WaitStrategy::Park) {
+            std::lock_guard<std::mutex> lock(park_mutex_);
+            park_cv_.notify_one();
+        }
+    }
+    bool IsClosed() const { return closed_.load(std::memory_order_acquire); }
+    // Undo Close() for another run; only while neither thread is using the ring
+    void Reopen() { closed_.store(false, std::memory_order_release); }
+
+    // Consumer side: never waits
+    size_t PopBatch(T* out, size_t max_count) {
+        size_t depth = ring_.Size();
+        size_t count = ring_.PopBatch(out, max_count);
+        if (count > 0) {
+            Bump(consumer_.batches);
+            Bump(consumer_.popped, count);
+            if (depth > consumer_.high_water.load(std::memory_order_relaxed)) {
+                consumer_.high_water.store(depth, std::memory_order_relaxed);
+            }
+        }
+        return count;
+    }
+
+    // Consumer side: waits for at least one element; 0 means closed and drained
+    size_t WaitPopBatch(T* out, size_t max_count) {
+        for (unsigned idle = 0;; ++idle) {
+            size_t count = PopBatch(out, max_count);
+            if (count > 0) {
+                return count;
+            }
+            if (IsClosed()) {
+                // Close() follows the producer's last push, so one more look is final
+                return PopBatch(out, max_count);
+            }
+            if (wait_strategy_ == WaitStrategy::Park && idle >= kSpinsBeforePark) {
+                Park();
+                idle = 0;
+            } else {
+                Pause();
+            }
+        }
+    }
+
+    IngressRingStats GetStats() const {
+        IngressRingStats stats;
+        stats.pushed = producer_.pushed.load(std::memory_order_relaxed);
+        stats.overflows = producer_.overflows.load(std::memory_order_relaxed);
+        stats.batches = consumer_.batches.load(std::memory_order_relaxed);
+        stats.popped = consumer_.popped.load(std::memory_order_relaxed);
+        stats.high_water = consumer_.high_water.load(std::memory_order_relaxed);
+        stats.parks = consumer_.parks.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+    size_t Size() const { return ring_.Size(); }
+    bool Empty() const { return ring_.Empty(); }
+    size_t Capacity() const { return ring_.Capacity(); }
+    WaitStrategy GetWaitStrategy() const { return wait_strategy_; }
+
+private:
+    // Empty polls before a Park consumer sleeps
+    static constexpr unsigned kSpinsBeforePark = 64;
+
+    // Each counter has a single writer, so a plain load + store is enough
+    static void Bump(std::atomic<uint64_t>& counter, uint64_t by = 1) {
+        counter.store(counter.load(std::memory_order_relaxed) + by, std::memory_order_relaxed);
+    }
+
+    void Pause() const {
+        if (wait_strategy_ != WaitStrategy::BusySpin) {
+            std::this_thread::yield();
+        }
+    }
+
+    // The consumer publishes `parked_` before re-checking the ring, and the
+    // producer publishes its push before checking `parked_`; the fences make
+    // sure at least one of them sees the other, so no wake-up is lost
+    void Park() {
+        std::unique_lock<std::mutex> lock(park_mutex_);
+        parked_.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (ring_.Empty() && !IsClosed()) {
+            Bump(consumer_.parks);
+            park_cv_.wait(lock, [this] { return !ring_.Empty() || IsClosed(); });
+        }
+        parked_.store(false, std::memory_order_relaxed);
+    }
+    void WakeConsumer() {
+        if (wait_strategy_ != WaitStrategy::Park) {
+            return;
+        }
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (parked_.load(std::memory_order_relaxed)) {
+            std::lock_guard<std::mutex> lock(park_mutex_);
+            park_cv_.notify_one();
+        }
+    }
+
+    SpscRing<T> ring_;
+    WaitStrategy wait_strategy_;
+    std::atomic<bool> closed_{false};
+
+    struct alignas(SpscRing<T>::kCacheLine) ProducerCounters {
+        std::atomic<uint64_t> pushed{0};
+        std::atomic<uint64_t> overflows{0};
+    };
+    struct alignas(SpscRing<T>::kCacheLine) ConsumerCounters {
+        std::atomic<uint64_t> batches{0};
+        std::atomic<uint64_t> popped{0};
+        std::atomic<uint64_t> high_water{0};
+        std::atomic<uint64_t> parks{0};
+    };
+    ProducerCounters producer_;
+    ConsumerCounters consumer_;
+
+    alignas(SpscRing<T>::kCacheLine) std::atomic<bool> parked_{false};
+    std::mutex park_mutex_;
+    std::condition_variable park_cv_;
+};
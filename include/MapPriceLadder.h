@@ -0,0 +1,41 @@
+#pragma once
+#include <map>
+
+#include "PriceLadder.h"
+#include "PriceLevel.h"
+#include "SidePolicy.h"
+
+/**
+ * @brief PriceLadder backed by a std::map ordered best-first
+ *
+ * Handles any price with no configuration. The tree only maps prices to
+ * level handles; the levels themselves live in the base class's slab. The
+ * node of the last erased level is kept for the next new one, so level
+ * churn around the touch does not allocate.
+ */
+template <BookSide Side>
+class MapPriceLadder final : public PriceLadder {
+public:
+    using Compare = typename SidePolicy<Side>::Compare;
+
+    bool OnGrid(uint64_t) const override { return true; }
+    bool Accepts(uint64_t price) const override;
+    PriceLevel* Find(uint64_t price) override;
+    PriceLevel& GetOrCreate(uint64_t price) override;
+    void Erase(uint64_t price) override;
+    bool PrepareLevel(uint64_t price) override;
+    PriceLevel* Best() override;
+    PriceLevel* NextWorse(uint64_t price) override;
+    size_t LevelCount() const override { return index_.size(); }
+
+private:
+    using Index = std::map<uint64_t, LevelHandle, Compare>;
+
+    // Price -> level handle, best price first
+    Index index_;
+    // A detached tree node for the next new level (empty if none is spare)
+    typename Index::node_type spare_node_;
+};
+
+extern template class MapPriceLadder<BookSide::Bid>;
+extern template class MapPriceLadder<BookSide::Ask>;
@@ -0,0 +1,33 @@
+#pragma once
+#include <cstdint>
+
+#include "PriceLadder.h"
+
+// One aggregated price level, as copied out by GetDepth
+struct DepthLevel {
+    uint64_t price = 0;
+    uint64_t quantity = 0;     // Total resting quantity at the price
+    uint64_t order_count = 0;  // Orders queued at the price
+};
+
+// What happened to a price level
+enum class LevelAction : uint8_t {
+    Add,     // Level created
+    Update,  // Aggregate quantity / order count changed
+    Remove   // Level emptied and dropped
+};
+
+/**
+ * @brief Market-by-price delta for one level
+ *
+ * Carries the level's new aggregate state, so a consumer keeps its own L2
+ * book by applying updates in order: Add/Update set the level to
+ * (quantity, order_count), Remove deletes it (quantity and order_count are 0).
+ */
+struct LevelUpdate {
+    BookSide side = BookSide::Bid;
+    LevelAction action = LevelAction::Update;
+    uint64_t price = 0;
+    uint64_t quantity = 0;
+    uint64_t order_count = 0;
+};
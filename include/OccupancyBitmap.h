@@ -0,0 +1,129 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+/**
+ * @brief Hierarchical bitmap over a fixed number of slots
+ *
+ * Tier 0 has one bit per slot; every tier above has one bit per 64-bit word of
+ * the tier below, set while that word is non-zero. Searching for the next or
+ * previous set slot checks the current word, climbs until a summary word has a
+ * candidate, then descends with count-trailing-zeros / count-leading-zeros, so
+ * a search costs a handful of instructions per tier no matter how many empty
+ * slots it skips. 4096 slots need two tiers, 262144 need three.
+ */
+class OccupancyBitmap {
+public:
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+    explicit OccupancyBitmap(size_t size = 0) { Resize(size); }
+
+    // Change the number of slots; all bits are cleared
+    void Resize(size_t size);
+
+    size_t Size() const { return size_; }
+    bool Any() const { return !tiers_.empty() && tiers_.back()[0] != 0; }
+
+    bool Test(size_t index) const {
+        return (tiers_[0][index >> 6] >> (index & 63)) & 1;
+    }
+
+    void Set(size_t index) {
+        for (auto& tier : tiers_) {
+            uint64_t& word = tier[index >> 6];
+            bool was_empty = (word == 0);
+            word |= uint64_t{1} << (index & 63);
+            if (!was_empty) break;  // Summary bits above are already set
+            index >>= 6;
+        }
+    }
+
+    void Clear(size_t index) {
+        for (auto& tier : tiers_) {
+            uint64_t& word = tier[index >> 6];
+            word &= ~(uint64_t{1} << (index & 63));
+            if (word != 0) break;   // Word still occupied, summaries unchanged
+            index >>= 6;
+        }
+    }
+
+    // Lowest / highest set slot, or npos
+    size_t FindFirst() const { return FindNext(0); }
+    size_t FindLast() const { return size_ == 0 ? npos : FindPrev(size_ - 1); }
+
+    // Lowest set slot >= index, or npos
+    size_t FindNext(size_t index) const {
+        if (index >= size_) return npos;
+        for (size_t tier = 0; tier < tiers_.size(); ++tier) {
+            size_t word_index = index >> 6;
+            uint64_t bits = tiers_[tier][word_index] & (~uint64_t{0} << (index & 63));
+            if (bits != 0) {
+                return Descend((word_index << 6) | CountTrailingZeros(bits), tier, true);
+            }
+            // Nothing left in this word: continue from the next word one tier up
+            index = word_index + 1;
+            if (index >= tiers_[tier].size()) return npos;
+        }
+        return npos;
+    }
+
+    // Highest set slot <= index, or npos
+    size_t FindPrev(size_t index) const {
+        if (size_ == 0) return npos;
+        if (index >= size_) index = size_ - 1;
+        for (size_t tier = 0; tier < tiers_.size(); ++tier) {
+            size_t word_index = index >> 6;
+            size_t bit = index & 63;
+            uint64_t mask = bit == 63 ? ~uint64_t{0} : (uint64_t{1} << (bit + 1)) - 1;
+            uint64_t bits = tiers_[tier][word_index] & mask;
+            if (bits != 0) {
+                return Descend((word_index << 6) | (63 - CountLeadingZeros(bits)), tier, false);
+            }
+            // Nothing left in this word: continue from the previous word one tier up
+            if (word_index == 0) return npos;
+            index = word_index - 1;
+        }
+        return npos;
+    }
+
+private:
+    // index is a set bit position within `tier`; walk down to the lowest or
+    // highest set slot underneath it
+    size_t Descend(size_t index, size_t tier, bool lowest) const {
+        while (tier > 0) {
+            --tier;
+            uint64_t word = tiers_[tier][index];
+            index = (index << 6) | (lowest ? CountTrailingZeros(word) : 63 - CountLeadingZeros(word));
+        }
+        return index;
+    }
+
+    static unsigned CountTrailingZeros(uint64_t value) {
+#if defined(_MSC_VER)
+        unsigned long index;
+        _BitScanForward64(&index, value);
+        return static_cast<unsigned>(index);
+#else
+        return static_cast<unsigned>(__builtin_ctzll(value));
+#endif
+    }
+
+    static unsigned CountLeadingZeros(uint64_t value) {
+#if defined(_MSC_VER)
+        unsigned long index;
+        _BitScanReverse64(&index, value);
+        return 63 - static_cast<unsigned>(index);
+#else
+        return static_cast<unsigned>(__builtin_clzll(value));
+#endif
+    }
+
+    size_t size_ = 0;
+    // tiers_[0] is the per-slot tier; tiers_.back() is a single summary word
+    std::vector<std::vector<uint64_t>> tiers_;
+};
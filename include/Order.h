@@ -1,19 +1,55 @@
 #pragma once
 #include <cstdint>
-#include <list>
-class PriceLevel;
-struct Order {
-    uint64_t order_id;
+
+// 32-bit reference to an Order inside its OrderPool. Queue links and the
+// order index hold handles rather than pointers, which keeps Order to half a
+// cache line.
+using OrderHandle = uint32_t;
+constexpr OrderHandle kNoOrder = UINT32_MAX;
+
+// Reference to a PriceLevel inside its PriceLadder's level storage. Resting
+// orders carry one, so a cancel reaches its level without a price lookup.
+// Handles are 31 bits; the top bit of the word they share in Order is the side.
+using LevelHandle = uint32_t;
+constexpr LevelHandle kNoLevel = 0x7FFFFFFF;
+
+// Fields only read off the matching path (the fill report, checkpoints,
+// modify). OrderPool keeps them in a parallel array indexed by the order's
+// handle, so they stay out of the orders' cache lines.
+struct OrderDetails {
     uint64_t user_id;
-    bool is_buy_side;
-    uint64_t quantity;
-    uint64_t price;
     uint64_t ts_received;
     uint64_t ts_executed;
+};
+
+// Half a cache line per order: everything matching and cancelling touches on
+// a resting order. Prices stay 64-bit because the map ladder has no tick grid
+// to index against; quantities are capped at UINT32_MAX by the book.
+struct alignas(32) Order {
+    Order() = default;
+    Order(uint64_t id, uint64_t order_price, uint32_t order_quantity, bool is_buy)
+        : order_id(id), price(order_price), quantity(order_quantity),
+          side_and_level_(is_buy ? kBuyBit | kNoLevel : kNoLevel) {}
+
+    uint64_t order_id;
+    uint64_t price;
+    uint32_t quantity;
+
+    bool IsBuy() const { return (side_and_level_ & kBuyBit) != 0; }
+    // Level the order is queued in, in its own side's ladder, or kNoLevel
+    LevelHandle Level() const { return side_and_level_ & kNoLevel; }
+    bool IsResting() const { return Level() != kNoLevel; }
+    // Set by PriceLevel as the order is linked in and out of its queue
+    void SetLevel(LevelHandle level) { side_and_level_ = (side_and_level_ & kBuyBit) | level; }
+
+    // Intrusive links in the PriceLevel's time-priority queue (kNoOrder at the ends)
+    OrderHandle prev_in_level = kNoOrder;
+    OrderHandle next_in_level = kNoOrder;
+
+private:
+    static constexpr uint32_t kBuyBit = 0x80000000u;
+    // Buy flag in the top bit, level handle in the low 31
+    uint32_t side_and_level_ = kNoLevel;
+};
 
-    // Pointers/iterators for internal management
-    //When an order needs to be cancelled, PriceLevel object is accessed through ptr and position from iterator
-    PriceLevel* parent_price_level;
-    std::list<Order*>::iterator position_in_list;
-    //... other fields like user_id, etc.
-};
\ No newline at end of file
+static_assert(sizeof(Order) == 32, "Order should fill exactly half a cache line");
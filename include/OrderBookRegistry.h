@@ -0,0 +1,83 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "OrderBook.h"
+
+/**
+ * @brief One OrderBook per instrument, created on first use
+ *
+ * Books live in dense slots (0, 1, 2, ... in creation order) so callers can
+ * keep their own per-instrument state in parallel vectors indexed by slot.
+ * Instrument IDs below direct_id_limit map to their slot through a flat
+ * array (one load per lookup); larger IDs fall back to a hash map. Feed
+ * instrument IDs (e.g. Databento's uint32 instrument_id) are mostly small,
+ * so routing a message to its book is normally an array index.
+ */
+class OrderBookRegistry {
+public:
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+    // Called once for every new book, before GetOrCreate returns it
+    using BookCreatedCallback = std::function<void(size_t slot, uint32_t instrument_id, const std::shared_ptr<OrderBook>& book)>;
+
+    explicit OrderBookRegistry(const OrderBookConfig& default_config = OrderBookConfig(),
+                               uint32_t direct_id_limit = uint32_t{1} << 20);
+
+    OrderBookRegistry(const OrderBookRegistry&) = delete;
+    OrderBookRegistry& operator=(const OrderBookRegistry&) = delete;
+
+    // Config for one instrument's book (e.g. its tick size); must be set before the book exists.
+    // Every book's book_id is set to its instrument ID, namespacing its trade IDs
+    void SetInstrumentConfig(uint32_t instrument_id, const OrderBookConfig& config);
+    void SetBookCreatedCallback(BookCreatedCallback callback) { on_book_created_ = std::move(callback); }
+
+    // Slot of an instrument's book, or npos if it has not been created
+    size_t FindSlot(uint32_t instrument_id) const {
+        if (instrument_id < direct_slots_.size()) {
+            return static_cast<size_t>(direct_slots_[instrument_id]) - 1;  // 0 (absent) wraps to npos
+        }
+        if (instrument_id < direct_id_limit_) {
+            return npos;
+        }
+        auto it = overflow_slots_.find(instrument_id);
+        return it != overflow_slots_.end() ? it->second : npos;
+    }
+    // Slot of an instrument's book, creating the book if needed
+    size_t GetOrCreateSlot(uint32_t instrument_id) {
+        size_t slot = FindSlot(instrument_id);
+        return slot != npos ? slot : Create(instrument_id);
+    }
+
+    OrderBook* Find(uint32_t instrument_id) {
+        size_t slot = FindSlot(instrument_id);
+        return slot != npos ? books_[slot].get() : nullptr;
+    }
+    OrderBook& GetOrCreate(uint32_t instrument_id) { return *books_[GetOrCreateSlot(instrument_id)]; }
+
+    // Access by slot (slot < Size())
+    OrderBook& BookAt(size_t slot) { return *books_[slot]; }
+    const std::shared_ptr<OrderBook>& SharedBookAt(size_t slot) const { return books_[slot]; }
+    uint32_t InstrumentIdAt(size_t slot) const { return instrument_ids_[slot]; }
+
+    size_t Size() const { return books_.size(); }
+
+private:
+    size_t Create(uint32_t instrument_id);
+
+    OrderBookConfig default_config_;
+    uint32_t direct_id_limit_;
+    std::unordered_map<uint32_t, OrderBookConfig> instrument_configs_;
+    BookCreatedCallback on_book_created_;
+
+    // instrument ID -> slot + 1 (0 = no book), grown on demand up to direct_id_limit_
+    std::vector<uint32_t> direct_slots_;
+    std::unordered_map<uint32_t, size_t> overflow_slots_;
+
+    std::vector<std::shared_ptr<OrderBook>> books_;
+    std::vector<uint32_t> instrument_ids_;
+};
@@ -0,0 +1,90 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Order.h"
+
+/**
+ * @brief Flat open-addressing hash table from order ID to resting Order
+ *
+ * Slots are {key, OrderHandle} pairs (16 bytes, four to a cache line) in a
+ * single power-of-two array; an empty slot holds kNoOrder. Collisions are resolved
+ * with Robin Hood linear probing, which keeps probe sequences short and lets a
+ * miss stop as soon as it meets an entry closer to its home slot than the
+ * search is. Erase shifts the following entries back one slot instead of
+ * leaving a tombstone, so the table never degrades under add/cancel churn.
+ * Keys are spread with Fibonacci hashing, which handles both sequential and
+ * sparse 64-bit exchange IDs.
+ */
+class OrderIndex {
+public:
+    // expected_size is a pre-size hint: that many entries fit without a rehash
+    explicit OrderIndex(size_t expected_size = 0);
+
+    // Lookup; returns kNoOrder if the ID is not present
+    OrderHandle Find(uint64_t order_id) const {
+        size_t index = HomeSlot(order_id);
+        for (size_t distance = 0;; ++distance) {
+            const Slot& slot = slots_[index];
+            if (slot.value == kNoOrder || ProbeDistance(slot.key, index) < distance) {
+                return kNoOrder;
+            }
+            if (slot.key == order_id) {
+                return slot.value;
+            }
+            index = (index + 1) & mask_;
+        }
+    }
+
+    bool Contains(uint64_t order_id) const { return Find(order_id) != kNoOrder; }
+
+    // Insert a new entry; returns false (and leaves the table unchanged) if
+    // the ID is already present. order must not be kNoOrder.
+    bool Insert(uint64_t order_id, OrderHandle order);
+
+    // Remove an entry; returns false if the ID is not present
+    bool Erase(uint64_t order_id);
+
+    // Make room for `count` entries without rehashing
+    void Reserve(size_t count);
+    void Clear();
+
+    // Pull the home slot of an ID into cache ahead of a Find/Insert/Erase
+    void Prefetch(uint64_t order_id) const {
+#if defined(__GNUC__) || defined(__clang__)
+        __builtin_prefetch(&slots_[HomeSlot(order_id)]);
+#else
+        (void)order_id;
+#endif
+    }
+
+    size_t Size() const { return size_; }
+    bool Empty() const { return size_ == 0; }
+    size_t Capacity() const { return slots_.size(); }
+
+private:
+    struct Slot {
+        uint64_t key = 0;
+        OrderHandle value = kNoOrder;
+    };
+
+    size_t HomeSlot(uint64_t order_id) const {
+        return static_cast<size_t>((order_id * 0x9E3779B97F4A7C15ull) >> shift_);
+    }
+    // How far the entry in `index` sits from its home slot
+    size_t ProbeDistance(uint64_t order_id, size_t index) const {
+        return (index - HomeSlot(order_id)) & mask_;
+    }
+
+    // Rebuild the table with `capacity` slots (a power of two)
+    void Rehash(size_t capacity);
+    // Robin Hood placement of an entry known not to be present, starting
+    // `distance` slots from its home at `index`
+    void Place(size_t index, size_t distance, Slot carried);
+
+    std::vector<Slot> slots_;
+    size_t mask_ = 0;
+    unsigned shift_ = 64;
+    size_t size_ = 0;
+};
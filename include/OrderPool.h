@@ -0,0 +1,103 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Order.h"
+
+/**
+ * @brief Sizing policy for an OrderPool
+ *
+ * initial_capacity orders are allocated up front. When the pool runs dry it adds
+ * a new chunk of capacity * (growth_factor - 1) orders (at least min_growth), so
+ * a factor of 2.0 doubles the pool each time it grows. A chunk is never
+ * smaller than an eighth of the pool nor larger than 2^24 orders, so even a
+ * factor of 1.0 keeps the 255 addressable chunks good for ~1.8 billion orders.
+ */
+struct OrderPoolConfig {
+    size_t initial_capacity = 1024;
+    double growth_factor = 2.0;
+    size_t min_growth = 256;
+};
+
+/**
+ * @brief Preallocated pool of Order objects with free-list recycling
+ *
+ * Orders are carved out of fixed chunks that live until the pool is destroyed
+ * and are addressed by a 32-bit OrderHandle (chunk number in the top 8 bits,
+ * slot in the low 24), so handles and the orders behind them stay stable
+ * while they are resting in the book. A new chunk is 64-byte aligned, so two
+ * orders share each cache line, and is handed out in address order without
+ * being touched first, so unused capacity costs no page faults. Released
+ * orders go back onto a free list and are handed out again by Acquire(),
+ * which means the add/cancel/fill path does no heap allocation once the pool
+ * has grown to the book's working set.
+ *
+ * Each order's OrderDetails live in a parallel per-chunk array under the same
+ * handle, so resting orders stay half a cache line each.
+ */
+class OrderPool {
+public:
+    explicit OrderPool(const OrderPoolConfig& config = OrderPoolConfig());
+    ~OrderPool();
+
+    // The pool owns raw memory that handles point into
+    OrderPool(const OrderPool&) = delete;
+    OrderPool& operator=(const OrderPool&) = delete;
+
+    // Take an order from the free list, else the newest chunk (growing if
+    // both are empty), and initialise it. Throws std::length_error once all
+    // 255 chunks are in use, or std::bad_alloc; either way the pool is unchanged.
+    OrderHandle Acquire(const Order& value, const OrderDetails& details = OrderDetails{});
+    // Acquire() that returns kNoOrder instead of throwing
+    OrderHandle TryAcquire(const Order& value, const OrderDetails& details = OrderDetails{}) noexcept;
+    // Return an order to the free list; the handle must have come from Acquire()
+    void Release(OrderHandle handle);
+
+    // The order and cold fields behind a handle that came from Acquire()
+    Order& Get(OrderHandle handle) { return orders_[handle >> kSlotBits][handle & kSlotMask]; }
+    const Order& Get(OrderHandle handle) const { return orders_[handle >> kSlotBits][handle & kSlotMask]; }
+    OrderDetails& Details(OrderHandle handle) { return details_[handle >> kSlotBits][handle & kSlotMask]; }
+    const OrderDetails& Details(OrderHandle handle) const {
+        return details_[handle >> kSlotBits][handle & kSlotMask];
+    }
+
+    // Pull an order into cache ahead of use
+    void Prefetch(OrderHandle handle) const {
+#if defined(__GNUC__) || defined(__clang__)
+        __builtin_prefetch(&Get(handle));
+#else
+        (void)handle;
+#endif
+    }
+
+    // Make sure at least `capacity` orders are allocated
+    void Reserve(size_t capacity);
+
+    size_t Capacity() const { return capacity_; }
+    size_t InUse() const { return capacity_ - Available(); }
+    size_t Available() const { return free_list_.size() + static_cast<size_t>(fresh_end_ - fresh_next_); }
+    size_t ChunkCount() const { return chunk_count_; }
+
+private:
+    static constexpr unsigned kSlotBits = 24;
+    static constexpr OrderHandle kSlotMask = (OrderHandle{1} << kSlotBits) - 1;
+    static constexpr size_t kMaxChunkSize = size_t{1} << kSlotBits;
+    // Chunk 255 would reach kNoOrder
+    static constexpr size_t kMaxChunks = (size_t{1} << (32 - kSlotBits)) - 1;
+
+    void Grow(size_t count);
+
+    OrderPoolConfig config_;
+    // Chunk bases, kept in place so resolving a handle is a single load; an
+    // order is constructed when its slot is first acquired
+    Order* orders_[kMaxChunks] = {};
+    OrderDetails* details_[kMaxChunks] = {};
+    size_t chunk_count_ = 0;
+    std::vector<OrderHandle> free_list_; // LIFO so recently freed (cache-warm) orders are reused first
+    // Never-used tail of the newest chunk, handed out in address order once
+    // the free list is empty
+    OrderHandle fresh_next_ = 0;
+    OrderHandle fresh_end_ = 0;
+    size_t capacity_ = 0;
+};
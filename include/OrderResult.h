@@ -0,0 +1,57 @@
+#pragma once
+#include <cstdint>
+
+// Why an order operation was accepted or refused
+enum class OrderStatus : uint8_t {
+    Ok,
+    ZeroQuantity,       // Quantity must be greater than zero
+    DuplicateOrderId,   // Add with an ID that is already resting
+    OrderNotFound,      // Cancel/modify of an unknown ID
+    OrderNotResting,    // Modify of an order that is no longer in a level
+    PriceOffGrid,       // Price is off the tick grid / outside the ladder range
+    ExecutionIdsExhausted,  // Could trade, but the book's execution ID range might run out
+    JournalWriteFailed,     // The attached journal could not record the command
+    QuantityTooLarge,       // Quantity does not fit the order's 32-bit field
+    ZeroModifiedQuantity,   // Modify to a quantity of zero (use cancel instead)
+    CapacityExhausted       // The book could not allocate room for the order
+};
+
+// Where the order ended up after the operation
+enum class OrderState : uint8_t {
+    Rejected,
+    Resting,
+    Filled,
+    Cancelled
+};
+
+/**
+ * @brief Outcome of a non-throwing OrderBook operation
+ *
+ * Returned by value from the Try* API; small enough to come back in registers.
+ */
+struct OrderResult {
+    OrderStatus status = OrderStatus::Ok;
+    OrderState state = OrderState::Rejected;
+    uint64_t filled_quantity = 0;   // Executed against the book by this call
+    uint64_t resting_quantity = 0;  // Left resting afterwards (0 unless Resting)
+
+    bool Ok() const { return status == OrderStatus::Ok; }
+};
+
+// Human-readable reason, matching the messages of the throwing API
+inline const char* ToString(OrderStatus status) {
+    switch (status) {
+        case OrderStatus::Ok: return "Ok";
+        case OrderStatus::ZeroQuantity: return "Order quantity must be greater than zero";
+        case OrderStatus::DuplicateOrderId: return "Order ID already exists";
+        case OrderStatus::OrderNotFound: return "Order ID not found";
+        case OrderStatus::OrderNotResting: return "Cannot modify filled order";
+        case OrderStatus::PriceOffGrid: return "Order price is outside the book's price grid";
+        case OrderStatus::ExecutionIdsExhausted: return "Book has run out of execution IDs";
+        case OrderStatus::JournalWriteFailed: return "Command could not be written to the journal";
+        case OrderStatus::QuantityTooLarge: return "Order quantity must not exceed 4294967295";
+        case OrderStatus::ZeroModifiedQuantity: return "Modified order quantity must be greater than zero";
+        case OrderStatus::CapacityExhausted: return "Book could not allocate room for the order";
+    }
+    return "Unknown order status";
+}
@@ -0,0 +1,102 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "Order.h"
+#include "PriceLevel.h"
+
+enum class BookSide : uint8_t { Bid, Ask };
+
+// Storage backend used for the price levels of one side of the book
+enum class PriceLadderType : uint8_t {
+    Map,  // std::map keyed by price; any price, one tree node per level
+    Flat  // contiguous array indexed by (price - base) / tick_size
+};
+
+struct PriceLadderConfig {
+    PriceLadderType type = PriceLadderType::Map;
+    // Flat ladder only: every price must be a multiple of tick_size
+    uint64_t tick_size = 1;
+    // Flat ladder only: number of ticks allocated up front, and the most the
+    // window may grow to when resting prices spread out
+    size_t initial_window_ticks = 4096;
+    size_t max_window_ticks = size_t{1} << 20;
+};
+
+/**
+ * @brief Price-ordered collection of PriceLevels for one side of the book
+ *
+ * "Best" means highest price for bids and lowest price for asks; "worse" is the
+ * opposite direction. Both backends keep their levels in one slab owned by this
+ * base class and only index it by price, so every level has a LevelHandle that
+ * stays fixed until the level is erased. Resting orders carry that handle, so
+ * Level() reaches an order's level in O(1) whatever the backend. Pointers
+ * returned by Find/GetOrCreate/Best stay valid until the level is erased or
+ * GetOrCreate or PrepareLevel grows the slab.
+ */
+class PriceLadder {
+public:
+    virtual ~PriceLadder() = default;
+
+    // Whether price lies on the ladder's tick grid
+    virtual bool OnGrid(uint64_t price) const = 0;
+    // Whether a level at this price can be created (tick grid / window range)
+    virtual bool Accepts(uint64_t price) const = 0;
+
+    // Existing level at price, or nullptr
+    virtual PriceLevel* Find(uint64_t price) = 0;
+    // Existing level at price, creating an empty one if needed. Price must be accepted.
+    virtual PriceLevel& GetOrCreate(uint64_t price) = 0;
+    // Drop the level at price (it should be empty); never allocates
+    virtual void Erase(uint64_t price) = 0;
+    // Allocate ahead whatever a following GetOrCreate(price) would need, so
+    // that call cannot throw. Price must be accepted. Returns true if the
+    // existing levels moved, invalidating pointers to them. Throws
+    // std::bad_alloc or std::length_error with the levels left as they were.
+    virtual bool PrepareLevel(uint64_t price) = 0;
+
+    // Best populated level, or nullptr if the side is empty
+    virtual PriceLevel* Best() = 0;
+    // Best populated level strictly worse than price, or nullptr
+    virtual PriceLevel* NextWorse(uint64_t price) = 0;
+
+    virtual size_t LevelCount() const = 0;
+
+    const PriceLevel* Best() const { return const_cast<PriceLadder*>(this)->Best(); }
+    const PriceLevel* NextWorse(uint64_t price) const { return const_cast<PriceLadder*>(this)->NextWorse(price); }
+    bool Empty() const { return LevelCount() == 0; }
+
+    // The live level behind a handle taken from a resting order (Order::Level())
+    PriceLevel& Level(LevelHandle handle) { return levels_[handle]; }
+    const PriceLevel& Level(LevelHandle handle) const { return levels_[handle]; }
+
+protected:
+    // Take an empty level from the slab, reusing erased ones first. Throws
+    // std::length_error past kNoLevel levels, or std::bad_alloc, leaving the
+    // slab as it was.
+    LevelHandle NewLevel();
+    // Make sure NewLevel() has a slot it can take without allocating; true
+    // if that grew (and so moved) the slab. Throws like NewLevel().
+    bool ReserveLevel() {
+        if (!free_levels_.empty() || levels_.size() < levels_.capacity()) {
+            return false;
+        }
+        GrowLevels();
+        return true;
+    }
+    // Return an erased level's slot to the slab; never allocates
+    void FreeLevel(LevelHandle handle) { free_levels_.push_back(handle); }
+
+private:
+    // Double the slab's capacity (kept out of line; ReserveLevel runs on every add)
+    void GrowLevels();
+
+    std::vector<PriceLevel> levels_;
+    // Erased slots, reserved to the slab's capacity so FreeLevel cannot throw
+    std::vector<LevelHandle> free_levels_;
+};
+
+// Create the ladder backend described by config for one side of the book
+std::unique_ptr<PriceLadder> MakePriceLadder(BookSide side, const PriceLadderConfig& config);
@@ -1,28 +1,110 @@
 #pragma once
-struct Order;
-#include <list> 
+#include <algorithm>
 #include <cstdint>
 #include <vector>
-struct Trade;
+
+#include "Order.h"
+#include "OrderPool.h"
+#include "Trade.h"
+#include "Helpers.h"
 class PriceLevel {
 public:
-    void AddOrder(Order* order);
-    void RemoveOrder(Order* order);
-     // This method should handle the logic for filling an order
-        // and return a vector of trades that were executed.
-    std::vector<Trade> FillOrder(Order* order, uint64_t quantity);   
-        
+    // handle is how the owning ladder addresses this level; orders queued
+    // here carry it (a standalone level can leave it at 0)
+    explicit PriceLevel(LevelHandle handle = 0) : handle_(handle) {}
+    // The queue is linked through pool handles, so a level moves freely;
+    // copying (which would share the queue) is not allowed
+    PriceLevel(PriceLevel&&) noexcept = default;
+    PriceLevel& operator=(PriceLevel&&) noexcept = default;
+    PriceLevel(const PriceLevel&) = delete;
+    PriceLevel& operator=(const PriceLevel&) = delete;
+
+    // Queue operations take the pool that owns the orders' handles
+    void AddOrder(OrderPool& pool, OrderHandle handle);
+    void RemoveOrder(OrderPool& pool, OrderHandle handle);
+    // Shrink a queued order to new_quantity (<= its quantity) without
+    // touching its queue position
+    void ReduceOrderQuantity(Order& order, uint32_t new_quantity);
+    /**
+     * @brief Fill up to `quantity` of an incoming order against this level
+     *
+     * Resting orders are consumed in time priority and each execution is
+     * handed to sink(const Trade&, OrderHandle completed) as soon as it is
+     * generated, so the matching path needs no trade buffer. `completed` is
+     * the resting order if this trade filled it completely (it has already
+     * been unlinked and is the caller's to reclaim), otherwise kNoOrder.
+     * Returns the quantity filled. Each trade carries the incoming order's
+     * user and times from `aggressor` and takes its execution ID from
+     * next_execution_id(); the resting order's user is read from the pool's
+     * cold array only here, when the fill is reported. The overloads without
+     * them read the incoming order's details from the pool and use the
+     * process-wide Helpers::GenerateExecutionId.
+     */
+    template <typename NextExecutionId, typename TradeSink>
+    uint64_t FillOrder(OrderPool& pool, const Order& order, uint64_t quantity, const OrderDetails& aggressor,
+                       NextExecutionId&& next_execution_id, TradeSink&& sink);
+    template <typename TradeSink>
+    uint64_t FillOrder(OrderPool& pool, OrderHandle order, uint64_t quantity, TradeSink&& sink) {
+        return FillOrder(pool, pool.Get(order), quantity, pool.Details(order),
+                         [] { return Helpers::GenerateExecutionId(); }, sink);
+    }
+    // Convenience overload that collects the trades into a vector
+    std::vector<Trade> FillOrder(OrderPool& pool, OrderHandle order, uint64_t quantity);
+
     uint64_t GetTotalVolume() const { return total_volume_; }
     uint64_t GetPrice() const { return price_; }
-    Order* GetTopOrder() const {
-        if (!order_queue_.empty()) {
-            return order_queue_.front();
-        }
-        return nullptr; // No orders available
+    uint64_t GetOrderCount() const { return order_count_; }
+    LevelHandle GetHandle() const { return handle_; }
+    OrderHandle GetTopOrder() const {
+        return head_; // kNoOrder when no orders are available
     }
 private:
-    uint64_t price_;
-    uint64_t total_volume_;
-    std::list<Order*> order_queue_; // Time-priority queue
+    // Unlink an order from the queue without touching volume
+    void Unlink(OrderPool& pool, Order& order);
+
+    uint64_t price_ = 0;
+    uint64_t total_volume_ = 0;
+    // 32 bits suffice: a level cannot hold more orders than the pool has handles
+    uint32_t order_count_ = 0;
+    LevelHandle handle_;
+    // Time-priority queue, intrusively linked through Order::prev_in_level/next_in_level
+    OrderHandle head_ = kNoOrder;
+    OrderHandle tail_ = kNoOrder;
 };
 
+template <typename NextExecutionId, typename TradeSink>
+uint64_t PriceLevel::FillOrder(OrderPool& pool, const Order& order, uint64_t quantity, const OrderDetails& aggressor,
+                               NextExecutionId&& next_execution_id, TradeSink&& sink) {
+    uint64_t remaining_quantity = quantity;
+    while (remaining_quantity > 0 && head_ != kNoOrder) {
+        const OrderHandle top_handle = head_;
+        Order& top_order = pool.Get(top_handle);
+        uint32_t fill_quantity = static_cast<uint32_t>(std::min<uint64_t>(remaining_quantity, top_order.quantity));
+        Trade trade{
+            next_execution_id(), // execution_id
+            order.order_id, // aggressor_order_id
+            top_order.order_id, // resting_order_id
+            aggressor.user_id, // aggressor_user_id
+            pool.Details(top_handle).user_id, // resting_user_id
+            price_, // price
+            fill_quantity, // quantity
+            aggressor.ts_received, // ts_received (from aggressor order)
+            aggressor.ts_executed  // ts_executed (from aggressor order - should be historical timestamp)
+        };
+
+        // Update quantities
+        top_order.quantity -= fill_quantity;
+        total_volume_ -= fill_quantity;
+        remaining_quantity -= fill_quantity;
+
+        OrderHandle completed = kNoOrder;
+        if (top_order.quantity == 0) {
+            // Remove the order from the price level - the caller handles deletion
+            Unlink(pool, top_order);
+            completed = top_handle;
+        }
+        // top_order is not touched again, so the sink may reclaim it
+        sink(trade, completed);
+    }
+    return quantity - remaining_quantity;
+}
@@ -0,0 +1,127 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "BookCommand.h"
+#include "IngressRing.h"
+#include "OrderBook.h"
+#include "OrderBookRegistry.h"
+
+struct ShardedEngineConfig {
+    // Worker threads; each owns a disjoint set of instruments
+    size_t num_shards = 1;
+    // Commands buffered per shard before Submit has to wait
+    size_t ring_capacity = 65536;
+    // Most commands a worker takes off its ring at once
+    size_t max_batch = 256;
+    // How idle workers wait for commands, and Submit for ring space
+    WaitStrategy wait_strategy = WaitStrategy::Yield;
+    // Config for every book the shards create
+    OrderBookConfig book_config;
+};
+
+// Counters for one shard, sampled while the engine runs
+struct ShardStats {
+    uint64_t commands = 0;         // Commands applied to a book
+    uint64_t rejected = 0;         // Of those, how many the book refused
+    uint64_t batches = 0;          // Non-empty drains of the ring
+    uint64_t books = 0;            // Instruments this shard has created books for
+    uint64_t submit_stalls = 0;    // Submits that found the ring full and had to wait
+    uint64_t max_queue_depth = 0;  // Most commands waiting in the ring at a drain
+};
+
+/**
+ * @brief Order books for many instruments spread across worker threads
+ *
+ * Each instrument is owned by exactly one shard: a worker thread with its own
+ * OrderBookRegistry and an IngressRing of commands. A single dispatcher thread
+ * calls Submit, which routes the command to the instrument's shard; the
+ * worker drains its ring in batches and applies each run of same-instrument
+ * commands with OrderBook::ApplyBatch. Books are never touched by more than
+ * one thread, so nothing on the matching path takes a lock.
+ *
+ * Instruments go to shard (instrument_id % num_shards) unless pinned with
+ * AssignInstrument before Start. Client callbacks for a book run on its
+ * shard's thread; register clients from the book-created callback.
+ */
+class ShardedEngine {
+public:
+    // Runs on the shard's worker thread when it creates a book
+    using BookCreatedCallback = std::function<void(size_t shard, size_t slot, uint32_t instrument_id,
+                                                   const std::shared_ptr<OrderBook>& book)>;
+
+    explicit ShardedEngine(const ShardedEngineConfig& config = ShardedEngineConfig());
+    ~ShardedEngine();  // Stops and joins the workers
+
+    ShardedEngine(const ShardedEngine&) = delete;
+    ShardedEngine& operator=(const ShardedEngine&) = delete;
+
+    // Setup; only valid while stopped
+    void AssignInstrument(uint32_t instrument_id, size_t shard);
+    void SetBookCreatedCallback(BookCreatedCallback callback);
+
+    void Start();
+    // Applies everything already submitted, then joins the workers
+    void Stop();
+    bool IsRunning() const { return running_; }
+
+    size_t ShardFor(uint32_t instrument_id) const {
+        if (!assignments_.empty()) {
+            auto it = assignments_.find(instrument_id);
+            if (it != assignments_.end()) {
+                return it->second;
+            }
+        }
+        return instrument_id % shards_.size();
+    }
+
+    /**
+     * @brief Queue a command for an instrument's book (dispatcher thread only)
+     *
+     * Waits while the shard's ring is full. Throws std::runtime_error if the
+     * engine is not running.
+     */
+    void Submit(uint32_t instrument_id, const BookCommand& command);
+
+    size_t NumShards() const { return shards_.size(); }
+    ShardStats GetShardStats(size_t shard) const;
+    ShardStats GetTotalStats() const;
+
+    // A shard's books; only valid while stopped
+    OrderBookRegistry& Registry(size_t shard);
+
+private:
+    struct ShardCommand {
+        BookCommand command;
+        uint32_t instrument_id;
+    };
+
+    struct Shard {
+        explicit Shard(const ShardedEngineConfig& config)
+            : ring(config.ring_capacity, config.wait_strategy), registry(config.book_config) {}
+
+        IngressRing<ShardCommand> ring;
+        OrderBookRegistry registry;
+        std::thread worker;
+
+        // Written only by the worker
+        alignas(SpscRing<ShardCommand>::kCacheLine) std::atomic<uint64_t> commands{0};
+        std::atomic<uint64_t> rejected{0};
+        std::atomic<uint64_t> books{0};
+    };
+
+    void RunShard(size_t index);
+    void ThrowIfRunning(const char* what) const;
+
+    ShardedEngineConfig config_;
+    std::vector<std::unique_ptr<Shard>> shards_;
+    std::unordered_map<uint32_t, size_t> assignments_;
+    BookCreatedCallback on_book_created_;
+    bool running_ = false;
+};
@@ -0,0 +1,40 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+
+#include "PriceLadder.h"
+
+/**
+ * @brief Compile-time description of one side of the book
+ *
+ * Everything that differs between bids and asks lives here, so matching,
+ * resting and level removal are written once as templates over BookSide
+ * and each instantiation compiles down to the right comparisons with no
+ * runtime side branches:
+ *  - Compare orders prices best-first for this side (std::map comparator)
+ *  - Crosses(limit, resting) says whether an incoming order on this side
+ *    with the given limit can trade against a resting level on the opposite side
+ *  - Opposite is the side an incoming order on this side matches against
+ */
+template <BookSide Side>
+struct SidePolicy;
+
+template <>
+struct SidePolicy<BookSide::Bid> {
+    static constexpr BookSide Opposite = BookSide::Ask;
+    static constexpr bool IsBuy = true;
+    using Compare = std::greater<uint64_t>;
+
+    // A buy trades with asks at or below its limit
+    static bool Crosses(uint64_t limit, uint64_t resting_price) { return limit >= resting_price; }
+};
+
+template <>
+struct SidePolicy<BookSide::Ask> {
+    static constexpr BookSide Opposite = BookSide::Bid;
+    static constexpr bool IsBuy = false;
+    using Compare = std::less<uint64_t>;
+
+    // A sell trades with bids at or above its limit
+    static bool Crosses(uint64_t limit, uint64_t resting_price) { return limit <= resting_price; }
+};
@@ -0,0 +1,106 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+
+/**
+ * @brief Bounded lock-free single-producer/single-consumer queue
+ *
+ * Exactly one thread may push and exactly one (other) thread may pop. The
+ * capacity is rounded up to a power of two so positions wrap with a mask.
+ * Head and tail live on separate cache lines, and each side keeps a cached
+ * copy of the other side's index so the shared line is only re-read when the
+ * ring looks full (producer) or empty (consumer).
+ *
+ * T must be trivially copyable: slots are plain storage overwritten in place.
+ */
+template <typename T>
+class SpscRing {
+    static_assert(std::is_trivially_copyable<T>::value, "SpscRing elements must be trivially copyable");
+
+public:
+    static constexpr size_t kCacheLine = 64;
+
+    explicit SpscRing(size_t capacity) {
+        if (capacity == 0) {
+            throw std::invalid_argument("SpscRing capacity must be greater than zero");
+        }
+        size_t rounded = 1;
+        while (rounded < capacity) {
+            rounded <<= 1;
+        }
+        mask_ = rounded - 1;
+        slots_ = std::make_unique<T[]>(rounded);
+    }
+
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    // Producer side: false if the ring is full
+    bool TryPush(const T& value) {
+        const uint64_t tail = producer_.tail.load(std::memory_order_relaxed);
+        if (tail - producer_.cached_head > mask_) {
+            producer_.cached_head = consumer_.head.load(std::memory_order_acquire);
+            if (tail - producer_.cached_head > mask_) {
+                return false;
+            }
+        }
+        slots_[tail & mask_] = value;
+        producer_.tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side: false if the ring is empty
+    bool TryPop(T& value) {
+        return PopBatch(&value, 1) == 1;
+    }
+
+    // Consumer side: pop up to max_count elements into out, returning how many
+    size_t PopBatch(T* out, size_t max_count) {
+        const uint64_t head = consumer_.head.load(std::memory_order_relaxed);
+        // Only re-read the producer's line when the cached view cannot fill the batch
+        if (consumer_.cached_tail - head < max_count) {
+            consumer_.cached_tail = producer_.tail.load(std::memory_order_acquire);
+            if (consumer_.cached_tail == head) {
+                return 0;
+            }
+        }
+        size_t count = static_cast<size_t>(consumer_.cached_tail - head);
+        if (count > max_count) {
+            count = max_count;
+        }
+        for (size_t i = 0; i < count; ++i) {
+            out[i] = slots_[(head + i) & mask_];
+        }
+        consumer_.head.store(head + count, std::memory_order_release);
+        return count;
+    }
+
+    // Approximate when called concurrently with the other side
+    size_t Size() const {
+        return static_cast<size_t>(producer_.tail.load(std::memory_order_acquire) -
+                                   consumer_.head.load(std::memory_order_acquire));
+    }
+    bool Empty() const { return Size() == 0; }
+    size_t Capacity() const { return mask_ + 1; }
+
+private:
+    // Written by the producer; cached_head is its private copy of consumer_.head
+    struct alignas(kCacheLine) ProducerState {
+        std::atomic<uint64_t> tail{0};
+        uint64_t cached_head = 0;
+    };
+    // Written by the consumer; cached_tail is its private copy of producer_.tail
+    struct alignas(kCacheLine) ConsumerState {
+        std::atomic<uint64_t> head{0};
+        uint64_t cached_tail = 0;
+    };
+
+    ProducerState producer_;
+    ConsumerState consumer_;
+    size_t mask_ = 0;
+    std::unique_ptr<T[]> slots_;
+};
@@ -0,0 +1,141 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+/**
+ * @brief Nanosecond clock read from the CPU's invariant timestamp counter
+ *
+ * At construction the TSC rate is calibrated against CLOCK_MONOTONIC_RAW;
+ * afterwards Now() is an RDTSC plus a fixed-point multiply, with no system
+ * call or vDSO read. Every resync_interval the clock re-reads
+ * CLOCK_MONOTONIC_RAW, re-measures the rate over the whole time since
+ * calibration and steers out any error over the next interval. Now() never
+ * goes backwards: a clock found more than 1 ms behind the reference jumps
+ * forward to it, while one that is ahead is only slowed down (by at most
+ * 1 ms per interval) until the reference catches up. Parameters are published through
+ * a seqlock: any number of threads may read, and whichever notices the
+ * interval has passed does the resync.
+ *
+ * Now() is on the CLOCK_MONOTONIC_RAW timeline (for latency measurement);
+ * NowUnix() adds the CLOCK_REALTIME offset sampled at the last resync (for
+ * stamping orders alongside exchange timestamps). Without an invariant TSC
+ * both fall back to clock_gettime. On platforms without clock_gettime (MSVC)
+ * the references are std::chrono::steady_clock and system_clock instead.
+ */
+class TscClock {
+public:
+    // Shared instance, calibrated on first use
+    static TscClock& Instance();
+
+    explicit TscClock(std::chrono::nanoseconds calibration_window = std::chrono::milliseconds(10),
+                      std::chrono::nanoseconds resync_interval = std::chrono::seconds(1));
+
+    TscClock(const TscClock&) = delete;
+    TscClock& operator=(const TscClock&) = delete;
+
+    uint64_t Now() {
+        if (!uses_tsc_) {
+            return ReadMonotonicRaw();
+        }
+        return Convert(ReadTsc()).monotonic;
+    }
+    uint64_t NowUnix() {
+        if (!uses_tsc_) {
+            return ReadRealtime();
+        }
+        Reading reading = Convert(ReadTsc());
+        return reading.monotonic + reading.unix_offset;
+    }
+
+    // False if the CPU has no invariant TSC and the clock reads the OS instead
+    bool UsesTsc() const { return uses_tsc_; }
+    // Calibrated TSC frequency, in ticks per nanosecond (0 without a TSC)
+    double TicksPerNanosecond() const;
+    // Resyncs performed since construction
+    uint64_t ResyncCount() const { return resyncs_.load(std::memory_order_relaxed); }
+
+    static uint64_t ReadTsc() {
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+        return __rdtsc();
+#else
+        return 0;
+#endif
+    }
+    static uint64_t ReadMonotonicRaw();
+    static uint64_t ReadRealtime();
+
+private:
+    // ns = base_ns + (tsc - base_tsc) * ns_per_tick, with ns_per_tick in 32.32 fixed point
+    static constexpr int kShift = 32;
+
+    // (ticks * ns_per_tick) >> kShift; the product needs 96 bits
+    static uint64_t Scale(uint64_t ticks, uint64_t ns_per_tick) {
+#if defined(__SIZEOF_INT128__)
+        // __extension__ keeps -Wpedantic quiet about __int128
+        __extension__ typedef unsigned __int128 UInt128;
+        return static_cast<uint64_t>((static_cast<UInt128>(ticks) * ns_per_tick) >> kShift);
+#elif defined(_MSC_VER) && defined(_M_X64)
+        uint64_t high = 0;
+        const uint64_t low = _umul128(ticks, ns_per_tick, &high);
+        return __shiftright128(low, high, kShift);
+#else
+        // Four 32x32 partial products; only the low 64 bits of the result are kept
+        const uint64_t ticks_lo = ticks & 0xFFFFFFFFu, ticks_hi = ticks >> 32;
+        const uint64_t rate_lo = ns_per_tick & 0xFFFFFFFFu, rate_hi = ns_per_tick >> 32;
+        return ((ticks_hi * rate_hi) << 32) + ticks_hi * rate_lo + ticks_lo * rate_hi + ((ticks_lo * rate_lo) >> 32);
+#endif
+    }
+    // Signed ticks: another thread may have published a base just past our read
+    static int64_t Scale(int64_t ticks, uint64_t ns_per_tick) {
+        return ticks < 0 ? -static_cast<int64_t>(Scale(0 - static_cast<uint64_t>(ticks), ns_per_tick))
+                         : static_cast<int64_t>(Scale(static_cast<uint64_t>(ticks), ns_per_tick));
+    }
+
+    struct Reading {
+        uint64_t monotonic;
+        uint64_t unix_offset;
+    };
+
+    Reading Convert(uint64_t tsc) {
+        for (;;) {
+            const uint64_t sequence = sequence_.load(std::memory_order_acquire);
+            const uint64_t base_tsc = base_tsc_.load(std::memory_order_relaxed);
+            const uint64_t base_ns = base_ns_.load(std::memory_order_relaxed);
+            const uint64_t ns_per_tick = ns_per_tick_.load(std::memory_order_relaxed);
+            const uint64_t unix_offset = unix_offset_.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if ((sequence & 1) != 0 || sequence != sequence_.load(std::memory_order_relaxed)) {
+                continue;  // A resync is publishing new parameters
+            }
+            const int64_t ticks = static_cast<int64_t>(tsc - base_tsc);
+            if (ticks >= resync_ticks_ && Resync(sequence, tsc)) {
+                continue;
+            }
+            return Reading{base_ns + static_cast<uint64_t>(Scale(ticks, ns_per_tick)), unix_offset};
+        }
+    }
+
+    // Returns true if this thread published new parameters
+    bool Resync(uint64_t sequence, uint64_t tsc);
+
+    bool uses_tsc_ = false;
+    int64_t resync_ticks_ = INT64_MAX;
+    // Calibration anchor: the rate is always measured from here
+    uint64_t reference_tsc_ = 0;
+    uint64_t reference_ns_ = 0;
+
+    // Seqlock-published conversion parameters (odd sequence: being written)
+    std::atomic<uint64_t> sequence_{0};
+    std::atomic<uint64_t> base_tsc_{0};
+    std::atomic<uint64_t> base_ns_{0};
+    std::atomic<uint64_t> ns_per_tick_{0};
+    std::atomic<uint64_t> unix_offset_{0};
+    std::atomic<uint64_t> resyncs_{0};
+};
@@ -0,0 +1,135 @@
+#include "BookCheckpoint.h"
+#include <fstream>
+#include <istream>
+#include <ostream>
+
+namespace {
+
+// Bytes staged before the writer hands a block to the stream
+constexpr size_t kWriteBlock = 1 << 20;
+// Bytes requested per read when the stream's size is not known up front
+constexpr size_t kReadBlock = 1 << 20;
+
+constexpr uint64_t kChecksumSeed = 0xCBF29CE484222325ull;
+constexpr uint64_t kChecksumPrime = 0x100000001B3ull;
+
+// FNV-1a over 64-bit words rather than bytes; every record is a whole number
+// of words, and this takes an eighth of the multiplies
+uint64_t FoldChecksum(uint64_t checksum, const char* data, size_t size) {
+    for (size_t offset = 0; offset < size; offset += sizeof(uint64_t)) {
+        uint64_t word;
+        std::memcpy(&word, data + offset, sizeof(word));
+        checksum = (checksum ^ word) * kChecksumPrime;
+    }
+    return checksum;
+}
+
+}  // namespace
+
+CheckpointWriter::CheckpointWriter(std::ostream& out) : out_(&out), checksum_(kChecksumSeed) {
+    buffer_.reserve(kWriteBlock);
+}
+
+CheckpointWriter::CheckpointWriter(const std::string& path)
+    : file_(std::make_unique<std::ofstream>(path, std::ios::binary | std::ios::trunc)),
+      out_(file_.get()),
+      checksum_(kChecksumSeed) {
+    if (!*file_) {
+        throw std::runtime_error("Cannot open checkpoint file for writing: " + path);
+    }
+    buffer_.reserve(kWriteBlock);
+}
+
+CheckpointWriter::~CheckpointWriter() = default;
+
+void CheckpointWriter::Append(const void* data, size_t size) {
+    const char* bytes = static_cast<const char*>(data);
+    checksum_ = FoldChecksum(checksum_, bytes, size);
+    buffer_.insert(buffer_.end(), bytes, bytes + size);
+    if (buffer_.size() >= kWriteBlock) {
+        FlushBuffer();
+    }
+}
+
+void CheckpointWriter::FlushBuffer() {
+    out_->write(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+    if (!*out_) {
+        throw std::runtime_error("Failed to write checkpoint");
+    }
+    buffer_.clear();
+}
+
+void CheckpointWriter::Finish() {
+    const uint64_t checksum = checksum_;
+    const char* bytes = reinterpret_cast<const char*>(&checksum);
+    buffer_.insert(buffer_.end(), bytes, bytes + sizeof(checksum));
+    FlushBuffer();
+    out_->flush();
+    if (!*out_) {
+        throw std::runtime_error("Failed to write checkpoint");
+    }
+}
+
+CheckpointReader::CheckpointReader(std::istream& in) {
+    Load(in);
+}
+
+CheckpointReader::CheckpointReader(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        throw std::runtime_error("Cannot open checkpoint file: " + path);
+    }
+    // Size the buffer up front so the file is read with a single call
+    file.seekg(0, std::ios::end);
+    std::streamoff size = file.tellg();
+    file.seekg(0, std::ios::beg);
+    if (size > 0) {
+        data_.resize(static_cast<size_t>(size));
+        file.read(data_.data(), size);
+        if (!file) {
+            throw std::runtime_error("Failed to read checkpoint file: " + path);
+        }
+    }
+    Load(file);
+}
+
+void CheckpointReader::Load(std::istream& in) {
+    if (data_.empty()) {
+        // Size unknown for a generic stream: read it in blocks
+        while (in) {
+            size_t used = data_.size();
+            data_.resize(used + kReadBlock);
+            in.read(data_.data() + used, static_cast<std::streamsize>(kReadBlock));
+            data_.resize(used + static_cast<size_t>(in.gcount()));
+        }
+    }
+    if (data_.size() < sizeof(CheckpointHeader) + sizeof(uint64_t)) {
+        throw std::runtime_error("Checkpoint is truncated");
+    }
+    std::memcpy(&header_, data_.data(), sizeof(header_));
+    if (header_.magic != CheckpointHeader::kMagic) {
+        throw std::runtime_error("Not an order book checkpoint");
+    }
+    if (header_.version != CheckpointHeader::kVersion) {
+        throw std::runtime_error("Unsupported checkpoint version " + std::to_string(header_.version));
+    }
+
+    // The counts fix the exact size; they are bounded first so huge values
+    // in a damaged header cannot overflow the multiplication
+    const size_t body = data_.size() - sizeof(CheckpointHeader) - sizeof(uint64_t);
+    const uint64_t max_levels = body / sizeof(CheckpointLevel);
+    if (header_.bid_levels > max_levels || header_.ask_levels > max_levels ||
+        header_.orders > body / sizeof(CheckpointOrder) ||
+        (header_.bid_levels + header_.ask_levels) * sizeof(CheckpointLevel) +
+                header_.orders * sizeof(CheckpointOrder) != body) {
+        throw std::runtime_error("Checkpoint size does not match its header");
+    }
+
+    end_ = data_.size() - sizeof(uint64_t);
+    uint64_t stored_checksum;
+    std::memcpy(&stored_checksum, data_.data() + end_, sizeof(stored_checksum));
+    if (FoldChecksum(kChecksumSeed, data_.data(), end_) != stored_checksum) {
+        throw std::runtime_error("Checkpoint checksum mismatch");
+    }
+    position_ = sizeof(CheckpointHeader);
+}
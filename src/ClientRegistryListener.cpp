@@ -0,0 +1,122 @@
+#include "ClientRegistryListener.h"
+#include "IClient.h"
+#include <algorithm>
+#include <iostream>
+#include <string>
+
+ClientRegistryListener::~ClientRegistryListener() {
+    for (const auto& [client_id, client] : clients_) {
+        try {
+            client->Shutdown();
+        } catch (const std::exception& e) {
+            std::cerr << "Error shutting down client " << client_id << ": " << e.what() << std::endl;
+        }
+    }
+}
+
+void ClientRegistryListener::RegisterClient(std::shared_ptr<IClient> client) {
+    if (client) {
+        uint64_t client_id = client->GetClientId();
+        DropLevelUpdateClient(client_id);
+        clients_[client_id] = client;
+        if (client->WantsLevelUpdates()) {
+            level_update_clients_.push_back(client);
+        }
+        client->Initialize();
+    }
+}
+
+void ClientRegistryListener::UnregisterClient(uint64_t client_id) {
+    auto it = clients_.find(client_id);
+    if (it != clients_.end()) {
+        DropLevelUpdateClient(client_id);
+        it->second->Shutdown();
+        clients_.erase(it);
+    }
+}
+
+void ClientRegistryListener::DropLevelUpdateClient(uint64_t client_id) {
+    level_update_clients_.erase(std::remove_if(level_update_clients_.begin(), level_update_clients_.end(),
+                                               [client_id](const std::shared_ptr<IClient>& client) {
+                                                   return client->GetClientId() == client_id;
+                                               }),
+                                level_update_clients_.end());
+}
+
+void ClientRegistryListener::OnTrade(const Trade& trade) {
+    for (const auto& [client_id, client] : clients_) {
+        try {
+            client->OnTradeExecuted(trade);
+        } catch (const std::exception& e) {
+            std::cerr << "Error notifying client " << client_id << " of trade: " << e.what() << std::endl;
+        }
+    }
+}
+
+void ClientRegistryListener::OnOrderAcknowledged(uint64_t order_id) {
+    for (const auto& [client_id, client] : clients_) {
+        try {
+            client->OnOrderAcknowledged(order_id);
+        } catch (const std::exception& e) {
+            std::cerr << "Error notifying client " << client_id << " of order ack: " << e.what() << std::endl;
+        }
+    }
+}
+
+void ClientRegistryListener::OnOrderCancelled(uint64_t order_id) {
+    for (const auto& [client_id, client] : clients_) {
+        try {
+            client->OnOrderCancelled(order_id);
+        } catch (const std::exception& e) {
+            std::cerr << "Error notifying client " << client_id << " of order cancel: " << e.what() << std::endl;
+        }
+    }
+}
+
+void ClientRegistryListener::OnOrderModified(uint64_t order_id, uint64_t new_quantity, uint64_t new_price) {
+    for (const auto& [client_id, client] : clients_) {
+        try {
+            client->OnOrderModified(order_id, new_quantity, new_price);
+        } catch (const std::exception& e) {
+            std::cerr << "Error notifying client " << client_id << " of order modify: " << e.what() << std::endl;
+        }
+    }
+}
+
+void ClientRegistryListener::OnOrderRejected(uint64_t order_id, OrderStatus status) {
+    // Rejections are routine on replayed feeds; only build the reason string
+    // when someone is listening
+    if (clients_.empty()) {
+        return;
+    }
+    const std::string reason = ToString(status);
+    for (const auto& [client_id, client] : clients_) {
+        try {
+            client->OnOrderRejected(order_id, reason);
+        } catch (const std::exception& e) {
+            std::cerr << "Error notifying client " << client_id << " of order rejection: " << e.what() << std::endl;
+        }
+    }
+}
+
+void ClientRegistryListener::OnTopOfBook(uint64_t best_bid, uint64_t best_ask, uint64_t bid_volume,
+                                         uint64_t ask_volume) {
+    for (const auto& [client_id, client] : clients_) {
+        try {
+            client->OnTopOfBookUpdate(best_bid, best_ask, bid_volume, ask_volume);
+        } catch (const std::exception& e) {
+            std::cerr << "Error notifying client " << client_id << " of TOB update: " << e.what() << std::endl;
+        }
+    }
+}
+
+void ClientRegistryListener::OnLevelUpdate(const LevelUpdate& update) {
+    for (const auto& client : level_update_clients_) {
+        try {
+            client->OnLevelUpdate(update);
+        } catch (const std::exception& e) {
+            std::cerr << "Error notifying client " << client->GetClientId() << " of level update: " << e.what()
+                      << std::endl;
+        }
+    }
+}
@@ -0,0 +1,421 @@
+#include "CommandJournal.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <filesystem>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#if ORDERBOOK_HAS_JOURNAL
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+// Starts every segment file; the rest of the first 64 bytes is reserved
+struct SegmentHeader {
+    static constexpr uint64_t kMagic = 0x31304C4E524A424Full;  // "OBJRNL01"
+    static constexpr uint32_t kVersion = 1;
+
+    uint64_t magic;
+    uint32_t version;
+    uint32_t record_size;
+    uint64_t first_sequence;
+    uint64_t capacity;
+    uint64_t reserved[4];
+};
+
+static_assert(sizeof(SegmentHeader) == sizeof(JournalRecord), "Segment header fills one record slot");
+
+// Commands handed to a replay callback at once
+constexpr size_t kReplayBlock = 4096;
+
+std::string SystemError(const std::string& what, const std::string& path) {
+    return what + " " + path + ": " + std::strerror(errno);
+}
+
+// "journal-<first sequence, zero padded>.wal", so names sort in sequence order
+std::string SegmentPath(const std::string& directory, uint64_t first_sequence) {
+    char name[48];
+    std::snprintf(name, sizeof(name), "journal-%020llu.wal", static_cast<unsigned long long>(first_sequence));
+    return (std::filesystem::path(directory) / name).string();
+}
+
+// Segment files in the directory, ordered by first sequence
+std::vector<std::string> ListSegments(const std::string& directory) {
+    std::vector<std::string> segments;
+    std::error_code error;
+    for (const auto& entry : std::filesystem::directory_iterator(directory, error)) {
+        const std::string name = entry.path().filename().string();
+        if (entry.is_regular_file() && name.rfind("journal-", 0) == 0 && entry.path().extension() == ".wal") {
+            segments.push_back(entry.path().string());
+        }
+    }
+    std::sort(segments.begin(), segments.end());
+    return segments;
+}
+
+// A segment mapped read-only for the lifetime of the object
+class SegmentView {
+public:
+    explicit SegmentView(const std::string& path) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error(SystemError("Cannot open journal segment", path));
+        }
+        struct stat info;
+        if (::fstat(fd, &info) == 0 && static_cast<size_t>(info.st_size) >= sizeof(SegmentHeader)) {
+            size_ = static_cast<size_t>(info.st_size);
+            void* mapping = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapping != MAP_FAILED) {
+                mapping_ = mapping;
+                ::madvise(mapping_, size_, MADV_SEQUENTIAL);
+            }
+        }
+        ::close(fd);
+    }
+    ~SegmentView() {
+        if (mapping_ != nullptr) {
+            ::munmap(mapping_, size_);
+        }
+    }
+    SegmentView(const SegmentView&) = delete;
+    SegmentView& operator=(const SegmentView&) = delete;
+
+    // Null if the file is too short or not a journal segment
+    const SegmentHeader* Header() const {
+        if (mapping_ == nullptr) {
+            return nullptr;
+        }
+        const auto* header = static_cast<const SegmentHeader*>(mapping_);
+        if (header->magic != SegmentHeader::kMagic || header->version != SegmentHeader::kVersion ||
+            header->record_size != sizeof(JournalRecord) || header->first_sequence == 0) {
+            return nullptr;
+        }
+        return header;
+    }
+    const JournalRecord* Records() const {
+        return reinterpret_cast<const JournalRecord*>(static_cast<const char*>(mapping_) + sizeof(SegmentHeader));
+    }
+    size_t RecordCount() const {
+        const SegmentHeader* header = Header();
+        if (header == nullptr) {
+            return 0;
+        }
+        return std::min<size_t>(header->capacity, (size_ - sizeof(SegmentHeader)) / sizeof(JournalRecord));
+    }
+
+private:
+    void* mapping_ = nullptr;
+    size_t size_ = 0;
+};
+
+// Reserve the file's blocks; returns 0 or an errno value
+int Preallocate(int fd, size_t size) {
+#if defined(__APPLE__)
+    // No posix_fallocate: reserve the blocks, then extend the file over them
+    fstore_t store{F_ALLOCATEALL, F_PEOFPOSMODE, 0, static_cast<off_t>(size), 0};
+    if (::fcntl(fd, F_PREALLOCATE, &store) != 0 || ::ftruncate(fd, static_cast<off_t>(size)) != 0) {
+        return errno;
+    }
+    return 0;
+#else
+    return ::posix_fallocate(fd, 0, static_cast<off_t>(size));
+#endif
+}
+
+bool IsIntact(const JournalRecord& record, uint64_t expected_sequence) {
+    return record.sequence == expected_sequence && record.checksum == JournalRecord::Checksum(record);
+}
+
+BookCommand ToCommand(const JournalRecord& record) {
+    BookCommand command;
+    command.type = record.type;
+    command.is_buy = record.is_buy != 0;
+    command.order_id = record.order_id;
+    command.user_id = record.user_id;
+    command.quantity = record.quantity;
+    command.price = record.price;
+    command.ts_received = record.ts_received;
+    command.ts_executed = record.ts_executed;
+    return command;
+}
+
+// Walk the intact records in order, calling visit(record) on each; returns
+// the last sequence visited, or 0 if the journal is empty
+template <typename Visit>
+uint64_t ScanJournal(const std::string& directory, Visit&& visit) {
+    uint64_t last_sequence = 0;
+    bool first_segment = true;
+    for (const std::string& path : ListSegments(directory)) {
+        SegmentView segment(path);
+        const SegmentHeader* header = segment.Header();
+        if (header == nullptr) {
+            continue;
+        }
+        // Segments must continue the sequence: one starting inside the range
+        // already read is stale and skipped, and a gap ends the journal
+        if (!first_segment && header->first_sequence != last_sequence + 1) {
+            if (header->first_sequence <= last_sequence) {
+                continue;
+            }
+            break;
+        }
+        if (first_segment) {
+            last_sequence = header->first_sequence - 1;
+            first_segment = false;
+        }
+        const JournalRecord* records = segment.Records();
+        const size_t count = segment.RecordCount();
+        for (size_t i = 0; i < count && IsIntact(records[i], last_sequence + 1); ++i) {
+            visit(records[i]);
+            ++last_sequence;
+        }
+    }
+    return last_sequence;
+}
+
+}  // namespace
+
+CommandJournal::CommandJournal(const JournalConfig& config) : config_(config) {
+    if (config_.directory.empty()) {
+        throw std::invalid_argument("CommandJournal needs a directory");
+    }
+    if (config_.records_per_segment == 0) {
+        throw std::invalid_argument("CommandJournal records_per_segment must be greater than zero");
+    }
+    std::error_code error;
+    std::filesystem::create_directories(config_.directory, error);
+    if (error) {
+        throw std::runtime_error("Cannot create journal directory " + config_.directory + ": " + error.message());
+    }
+
+    // Continue after whatever an earlier run left behind, in a new segment so
+    // a torn tail is never appended to
+    last_sequence_ = ScanJournal(config_.directory, [](const JournalRecord&) {});
+    std::string segment_error;
+    if (!CreateSegment(last_sequence_ + 1, current_, segment_error)) {
+        throw std::runtime_error(segment_error);
+    }
+    UseSegment(current_);
+
+    RequestSpare();
+    preparer_ = std::thread(&CommandJournal::RunPreparer, this);
+}
+
+CommandJournal::~CommandJournal() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_preparer_.notify_one();
+    preparer_.join();
+
+    CloseSegment(current_, false);
+    CloseSegment(retired_, config_.sync_on_rollover);
+    // An unused spare holds no records; leave no empty file behind
+    if (spare_.mapping != nullptr) {
+        const std::string path = spare_.path;
+        CloseSegment(spare_, false);
+        ::unlink(path.c_str());
+    }
+}
+
+bool CommandJournal::CreateSegment(uint64_t first_sequence, Segment& segment, std::string& error) const {
+    const std::string path = SegmentPath(config_.directory, first_sequence);
+    const size_t size = sizeof(SegmentHeader) + config_.records_per_segment * sizeof(JournalRecord);
+
+    // An existing file with this name holds no intact records (they would
+    // have advanced the sequence past it), so it is safe to overwrite
+    int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        error = SystemError("Cannot create journal segment", path);
+        return false;
+    }
+    // Allocate the blocks now so a full disk fails here, not as SIGBUS on an append
+    int result = Preallocate(fd, size);
+    if (result != 0) {
+        ::close(fd);
+        ::unlink(path.c_str());
+        errno = result;
+        error = SystemError("Cannot preallocate journal segment", path);
+        return false;
+    }
+    int flags = MAP_SHARED;
+#ifdef MAP_POPULATE
+    // Fault the pages in up front so appends do not take page faults
+    flags |= MAP_POPULATE;
+#endif
+    void* mapping = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, flags, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        error = SystemError("Cannot map journal segment", path);
+        ::unlink(path.c_str());
+        return false;
+    }
+
+    auto* header = static_cast<SegmentHeader*>(mapping);
+    *header = SegmentHeader{SegmentHeader::kMagic, SegmentHeader::kVersion, sizeof(JournalRecord), first_sequence,
+                            config_.records_per_segment, {0, 0, 0, 0}};
+    segment.mapping = mapping;
+    segment.size = size;
+    segment.first_sequence = first_sequence;
+    segment.path = path;
+    return true;
+}
+
+void CommandJournal::CloseSegment(Segment& segment, bool sync) {
+    if (segment.mapping == nullptr) {
+        return;
+    }
+    ::msync(segment.mapping, segment.size, sync ? MS_SYNC : MS_ASYNC);
+    ::munmap(segment.mapping, segment.size);
+    segment = Segment();
+}
+
+void CommandJournal::UseSegment(const Segment& segment) {
+    records_ = reinterpret_cast<JournalRecord*>(static_cast<char*>(segment.mapping) + sizeof(SegmentHeader));
+    next_slot_ = 0;
+}
+
+void CommandJournal::RequestSpare() {
+    spare_state_ = SpareState::Preparing;
+    spare_requested_ = true;
+}
+
+bool CommandJournal::Rollover() noexcept {
+    std::unique_lock<std::mutex> lock(mutex_);
+    // The spare is normally ready long before the segment fills. One still
+    // being made is waited for; a failed one is retried in the background
+    // while appends fail fast.
+    spare_changed_.wait(lock, [this] { return spare_state_ != SpareState::Preparing; });
+    if (spare_state_ != SpareState::Ready) {
+        if (spare_state_ == SpareState::Failed) {
+            spare_state_ = SpareState::Retrying;
+            spare_requested_ = true;
+            wake_preparer_.notify_one();
+        }
+        return false;
+    }
+
+    // The background thread unmapped the previous full segment before it
+    // made this spare, so the retired slot is free
+    retired_ = current_;
+    current_ = spare_;
+    spare_ = Segment();
+    UseSegment(current_);
+    RequestSpare();
+    wake_preparer_.notify_one();
+    return true;
+}
+
+void CommandJournal::RunPreparer() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;) {
+        wake_preparer_.wait(lock, [this] { return stopping_ || spare_requested_ || retired_.mapping != nullptr; });
+        if (stopping_) {
+            return;
+        }
+        Segment retired = retired_;
+        retired_ = Segment();
+        const bool make_spare = spare_requested_;
+        spare_requested_ = false;
+        const uint64_t first_sequence = current_.first_sequence + config_.records_per_segment;
+        lock.unlock();
+
+        CloseSegment(retired, config_.sync_on_rollover);
+        Segment spare;
+        std::string error;
+        const bool created = make_spare && CreateSegment(first_sequence, spare, error);
+
+        lock.lock();
+        if (make_spare) {
+            if (created) {
+                spare_ = spare;
+                spare_state_ = SpareState::Ready;
+                last_error_.clear();
+            } else {
+                spare_state_ = SpareState::Failed;
+                last_error_ = error;
+            }
+            spare_changed_.notify_all();
+        }
+    }
+}
+
+std::string CommandJournal::LastError() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return last_error_;
+}
+
+void CommandJournal::Sync() {
+    if (current_.mapping != nullptr && ::msync(current_.mapping, current_.size, MS_SYNC) != 0) {
+        throw std::runtime_error(SystemError("Cannot sync journal segment in", config_.directory));
+    }
+}
+
+uint64_t CommandJournal::Replay(const std::string& directory, uint64_t after_sequence, const ReplayCallback& apply) {
+    std::vector<BookCommand> block;
+    block.reserve(kReplayBlock);
+    bool checked_start = false;
+
+    uint64_t last_sequence = ScanJournal(directory, [&](const JournalRecord& record) {
+        if (!checked_start) {
+            if (record.sequence > after_sequence + 1) {
+                throw std::runtime_error("Journal in " + directory + " starts at sequence " +
+                                         std::to_string(record.sequence) + ", after the requested " +
+                                         std::to_string(after_sequence + 1));
+            }
+            checked_start = true;
+        }
+        if (record.sequence <= after_sequence) {
+            return;
+        }
+        block.push_back(ToCommand(record));
+        if (block.size() == kReplayBlock) {
+            apply(block.data(), block.size());
+            block.clear();
+        }
+    });
+    if (!block.empty()) {
+        apply(block.data(), block.size());
+    }
+    return std::max(last_sequence, after_sequence);
+}
+
+#else  // !ORDERBOOK_HAS_JOURNAL
+
+// Without mmap there is nothing to append into: opening a journal fails,
+// and a book runs without one
+
+namespace {
+const char* const kUnsupported = "CommandJournal is only available on POSIX platforms";
+}
+
+CommandJournal::CommandJournal(const JournalConfig& config) : config_(config) {
+    throw std::runtime_error(kUnsupported);
+}
+
+CommandJournal::~CommandJournal() = default;
+
+bool CommandJournal::Rollover() noexcept {
+    return false;
+}
+
+std::string CommandJournal::LastError() const {
+    return kUnsupported;
+}
+
+void CommandJournal::Sync() {
+    throw std::runtime_error(kUnsupported);
+}
+
+uint64_t CommandJournal::Replay(const std::string&, uint64_t, const ReplayCallback&) {
+    throw std::runtime_error(kUnsupported);
+}
+
+#endif  // ORDERBOOK_HAS_JOURNAL
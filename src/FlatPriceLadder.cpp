@@ -0,0 +1,186 @@
+#include "FlatPriceLadder.h"
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+template <BookSide Side>
+FlatPriceLadder<Side>::FlatPriceLadder(const PriceLadderConfig& config)
+    : tick_size_(config.tick_size), max_window_ticks_(config.max_window_ticks) {
+    if (tick_size_ == 0) {
+        throw std::invalid_argument("Flat price ladder tick size must be greater than zero");
+    }
+    if (config.initial_window_ticks == 0 || config.initial_window_ticks > max_window_ticks_) {
+        throw std::invalid_argument("Flat price ladder window must be between 1 and max_window_ticks");
+    }
+    slots_.assign(config.initial_window_ticks, kNoLevel);
+    occupied_.Resize(config.initial_window_ticks);
+}
+
+template <BookSide Side>
+bool FlatPriceLadder<Side>::Accepts(uint64_t price) const {
+    if (!OnGrid(price)) {
+        return false;
+    }
+    if (level_count_ == 0 || InWindow(price)) {
+        return true;
+    }
+    // Re-centering has to fit the occupied range plus this price
+    uint64_t low = std::min(PriceOf(low_index_), price);
+    uint64_t high = std::max(PriceOf(high_index_), price);
+    return (high - low) / tick_size_ < max_window_ticks_;
+}
+
+template <BookSide Side>
+PriceLevel* FlatPriceLadder<Side>::Find(uint64_t price) {
+    if (!InWindow(price) || price % tick_size_ != 0) {
+        return nullptr;
+    }
+    size_t index = IndexOf(price);
+    return occupied_.Test(index) ? &Level(slots_[index]) : nullptr;
+}
+
+template <BookSide Side>
+PriceLevel& FlatPriceLadder<Side>::GetOrCreate(uint64_t price) {
+    if (!Accepts(price)) {
+        throw std::out_of_range("Price cannot be represented in flat price ladder");
+    }
+    if (!InWindow(price)) {
+        Recenter(price);
+    }
+
+    size_t index = IndexOf(price);
+    if (!occupied_.Test(index)) {
+        slots_[index] = NewLevel();
+        occupied_.Set(index);
+        if (level_count_ == 0) {
+            low_index_ = high_index_ = index;
+        } else {
+            low_index_ = std::min(low_index_, index);
+            high_index_ = std::max(high_index_, index);
+        }
+        ++level_count_;
+    }
+    return Level(slots_[index]);
+}
+
+template <BookSide Side>
+bool FlatPriceLadder<Side>::PrepareLevel(uint64_t price) {
+    if (!InWindow(price)) {
+        if (!Accepts(price)) {
+            throw std::out_of_range("Price cannot be represented in flat price ladder");
+        }
+        // Re-centering moves only handles, so level pointers survive it
+        Recenter(price);
+    }
+    return ReserveLevel();
+}
+
+template <BookSide Side>
+void FlatPriceLadder<Side>::Erase(uint64_t price) {
+    if (!InWindow(price) || price % tick_size_ != 0) {
+        return;
+    }
+    size_t index = IndexOf(price);
+    if (!occupied_.Test(index)) {
+        return;
+    }
+
+    occupied_.Clear(index);
+    FreeLevel(slots_[index]);
+    slots_[index] = kNoLevel;
+    --level_count_;
+    if (level_count_ == 0) {
+        return;
+    }
+
+    // Jump inwards to the next occupied slot if an edge was removed
+    if (index == low_index_) {
+        low_index_ = occupied_.FindNext(index);
+    }
+    if (index == high_index_) {
+        high_index_ = occupied_.FindPrev(index);
+    }
+}
+
+template <BookSide Side>
+PriceLevel* FlatPriceLadder<Side>::Best() {
+    if (level_count_ == 0) {
+        return nullptr;
+    }
+    return &Level(slots_[Side == BookSide::Bid ? high_index_ : low_index_]);
+}
+
+template <BookSide Side>
+PriceLevel* FlatPriceLadder<Side>::NextWorse(uint64_t price) {
+    if (level_count_ == 0) {
+        return nullptr;
+    }
+
+    size_t index = OccupancyBitmap::npos;
+    if constexpr (Side == BookSide::Bid) {
+        // Highest occupied slot strictly below price
+        if (price <= base_) {
+            return nullptr;
+        }
+        uint64_t ticks_below = (price - base_ + tick_size_ - 1) / tick_size_;
+        index = occupied_.FindPrev(static_cast<size_t>(std::min<uint64_t>(ticks_below, slots_.size())) - 1);
+    } else {
+        // Lowest occupied slot strictly above price
+        uint64_t first = price >= base_ ? (price - base_) / tick_size_ + 1 : 0;
+        if (first >= slots_.size()) {
+            return nullptr;
+        }
+        index = occupied_.FindNext(static_cast<size_t>(first));
+    }
+    return index != OccupancyBitmap::npos ? &Level(slots_[index]) : nullptr;
+}
+
+template <BookSide Side>
+void FlatPriceLadder<Side>::Recenter(uint64_t price) {
+    uint64_t low = price;
+    uint64_t high = price;
+    if (level_count_ > 0) {
+        low = std::min(low, PriceOf(low_index_));
+        high = std::max(high, PriceOf(high_index_));
+    }
+
+    // Leave as much slack again as the occupied span so drift does not
+    // immediately trigger another re-center
+    uint64_t span = (high - low) / tick_size_ + 1;
+    size_t window = slots_.size();
+    while (window < 2 * span && window < max_window_ticks_) {
+        window *= 2;
+    }
+    window = std::min(window, max_window_ticks_);
+
+    // Split the spare ticks evenly below and above the occupied range
+    uint64_t slack = static_cast<uint64_t>((window - span) / 2) * tick_size_;
+    uint64_t new_base = low >= slack ? low - slack : 0;
+    uint64_t full_width = static_cast<uint64_t>(window - 1) * tick_size_;
+    uint64_t max_base = std::numeric_limits<uint64_t>::max() - full_width;
+    max_base -= max_base % tick_size_;
+    new_base = std::min(new_base, max_base);
+
+    std::vector<LevelHandle> new_slots(window, kNoLevel);
+    OccupancyBitmap new_occupied(window);
+    if (level_count_ > 0) {
+        for (size_t i = low_index_; i != OccupancyBitmap::npos; i = occupied_.FindNext(i + 1)) {
+            size_t new_index = static_cast<size_t>((PriceOf(i) - new_base) / tick_size_);
+            // Only the handle moves; orders keep pointing at the same level
+            new_slots[new_index] = slots_[i];
+            new_occupied.Set(new_index);
+        }
+    }
+
+    base_ = new_base;
+    slots_.swap(new_slots);
+    occupied_ = std::move(new_occupied);
+    if (level_count_ > 0) {
+        low_index_ = occupied_.FindFirst();
+        high_index_ = occupied_.FindLast();
+    }
+}
+
+template class FlatPriceLadder<BookSide::Bid>;
+template class FlatPriceLadder<BookSide::Ask>;
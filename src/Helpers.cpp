@@ -1,4 +1,13 @@
 #include "Helpers.h"
+#include "TscClock.h"
 
 // Define the static member
 std::atomic<uint64_t> Helpers::last_order_number{0};
+
+uint64_t Helpers::GetTimeStampNs() {
+    return TscClock::Instance().NowUnix();
+}
+
+uint64_t Helpers::GetMonotonicNs() {
+    return TscClock::Instance().Now();
+}
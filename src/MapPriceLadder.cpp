@@ -0,0 +1,76 @@
+#include "MapPriceLadder.h"
+#include <utility>
+
+template <BookSide Side>
+bool MapPriceLadder<Side>::Accepts(uint64_t price) const {
+    (void)price; // Any price can be a map key
+    return true;
+}
+
+template <BookSide Side>
+PriceLevel* MapPriceLadder<Side>::Find(uint64_t price) {
+    auto it = index_.find(price);
+    return it != index_.end() ? &Level(it->second) : nullptr;
+}
+
+template <BookSide Side>
+PriceLevel& MapPriceLadder<Side>::GetOrCreate(uint64_t price) {
+    auto it = index_.lower_bound(price);
+    if (it != index_.end() && it->first == price) {
+        return Level(it->second);
+    }
+
+    const LevelHandle handle = NewLevel();
+    if (!spare_node_.empty()) {
+        spare_node_.key() = price;
+        spare_node_.mapped() = handle;
+        it = index_.insert(it, std::move(spare_node_));
+    } else {
+        try {
+            it = index_.emplace_hint(it, price, handle);
+        } catch (...) {
+            FreeLevel(handle);
+            throw;
+        }
+    }
+    return Level(it->second);
+}
+
+template <BookSide Side>
+void MapPriceLadder<Side>::Erase(uint64_t price) {
+    auto it = index_.find(price);
+    if (it == index_.end()) {
+        return;
+    }
+    FreeLevel(it->second);
+    auto node = index_.extract(it);
+    if (spare_node_.empty()) {
+        spare_node_ = std::move(node);
+    }
+}
+
+template <BookSide Side>
+bool MapPriceLadder<Side>::PrepareLevel(uint64_t price) {
+    if (spare_node_.empty()) {
+        // A node can only be made inside a map, so build it in a scratch one
+        Index scratch;
+        scratch.emplace(price, kNoLevel);
+        spare_node_ = scratch.extract(scratch.begin());
+    }
+    return ReserveLevel();
+}
+
+template <BookSide Side>
+PriceLevel* MapPriceLadder<Side>::Best() {
+    return index_.empty() ? nullptr : &Level(index_.begin()->second);
+}
+
+template <BookSide Side>
+PriceLevel* MapPriceLadder<Side>::NextWorse(uint64_t price) {
+    // The map is ordered best-first, so worse prices come after this one
+    auto it = index_.upper_bound(price);
+    return it != index_.end() ? &Level(it->second) : nullptr;
+}
+
+template class MapPriceLadder<BookSide::Bid>;
+template class MapPriceLadder<BookSide::Ask>;
@@ -0,0 +1,17 @@
+#include "OccupancyBitmap.h"
+
+void OccupancyBitmap::Resize(size_t size) {
+    size_ = size;
+    tiers_.clear();
+    if (size == 0) {
+        return;
+    }
+
+    // Add summary tiers until one word covers everything below it
+    size_t words = (size + 63) / 64;
+    tiers_.emplace_back(words, 0);
+    while (words > 1) {
+        words = (words + 63) / 64;
+        tiers_.emplace_back(words, 0);
+    }
+}
@@ -0,0 +1,41 @@
+#include "OrderBookRegistry.h"
+#include <algorithm>
+#include <stdexcept>
+
+OrderBookRegistry::OrderBookRegistry(const OrderBookConfig& default_config, uint32_t direct_id_limit)
+    : default_config_(default_config), direct_id_limit_(direct_id_limit) {}
+
+void OrderBookRegistry::SetInstrumentConfig(uint32_t instrument_id, const OrderBookConfig& config) {
+    if (FindSlot(instrument_id) != npos) {
+        throw std::invalid_argument("Book for instrument already exists");
+    }
+    instrument_configs_[instrument_id] = config;
+}
+
+size_t OrderBookRegistry::Create(uint32_t instrument_id) {
+    auto config_it = instrument_configs_.find(instrument_id);
+    OrderBookConfig config = config_it != instrument_configs_.end() ? config_it->second : default_config_;
+    // Trade IDs are namespaced by instrument, so they are unique across books
+    config.book_id = instrument_id;
+    auto book = std::make_shared<OrderBook>(config);
+
+    size_t slot = books_.size();
+    books_.push_back(book);
+    instrument_ids_.push_back(instrument_id);
+
+    if (instrument_id < direct_id_limit_) {
+        if (instrument_id >= direct_slots_.size()) {
+            // Grow geometrically so a run of new IDs does not reallocate every time
+            size_t new_size = std::max<size_t>(static_cast<size_t>(instrument_id) + 1, direct_slots_.size() * 2);
+            direct_slots_.resize(std::min<size_t>(new_size, direct_id_limit_), 0);
+        }
+        direct_slots_[instrument_id] = static_cast<uint32_t>(slot + 1);
+    } else {
+        overflow_slots_[instrument_id] = slot;
+    }
+
+    if (on_book_created_) {
+        on_book_created_(slot, instrument_id, books_.back());
+    }
+    return slot;
+}
@@ -0,0 +1,127 @@
+#include "OrderIndex.h"
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+constexpr size_t kMinCapacity = 16;
+
+// Largest entry count a table of `capacity` slots holds (7/8 load factor)
+size_t MaxEntries(size_t capacity) {
+    return capacity - capacity / 8;
+}
+}
+
+OrderIndex::OrderIndex(size_t expected_size) {
+    Rehash(kMinCapacity);
+    Reserve(expected_size);
+}
+
+bool OrderIndex::Insert(uint64_t order_id, OrderHandle order) {
+    if (order == kNoOrder) {
+        throw std::invalid_argument("Cannot index an empty order handle");
+    }
+    if (size_ + 1 > MaxEntries(slots_.size())) {
+        Rehash(slots_.size() * 2);
+    }
+
+    // Probe as a lookup until the slot where Robin Hood would displace an
+    // entry; a duplicate ID is always found before that point
+    size_t index = HomeSlot(order_id);
+    size_t distance = 0;
+    for (;; ++distance) {
+        Slot& slot = slots_[index];
+        if (slot.value == kNoOrder) {
+            slot.key = order_id;
+            slot.value = order;
+            ++size_;
+            return true;
+        }
+        if (slot.key == order_id) {
+            return false;
+        }
+        if (ProbeDistance(slot.key, index) < distance) {
+            break;
+        }
+        index = (index + 1) & mask_;
+    }
+
+    // Take the richer entry's slot and carry it forward
+    Place(index, distance, Slot{order_id, order});
+    return true;
+}
+
+bool OrderIndex::Erase(uint64_t order_id) {
+    size_t index = HomeSlot(order_id);
+    for (size_t distance = 0;; ++distance) {
+        const Slot& slot = slots_[index];
+        if (slot.value == kNoOrder || ProbeDistance(slot.key, index) < distance) {
+            return false;
+        }
+        if (slot.key == order_id) {
+            break;
+        }
+        index = (index + 1) & mask_;
+    }
+
+    // Backward-shift deletion: pull following displaced entries one slot
+    // closer to home until an empty slot or an entry already at home
+    size_t next = (index + 1) & mask_;
+    while (slots_[next].value != kNoOrder && ProbeDistance(slots_[next].key, next) != 0) {
+        slots_[index] = slots_[next];
+        index = next;
+        next = (next + 1) & mask_;
+    }
+    slots_[index] = Slot{};
+    --size_;
+    return true;
+}
+
+void OrderIndex::Reserve(size_t count) {
+    size_t capacity = slots_.size();
+    while (MaxEntries(capacity) < count) {
+        capacity *= 2;
+    }
+    if (capacity != slots_.size()) {
+        Rehash(capacity);
+    }
+}
+
+void OrderIndex::Clear() {
+    std::fill(slots_.begin(), slots_.end(), Slot{});
+    size_ = 0;
+}
+
+void OrderIndex::Rehash(size_t capacity) {
+    std::vector<Slot> old_slots(capacity);
+    old_slots.swap(slots_);
+    mask_ = capacity - 1;
+    shift_ = 64;
+    for (size_t bits = capacity; bits > 1; bits >>= 1) {
+        --shift_;
+    }
+    size_ = 0;
+
+    for (const Slot& slot : old_slots) {
+        if (slot.value != kNoOrder) {
+            Place(HomeSlot(slot.key), 0, slot);
+        }
+    }
+}
+
+void OrderIndex::Place(size_t index, size_t distance, Slot carried) {
+    for (;; ++distance) {
+        Slot& slot = slots_[index];
+        if (slot.value == kNoOrder) {
+            slot = carried;
+            ++size_;
+            return;
+        }
+        size_t existing_distance = ProbeDistance(slot.key, index);
+        if (existing_distance < distance) {
+            std::swap(slot, carried);
+            distance = existing_distance;
+        }
+        index = (index + 1) & mask_;
+    }
+}
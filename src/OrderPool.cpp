@@ -0,0 +1,119 @@
+#include "OrderPool.h"
+#include <algorithm>
+#include <new>
+#include <stdexcept>
+
+namespace {
+// Chunks start on a cache line so each line holds two whole orders
+constexpr std::align_val_t kChunkAlignment{64};
+}
+
+OrderPool::OrderPool(const OrderPoolConfig& config) : config_(config) {
+    if (!(config_.growth_factor >= 1.0)) {
+        throw std::invalid_argument("Order pool growth factor must be at least 1.0");
+    }
+    if (config_.initial_capacity > kMaxChunks * kMaxChunkSize) {
+        throw std::invalid_argument("Order pool initial capacity exceeds what 32-bit handles can address");
+    }
+    if (config_.initial_capacity > 0) {
+        Grow(config_.initial_capacity);
+    }
+}
+
+OrderPool::~OrderPool() {
+    for (size_t chunk = 0; chunk < chunk_count_; ++chunk) {
+        ::operator delete(orders_[chunk], kChunkAlignment);
+        delete[] details_[chunk];
+    }
+}
+
+OrderHandle OrderPool::Acquire(const Order& value, const OrderDetails& details) {
+    OrderHandle handle;
+    if (!free_list_.empty()) {
+        handle = free_list_.back();
+        free_list_.pop_back();
+    } else {
+        if (fresh_next_ == fresh_end_) {
+            // One chunk per grow, never less than an eighth of the pool, so
+            // chunk sizes grow geometrically whatever the config says and the
+            // 255 chunks reach at least ~1.8 billion orders
+            const double growth = static_cast<double>(capacity_) * (config_.growth_factor - 1.0);
+            const size_t chunk = growth < static_cast<double>(kMaxChunkSize) ? static_cast<size_t>(growth)
+                                                                              : kMaxChunkSize;
+            Grow(std::min(std::max({chunk, capacity_ / 8, config_.min_growth, size_t{1}}), kMaxChunkSize));
+        }
+        handle = fresh_next_++;
+    }
+    // Order is trivially destructible, so constructing over a released (or
+    // never-used) slot is all initialisation needs
+    new (&Get(handle)) Order(value);
+    Details(handle) = details;
+    return handle;
+}
+
+OrderHandle OrderPool::TryAcquire(const Order& value, const OrderDetails& details) noexcept {
+    try {
+        return Acquire(value, details);
+    } catch (const std::exception&) {
+        // Out of chunks or out of memory; Grow() left the pool as it was
+        return kNoOrder;
+    }
+}
+
+void OrderPool::Release(OrderHandle handle) {
+    if (handle == kNoOrder) {
+        throw std::invalid_argument("Cannot release an empty order handle");
+    }
+    // free_list_ is reserved to capacity_ in Grow(), so this never reallocates
+    free_list_.push_back(handle);
+}
+
+void OrderPool::Reserve(size_t capacity) {
+    if (capacity > capacity_) {
+        Grow(capacity - capacity_);
+    }
+}
+
+void OrderPool::Grow(size_t count) {
+    const size_t chunks_needed = (count + kMaxChunkSize - 1) / kMaxChunkSize;
+    if (chunks_needed > kMaxChunks - chunk_count_) {
+        throw std::length_error("Order pool cannot address more than 255 chunks of 2^24 orders");
+    }
+    // The free list is sized first and a chunk is only added once both of
+    // its arrays are allocated, so a failed grow keeps the pool consistent
+    // (and a single-chunk grow, the kind Acquire does, leaves it unchanged)
+    free_list_.reserve(capacity_ + count);
+
+    // Fresh orders only come from the newest chunk, so whatever is left of
+    // the current one (after a Reserve) moves to the free list, pushed in
+    // reverse so it is still handed out in address order
+    for (OrderHandle handle = fresh_end_; handle != fresh_next_; --handle) {
+        free_list_.push_back(handle - 1);
+    }
+    fresh_next_ = fresh_end_;
+
+    // A chunk is left untouched until its orders are first acquired
+    while (count > 0) {
+        const size_t chunk_size = std::min(count, kMaxChunkSize);
+        auto* orders = static_cast<Order*>(::operator new(chunk_size * sizeof(Order), kChunkAlignment));
+        OrderDetails* details;
+        try {
+            details = new OrderDetails[chunk_size];
+        } catch (...) {
+            ::operator delete(orders, kChunkAlignment);
+            throw;
+        }
+        const OrderHandle first = static_cast<OrderHandle>(chunk_count_ << kSlotBits);
+        orders_[chunk_count_] = orders;
+        details_[chunk_count_] = details;
+        ++chunk_count_;
+        // Only the last chunk stays fresh; earlier ones go to the free list
+        for (OrderHandle handle = fresh_end_; handle != fresh_next_; --handle) {
+            free_list_.push_back(handle - 1);
+        }
+        fresh_next_ = first;
+        fresh_end_ = first + static_cast<OrderHandle>(chunk_size);
+        capacity_ += chunk_size;
+        count -= chunk_size;
+    }
+}
@@ -0,0 +1,43 @@
+#include "PriceLadder.h"
+#include "MapPriceLadder.h"
+#include "FlatPriceLadder.h"
+#include <algorithm>
+#include <stdexcept>
+
+LevelHandle PriceLadder::NewLevel() {
+    ReserveLevel();
+    if (!free_levels_.empty()) {
+        const LevelHandle handle = free_levels_.back();
+        free_levels_.pop_back();
+        levels_[handle] = PriceLevel(handle);
+        return handle;
+    }
+    const LevelHandle handle = static_cast<LevelHandle>(levels_.size());
+    levels_.emplace_back(handle);
+    return handle;
+}
+
+void PriceLadder::GrowLevels() {
+    if (levels_.size() >= kNoLevel) {
+        throw std::length_error("Price ladder cannot hold more than 2^31 - 1 levels");
+    }
+    // The free list is grown first, so if either allocation fails the levels
+    // have not moved
+    const size_t capacity = std::min<size_t>(std::max<size_t>(64, levels_.capacity() * 2), kNoLevel);
+    free_levels_.reserve(capacity);
+    levels_.reserve(capacity);
+}
+
+std::unique_ptr<PriceLadder> MakePriceLadder(BookSide side, const PriceLadderConfig& config) {
+    if (config.type == PriceLadderType::Flat) {
+        if (side == BookSide::Bid) {
+            return std::make_unique<FlatPriceLadder<BookSide::Bid>>(config);
+        }
+        return std::make_unique<FlatPriceLadder<BookSide::Ask>>(config);
+    }
+
+    if (side == BookSide::Bid) {
+        return std::make_unique<MapPriceLadder<BookSide::Bid>>();
+    }
+    return std::make_unique<MapPriceLadder<BookSide::Ask>>();
+}
@@ -4,79 +4,74 @@
 #include "Trade.h"
 #include <algorithm>
 #include "Helpers.h"
-void PriceLevel::AddOrder(Order* order) {
-    // Check for null pointer
-    if (!order) {
+void PriceLevel::AddOrder(OrderPool& pool, OrderHandle handle) {
+    // Check for an empty handle
+    if (handle == kNoOrder) {
         throw std::invalid_argument("Cannot add null order");
     }
-    
+    Order& order = pool.Get(handle);
+
     // Initialize price if this is the first order
-    if (order_queue_.empty()) {
-        price_ = order->price;
+    if (head_ == kNoOrder) {
+        price_ = order.price;
     }
-    
-    order_queue_.push_back(order);
-    total_volume_ += order->quantity;
-    order->parent_price_level = this;
-    order->position_in_list = --order_queue_.end(); 
+
+    // Append to the tail of the intrusive queue
+    order.prev_in_level = tail_;
+    order.next_in_level = kNoOrder;
+    if (tail_ != kNoOrder) {
+        pool.Get(tail_).next_in_level = handle;
+    } else {
+        head_ = handle;
+    }
+    tail_ = handle;
+    ++order_count_;
+    total_volume_ += order.quantity;
+    order.SetLevel(handle_);
 }
-void PriceLevel::RemoveOrder(Order* order) {
-    if (!order) {
+void PriceLevel::RemoveOrder(OrderPool& pool, OrderHandle handle) {
+    if (handle == kNoOrder) {
         throw std::invalid_argument("Cannot remove null order");
     }
-    
+    Order& order = pool.Get(handle);
+
     // Check if the order belongs to this price level
-    if (order->parent_price_level != this) {
+    if (order.Level() != handle_ || order.price != price_) {
         throw std::runtime_error("Order not found in PriceLevel");
     }
-    
-    // Find and remove the order
-    auto it = std::find(order_queue_.begin(), order_queue_.end(), order);
-    if (it != order_queue_.end()) {
-        total_volume_ -= order->quantity;
-        order_queue_.erase(it);
-        order->parent_price_level = nullptr; // Clear the parent pointer
-        order->position_in_list = order_queue_.end(); // Reset the iterator
-    } else {
+
+    // O(1) unlink using the order's own links
+    total_volume_ -= order.quantity;
+    Unlink(pool, order);
+}
+void PriceLevel::ReduceOrderQuantity(Order& order, uint32_t new_quantity) {
+    if (order.Level() != handle_ || order.price != price_) {
         throw std::runtime_error("Order not found in PriceLevel");
     }
+    if (new_quantity > order.quantity) {
+        throw std::invalid_argument("Quantity can only be reduced in place");
+    }
+    total_volume_ -= order.quantity - new_quantity;
+    order.quantity = new_quantity;
 }
-std::vector<Trade> PriceLevel::FillOrder(Order* order, uint64_t quantity) {
-    std::vector<Trade> trades;
-    if (quantity == 0 || order_queue_.empty()) {
-        return trades; // No orders to fill or zero quantity
+void PriceLevel::Unlink(OrderPool& pool, Order& order) {
+    if (order.prev_in_level != kNoOrder) {
+        pool.Get(order.prev_in_level).next_in_level = order.next_in_level;
+    } else {
+        head_ = order.next_in_level;
     }
-
-    uint64_t remaining_quantity = quantity;
-    while (remaining_quantity > 0 && !order_queue_.empty()) {
-        Order* top_order = GetTopOrder();
-        if (!top_order) break;
-        
-        uint64_t fill_quantity = std::min(remaining_quantity, top_order->quantity);
-        Trade trade{
-            Helpers::GenerateExecutionId(), // execution_id
-            order->order_id, // aggressor_order_id
-            top_order->order_id, // resting_order_id
-            order->user_id, // aggressor_user_id
-            top_order->user_id, // resting_user_id
-            price_, // price
-            fill_quantity, // quantity
-            order->ts_received, // ts_received (from aggressor order)
-            order->ts_executed  // ts_executed (from aggressor order - should be historical timestamp)
-        };
-        trades.push_back(trade);
-        
-        // Update quantities
-        top_order->quantity -= fill_quantity;
-        total_volume_ -= fill_quantity;  // Update total volume
-        remaining_quantity -= fill_quantity;
-        
-        if (top_order->quantity == 0) {
-            // Remove the order from the price level - OrderBook will handle deletion
-            order_queue_.pop_front();
-            top_order->parent_price_level = nullptr;
-        }
+    if (order.next_in_level != kNoOrder) {
+        pool.Get(order.next_in_level).prev_in_level = order.prev_in_level;
+    } else {
+        tail_ = order.prev_in_level;
     }
-
+    --order_count_;
+    order.SetLevel(kNoLevel);
+    order.prev_in_level = kNoOrder;
+    order.next_in_level = kNoOrder;
+}
+std::vector<Trade> PriceLevel::FillOrder(OrderPool& pool, OrderHandle order, uint64_t quantity) {
+    std::vector<Trade> trades;
+    FillOrder(pool, order, quantity, [&trades](const Trade& trade, OrderHandle) { trades.push_back(trade); });
     return trades;
-}
\ No newline at end of file
+}
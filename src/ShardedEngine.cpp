@@ -0,0 +1,150 @@
+#include "ShardedEngine.h"
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+ShardedEngine::ShardedEngine(const ShardedEngineConfig& config) : config_(config) {
+    if (config_.num_shards == 0) {
+        throw std::invalid_argument("ShardedEngine needs at least one shard");
+    }
+    if (config_.max_batch == 0) {
+        throw std::invalid_argument("ShardedEngine max_batch must be greater than zero");
+    }
+    shards_.reserve(config_.num_shards);
+    for (size_t i = 0; i < config_.num_shards; ++i) {
+        shards_.push_back(std::make_unique<Shard>(config_));
+    }
+}
+
+ShardedEngine::~ShardedEngine() {
+    Stop();
+}
+
+void ShardedEngine::ThrowIfRunning(const char* what) const {
+    if (running_) {
+        throw std::runtime_error(std::string("Cannot ") + what + " while the engine is running");
+    }
+}
+
+void ShardedEngine::AssignInstrument(uint32_t instrument_id, size_t shard) {
+    ThrowIfRunning("assign instruments");
+    if (shard >= shards_.size()) {
+        throw std::invalid_argument("Shard index out of range");
+    }
+    assignments_[instrument_id] = shard;
+}
+
+void ShardedEngine::SetBookCreatedCallback(BookCreatedCallback callback) {
+    ThrowIfRunning("change the book-created callback");
+    on_book_created_ = std::move(callback);
+}
+
+void ShardedEngine::Start() {
+    if (running_) {
+        return;
+    }
+    for (size_t i = 0; i < shards_.size(); ++i) {
+        Shard& shard = *shards_[i];
+        shard.ring.Reopen();
+        shard.registry.SetBookCreatedCallback(
+            [this, i](size_t slot, uint32_t instrument_id, const std::shared_ptr<OrderBook>& book) {
+                shards_[i]->books.store(slot + 1, std::memory_order_relaxed);
+                if (on_book_created_) {
+                    on_book_created_(i, slot, instrument_id, book);
+                }
+            });
+        shard.worker = std::thread(&ShardedEngine::RunShard, this, i);
+    }
+    running_ = true;
+}
+
+void ShardedEngine::Stop() {
+    if (!running_) {
+        return;
+    }
+    for (auto& shard : shards_) {
+        shard->ring.Close();
+    }
+    for (auto& shard : shards_) {
+        shard->worker.join();
+    }
+    running_ = false;
+}
+
+void ShardedEngine::Submit(uint32_t instrument_id, const BookCommand& command) {
+    if (!running_) {
+        throw std::runtime_error("ShardedEngine is not running");
+    }
+    shards_[ShardFor(instrument_id)]->ring.Push(ShardCommand{command, instrument_id});
+}
+
+void ShardedEngine::RunShard(size_t index) {
+    Shard& shard = *shards_[index];
+    std::vector<ShardCommand> batch(config_.max_batch);
+    std::vector<BookCommand> run;
+    run.reserve(config_.max_batch);
+
+    // Single writer: plain load + store instead of a locked read-modify-write
+    auto bump = [](std::atomic<uint64_t>& counter, uint64_t by) {
+        counter.store(counter.load(std::memory_order_relaxed) + by, std::memory_order_relaxed);
+    };
+
+    // Returns 0 only after Stop closes the ring and it has been drained
+    while (size_t count = shard.ring.WaitPopBatch(batch.data(), batch.size())) {
+        // Consecutive commands for one instrument go through ApplyBatch together
+        uint64_t succeeded = 0;
+        for (size_t begin = 0; begin < count;) {
+            const uint32_t instrument_id = batch[begin].instrument_id;
+            size_t end = begin;
+            run.clear();
+            while (end < count && batch[end].instrument_id == instrument_id) {
+                run.push_back(batch[end].command);
+                ++end;
+            }
+            OrderBook& book = shard.registry.GetOrCreate(instrument_id);
+            succeeded += book.ApplyBatch(run.data(), run.size());
+            begin = end;
+        }
+
+        bump(shard.commands, count);
+        bump(shard.rejected, count - succeeded);
+    }
+}
+
+ShardStats ShardedEngine::GetShardStats(size_t shard) const {
+    if (shard >= shards_.size()) {
+        throw std::invalid_argument("Shard index out of range");
+    }
+    const Shard& s = *shards_[shard];
+    IngressRingStats ring = s.ring.GetStats();
+    ShardStats stats;
+    stats.commands = s.commands.load(std::memory_order_relaxed);
+    stats.rejected = s.rejected.load(std::memory_order_relaxed);
+    stats.batches = ring.batches;
+    stats.books = s.books.load(std::memory_order_relaxed);
+    stats.submit_stalls = ring.overflows;
+    stats.max_queue_depth = ring.high_water;
+    return stats;
+}
+
+ShardStats ShardedEngine::GetTotalStats() const {
+    ShardStats total;
+    for (size_t i = 0; i < shards_.size(); ++i) {
+        ShardStats stats = GetShardStats(i);
+        total.commands += stats.commands;
+        total.rejected += stats.rejected;
+        total.batches += stats.batches;
+        total.books += stats.books;
+        total.submit_stalls += stats.submit_stalls;
+        total.max_queue_depth = std::max(total.max_queue_depth, stats.max_queue_depth);
+    }
+    return total;
+}
+
+OrderBookRegistry& ShardedEngine::Registry(size_t shard) {
+    ThrowIfRunning("access a shard's books");
+    if (shard >= shards_.size()) {
+        throw std::invalid_argument("Shard index out of range");
+    }
+    return shards_[shard]->registry;
+}
@@ -0,0 +1,189 @@
+#include "TscClock.h"
+#include <algorithm>
+#include <cmath>
+#include <ctime>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#endif
+
+namespace {
+
+#if defined(CLOCK_MONOTONIC_RAW)
+constexpr clockid_t kMonotonicClock = CLOCK_MONOTONIC_RAW;
+#elif defined(CLOCK_MONOTONIC)
+constexpr clockid_t kMonotonicClock = CLOCK_MONOTONIC;
+#endif
+
+// Error beyond which a resync that is behind the reference steps forward to
+// it; an error in the other direction is only ever steered out, at most this
+// much per interval, so the clock never runs backwards
+constexpr int64_t kMaxSteerNs = 1000000;
+
+#if defined(CLOCK_REALTIME)
+uint64_t ReadClock(clockid_t clock) {
+    timespec ts;
+    clock_gettime(clock, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + static_cast<uint64_t>(ts.tv_nsec);
+}
+#else
+template <typename Clock>
+uint64_t ReadClock() {
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count());
+}
+#endif
+
+// CPUID.80000007H:EDX[8]: the TSC ticks at a constant rate in every power state
+bool HasInvariantTsc() {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    int registers[4] = {};
+    __cpuid(registers, static_cast<int>(0x80000000u));
+    if (static_cast<unsigned>(registers[0]) < 0x80000007u) {
+        return false;
+    }
+    __cpuid(registers, static_cast<int>(0x80000007u));
+    return (static_cast<unsigned>(registers[3]) & (1u << 8)) != 0;
+#elif defined(__x86_64__) || defined(__i386__)
+    unsigned eax = 0, ebx = 0, ecx = 0, edx = 0;
+    if (__get_cpuid(0x80000000u, &eax, &ebx, &ecx, &edx) == 0 || eax < 0x80000007u) {
+        return false;
+    }
+    __get_cpuid(0x80000007u, &eax, &ebx, &ecx, &edx);
+    return (edx & (1u << 8)) != 0;
+#else
+    return false;
+#endif
+}
+
+// A TSC reading and the reference time at (nearly) the same instant: the
+// reference read is bracketed by two TSC reads and the tightest of a few
+// attempts is kept
+struct ClockSample {
+    uint64_t tsc;
+    uint64_t ns;
+};
+
+ClockSample SampleClocks() {
+    ClockSample best{0, 0};
+    uint64_t best_gap = UINT64_MAX;
+    for (int attempt = 0; attempt < 5; ++attempt) {
+        uint64_t before = TscClock::ReadTsc();
+        uint64_t ns = TscClock::ReadMonotonicRaw();
+        uint64_t after = TscClock::ReadTsc();
+        if (after - before < best_gap) {
+            best_gap = after - before;
+            best = ClockSample{before + (after - before) / 2, ns};
+        }
+    }
+    return best;
+}
+
+uint64_t ToFixedPoint(double ns_per_tick, int shift) {
+    return static_cast<uint64_t>(std::llround(std::ldexp(ns_per_tick, shift)));
+}
+
+}  // namespace
+
+uint64_t TscClock::ReadMonotonicRaw() {
+#if defined(CLOCK_REALTIME)
+    return ReadClock(kMonotonicClock);
+#else
+    return ReadClock<std::chrono::steady_clock>();
+#endif
+}
+
+uint64_t TscClock::ReadRealtime() {
+#if defined(CLOCK_REALTIME)
+    return ReadClock(CLOCK_REALTIME);
+#else
+    return ReadClock<std::chrono::system_clock>();
+#endif
+}
+
+TscClock& TscClock::Instance() {
+    static TscClock clock;
+    return clock;
+}
+
+TscClock::TscClock(std::chrono::nanoseconds calibration_window, std::chrono::nanoseconds resync_interval) {
+    uses_tsc_ = HasInvariantTsc();
+    if (!uses_tsc_) {
+        return;
+    }
+
+    // Measure the rate by spinning through the calibration window
+    ClockSample start = SampleClocks();
+    const uint64_t window = static_cast<uint64_t>(calibration_window.count());
+    while (ReadMonotonicRaw() - start.ns < window) {
+    }
+    ClockSample end = SampleClocks();
+    if (end.tsc <= start.tsc) {
+        uses_tsc_ = false;
+        return;
+    }
+    const double ns_per_tick = static_cast<double>(end.ns - start.ns) / static_cast<double>(end.tsc - start.tsc);
+
+    reference_tsc_ = start.tsc;
+    reference_ns_ = start.ns;
+    resync_ticks_ = static_cast<int64_t>(static_cast<double>(resync_interval.count()) / ns_per_tick);
+    if (resync_ticks_ <= 0) {
+        resync_ticks_ = 1;
+    }
+    base_tsc_.store(end.tsc, std::memory_order_relaxed);
+    base_ns_.store(end.ns, std::memory_order_relaxed);
+    ns_per_tick_.store(ToFixedPoint(ns_per_tick, kShift), std::memory_order_relaxed);
+    unix_offset_.store(ReadRealtime() - ReadMonotonicRaw(), std::memory_order_relaxed);
+    sequence_.store(2, std::memory_order_release);
+}
+
+double TscClock::TicksPerNanosecond() const {
+    const uint64_t ns_per_tick = ns_per_tick_.load(std::memory_order_relaxed);
+    return ns_per_tick == 0 ? 0.0 : 1.0 / std::ldexp(static_cast<double>(ns_per_tick), -kShift);
+}
+
+bool TscClock::Resync(uint64_t sequence, uint64_t tsc) {
+    // One thread resyncs; the others keep converting with the old parameters
+    uint64_t expected = sequence;
+    if (!sequence_.compare_exchange_strong(expected, sequence + 1, std::memory_order_relaxed)) {
+        return false;
+    }
+    std::atomic_thread_fence(std::memory_order_release);
+
+    ClockSample now = SampleClocks();
+    if (now.tsc < tsc) {
+        now.tsc = tsc;
+    }
+    const uint64_t base_tsc = base_tsc_.load(std::memory_order_relaxed);
+    const uint64_t base_ns = base_ns_.load(std::memory_order_relaxed);
+    const uint64_t old_ns_per_tick = ns_per_tick_.load(std::memory_order_relaxed);
+
+    // Where the current parameters put this instant, and how far off that is
+    const uint64_t estimate = base_ns + Scale(now.tsc - base_tsc, old_ns_per_tick);
+    const int64_t error = static_cast<int64_t>(now.ns - estimate);
+
+    // The rate over everything since calibration, plus whatever slope
+    // removes the error by the next resync. Readings so far reach up to
+    // estimate, so the new base never goes below it: a clock that is behind
+    // jumps forward, one that is ahead only slows down.
+    double ns_per_tick = static_cast<double>(now.ns - reference_ns_) / static_cast<double>(now.tsc - reference_tsc_);
+    uint64_t new_base_ns = estimate;
+    if (error > kMaxSteerNs) {
+        new_base_ns = now.ns;
+    } else {
+        const int64_t steer = std::max(error, -kMaxSteerNs);
+        // Never slow down by more than half, however short the interval
+        ns_per_tick = std::max(ns_per_tick + static_cast<double>(steer) / static_cast<double>(resync_ticks_),
+                               ns_per_tick / 2);
+    }
+
+    base_tsc_.store(now.tsc, std::memory_order_relaxed);
+    base_ns_.store(new_base_ns, std::memory_order_relaxed);
+    ns_per_tick_.store(ToFixedPoint(ns_per_tick, kShift), std::memory_order_relaxed);
+    unix_offset_.store(ReadRealtime() - ReadMonotonicRaw(), std::memory_order_relaxed);
+    resyncs_.store(resyncs_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    sequence_.store(sequence + 2, std::memory_order_release);
+    return true;
+}
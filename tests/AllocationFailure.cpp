@@ -0,0 +1,85 @@
+#include "AllocationFailure.h"
+#include <cstdlib>
+#include <new>
+
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+namespace {
+
+// Allocations still allowed on this thread; negative means no limit
+thread_local std::ptrdiff_t allocations_left = -1;
+thread_local size_t failed_allocations = 0;
+
+void* Allocate(std::size_t size) {
+    if (allocations_left == 0) {
+        ++failed_allocations;
+        throw std::bad_alloc();
+    }
+    if (allocations_left > 0) {
+        --allocations_left;
+    }
+    if (void* memory = std::malloc(size != 0 ? size : 1)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void* AllocateAligned(std::size_t size, std::align_val_t alignment) {
+    if (allocations_left == 0) {
+        ++failed_allocations;
+        throw std::bad_alloc();
+    }
+    if (allocations_left > 0) {
+        --allocations_left;
+    }
+    const std::size_t align = static_cast<std::size_t>(alignment);
+#ifdef _WIN32
+    void* memory = _aligned_malloc(size != 0 ? size : 1, align);
+#else
+    // aligned_alloc wants a size that is a multiple of the alignment
+    void* memory = std::aligned_alloc(align, ((size != 0 ? size : 1) + align - 1) / align * align);
+#endif
+    if (memory == nullptr) {
+        throw std::bad_alloc();
+    }
+    return memory;
+}
+
+void FreeAligned(void* memory) {
+#ifdef _WIN32
+    _aligned_free(memory);
+#else
+    std::free(memory);
+#endif
+}
+
+}  // namespace
+
+ScopedAllocationFailure::ScopedAllocationFailure(std::ptrdiff_t allowed) : previous_(allocations_left) {
+    allocations_left = allowed;
+    failed_allocations = 0;
+}
+
+ScopedAllocationFailure::~ScopedAllocationFailure() {
+    allocations_left = previous_;
+}
+
+size_t ScopedAllocationFailure::Failures() const {
+    return failed_allocations;
+}
+
+void* operator new(std::size_t size) { return Allocate(size); }
+void* operator new[](std::size_t size) { return Allocate(size); }
+void* operator new(std::size_t size, std::align_val_t alignment) { return AllocateAligned(size, alignment); }
+void* operator new[](std::size_t size, std::align_val_t alignment) { return AllocateAligned(size, alignment); }
+
+void operator delete(void* memory) noexcept { std::free(memory); }
+void operator delete[](void* memory) noexcept { std::free(memory); }
+void operator delete(void* memory, std::size_t) noexcept { std::free(memory); }
+void operator delete[](void* memory, std::size_t) noexcept { std::free(memory); }
+void operator delete(void* memory, std::align_val_t) noexcept { FreeAligned(memory); }
+void operator delete[](void* memory, std::align_val_t) noexcept { FreeAligned(memory); }
+void operator delete(void* memory, std::size_t, std::align_val_t) noexcept { FreeAligned(memory); }
+void operator delete[](void* memory, std::size_t, std::align_val_t) noexcept { FreeAligned(memory); }
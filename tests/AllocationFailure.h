@@ -0,0 +1,25 @@
+#pragma once
+#include <cstddef>
+
+/**
+ * @brief Makes operator new throw std::bad_alloc on the current thread
+ *
+ * While an instance is alive, the first `allowed` allocations made by this
+ * thread succeed and every one after that throws. The test binary replaces
+ * the global allocation functions to do this (AllocationFailure.cpp), so it
+ * reaches allocations made inside the library as well.
+ */
+class ScopedAllocationFailure {
+public:
+    explicit ScopedAllocationFailure(std::ptrdiff_t allowed = 0);
+    ~ScopedAllocationFailure();
+
+    ScopedAllocationFailure(const ScopedAllocationFailure&) = delete;
+    ScopedAllocationFailure& operator=(const ScopedAllocationFailure&) = delete;
+
+    // Allocations that have thrown since construction
+    size_t Failures() const;
+
+private:
+    std::ptrdiff_t previous_;
+};
@@ -0,0 +1,74 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "IClient.h"
+#include "OrderBook.h"
+#include "Trade.h"
+
+/**
+ * @brief Test client that records every callback it receives
+ *
+ * Each callback appends a short event string ("trade 7", "ack 3", "tob
+ * 10000/10010", ...) to `events` so tests can assert on ordering, and trades
+ * are also kept whole in `trades`. If a book is attached, the book's total
+ * volumes are sampled on every trade.
+ */
+class RecordingClient : public IClient {
+public:
+    explicit RecordingClient(uint64_t client_id = 1, const OrderBook* book = nullptr)
+        : client_id_(client_id), book_(book) {}
+
+    uint64_t SubmitOrder(uint64_t, bool, uint64_t, uint64_t, uint64_t, uint64_t) override { return 0; }
+    uint64_t SubmitOrder(uint64_t, bool, uint64_t, uint64_t) override { return 0; }
+    bool CancelOrder(uint64_t) override { return false; }
+    bool ModifyOrder(uint64_t, uint64_t, uint64_t) override { return false; }
+
+    uint64_t GetBestBid() const override { return 0; }
+    uint64_t GetBestAsk() const override { return 0; }
+    uint64_t GetTotalBidVolume() const override { return 0; }
+    uint64_t GetTotalAskVolume() const override { return 0; }
+    uint64_t GetMidPrice() const override { return 0; }
+    uint64_t GetSpread() const override { return 0; }
+
+    void OnTradeExecuted(const Trade& trade) override {
+        trades.push_back(trade);
+        events.push_back("trade " + std::to_string(trade.resting_order_id));
+        if (book_) {
+            volumes_at_trade.push_back({book_->GetTotalBidVolume(), book_->GetTotalAskVolume()});
+        }
+    }
+    void OnOrderAcknowledged(uint64_t order_id) override {
+        events.push_back("ack " + std::to_string(order_id));
+    }
+    void OnOrderCancelled(uint64_t order_id) override {
+        events.push_back("cancel " + std::to_string(order_id));
+    }
+    void OnOrderModified(uint64_t order_id, uint64_t, uint64_t) override {
+        events.push_back("modify " + std::to_string(order_id));
+    }
+    void OnOrderRejected(uint64_t order_id, const std::string& reason) override {
+        events.push_back("reject " + std::to_string(order_id));
+        last_reject_reason = reason;
+    }
+    void OnTopOfBookUpdate(uint64_t best_bid, uint64_t best_ask, uint64_t, uint64_t) override {
+        events.push_back("tob " + std::to_string(best_bid) + "/" + std::to_string(best_ask));
+    }
+
+    void Initialize() override {}
+    void Shutdown() override {}
+    uint64_t GetClientId() const override { return client_id_; }
+    std::string GetClientName() const override { return "RecordingClient"; }
+
+    std::vector<std::string> events;
+    std::string last_reject_reason;
+    std::vector<Trade> trades;
+    // {total bid volume, total ask volume} seen from inside each trade callback
+    std::vector<std::pair<uint64_t, uint64_t>> volumes_at_trade;
+
+private:
+    uint64_t client_id_;
+    const OrderBook* book_;
+};
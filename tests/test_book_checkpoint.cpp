@@ -0,0 +1,356 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "BookCheckpoint.h"
+#include "OrderBook.h"
+
+namespace {
+
+// Keeps every trade and level update so restored books can be compared
+struct TradeLog : BookListener {
+    bool WantsLevelUpdates() const { return true; }
+    void OnTrade(const Trade& trade) { trades.push_back(trade); }
+    void OnLevelUpdate(const LevelUpdate& update) { level_updates.push_back(update); }
+    void OnTopOfBook(uint64_t bid, uint64_t ask, uint64_t, uint64_t) {
+        ++top_of_book_updates;
+        last_bid = bid;
+        last_ask = ask;
+    }
+
+    std::vector<Trade> trades;
+    std::vector<LevelUpdate> level_updates;
+    uint64_t top_of_book_updates = 0;
+    uint64_t last_bid = 0;
+    uint64_t last_ask = 0;
+};
+
+using LoggedBook = BasicOrderBook<TradeLog>;
+
+OrderBookConfig LadderConfig(PriceLadderType type) {
+    OrderBookConfig config;
+    config.price_ladder.type = type;
+    return config;
+}
+
+// Random adds, cancels and modifies around a mid of 10000 (modifies may cross)
+std::vector<BookCommand> RandomCommands(size_t count, uint32_t seed) {
+    std::mt19937_64 rng(seed);
+    std::uniform_int_distribution<uint64_t> offset(1, 200);
+    std::uniform_int_distribution<uint64_t> quantity(1, 50);
+    std::uniform_int_distribution<int> action(0, 9);
+    std::vector<BookCommand> commands;
+    uint64_t next_id = 1;
+    for (size_t i = 0; i < count; ++i) {
+        int roll = action(rng);
+        if (roll < 6 || next_id == 1) {
+            bool is_buy = (rng() & 1) != 0;
+            uint64_t price = is_buy ? 10000 - offset(rng) : 10000 + offset(rng);
+            commands.push_back(BookCommand::Add(next_id, 1, is_buy, quantity(rng), price, i, i));
+            ++next_id;
+        } else if (roll < 8) {
+            commands.push_back(BookCommand::Cancel(1 + rng() % (next_id - 1)));
+        } else {
+            uint64_t id = 1 + rng() % (next_id - 1);
+            commands.push_back(BookCommand::Modify(id, quantity(rng), 10000 - offset(rng)));
+        }
+    }
+    return commands;
+}
+
+template <typename BookA, typename BookB>
+void ExpectSameDepth(const BookA& a, const BookB& b) {
+    for (BookSide side : {BookSide::Bid, BookSide::Ask}) {
+        std::vector<DepthLevel> depth_a(1000), depth_b(1000);
+        size_t levels_a = a.GetDepth(side, depth_a.size(), depth_a.data());
+        size_t levels_b = b.GetDepth(side, depth_b.size(), depth_b.data());
+        ASSERT_EQ(levels_a, levels_b);
+        for (size_t i = 0; i < levels_a; ++i) {
+            EXPECT_EQ(depth_a[i].price, depth_b[i].price);
+            EXPECT_EQ(depth_a[i].quantity, depth_b[i].quantity);
+            EXPECT_EQ(depth_a[i].order_count, depth_b[i].order_count);
+        }
+    }
+    EXPECT_EQ(a.GetTotalBidVolume(), b.GetTotalBidVolume());
+    EXPECT_EQ(a.GetTotalAskVolume(), b.GetTotalAskVolume());
+}
+
+// Sweep both sides of a book and return the resting orders hit, in order
+std::vector<Trade> Sweep(LoggedBook& book) {
+    book.GetListener().trades.clear();
+    book.AddOrder(1000000, 9, true, UINT32_MAX, 20000, 0, 0);
+    book.CancelOrder(1000000);
+    book.AddOrder(1000001, 9, false, UINT32_MAX, 1, 0, 0);
+    return book.GetListener().trades;
+}
+
+std::string SaveToString(const LoggedBook& book, const CheckpointInfo& info = CheckpointInfo()) {
+    std::ostringstream out(std::ios::binary);
+    book.SaveCheckpoint(out, info);
+    return out.str();
+}
+
+}  // namespace
+
+// Test that a restored book has the same levels, volumes and queue order
+TEST(BookCheckpointTest, RoundTripPreservesLevelsAndQueuePriority) {
+    for (PriceLadderType type : {PriceLadderType::Map, PriceLadderType::Flat}) {
+        LoggedBook original(LadderConfig(type));
+        original.ApplyBatch(RandomCommands(20000, 7));
+        ASSERT_GT(original.GetOrderPool().InUse(), 1000u);
+
+        std::string checkpoint = SaveToString(original, CheckpointInfo{123456, 987654321});
+        std::istringstream in(checkpoint, std::ios::binary);
+        LoggedBook restored(LadderConfig(type));
+        CheckpointInfo info = restored.LoadCheckpoint(in);
+
+        EXPECT_EQ(info.sequence, 123456u);
+        EXPECT_EQ(info.timestamp, 987654321u);
+        EXPECT_EQ(restored.GetOrderPool().InUse(), original.GetOrderPool().InUse());
+        ExpectSameDepth(original, restored);
+
+        // Sweeping both books must hit the same orders in the same order
+        std::vector<Trade> expected = Sweep(original);
+        std::vector<Trade> actual = Sweep(restored);
+        ASSERT_EQ(actual.size(), expected.size());
+        for (size_t i = 0; i < expected.size(); ++i) {
+            EXPECT_EQ(actual[i].resting_order_id, expected[i].resting_order_id);
+            EXPECT_EQ(actual[i].resting_user_id, expected[i].resting_user_id);
+            EXPECT_EQ(actual[i].quantity, expected[i].quantity);
+            EXPECT_EQ(actual[i].price, expected[i].price);
+        }
+    }
+}
+
+// Test that a restored book plus the tail of the feed matches a full replay
+TEST(BookCheckpointTest, RestoredBookContinuesFromFeedTail) {
+    std::vector<BookCommand> feed = RandomCommands(30000, 11);
+    const size_t split = 20000;
+
+    OrderBookConfig config;
+    config.book_id = 5;
+    LoggedBook full(config);
+    full.ApplyBatch(feed.data(), split);
+    std::string checkpoint = SaveToString(full, CheckpointInfo{split, 0});
+    const size_t trades_before = full.GetListener().trades.size();
+    full.ApplyBatch(feed.data() + split, feed.size() - split);
+
+    LoggedBook resumed(config);
+    std::istringstream in(checkpoint, std::ios::binary);
+    CheckpointInfo info = resumed.LoadCheckpoint(in);
+    ASSERT_EQ(info.sequence, split);
+    resumed.ApplyBatch(feed.data() + info.sequence, feed.size() - info.sequence);
+
+    ExpectSameDepth(full, resumed);
+    EXPECT_EQ(resumed.GetOrderPool().InUse(), full.GetOrderPool().InUse());
+
+    // Trade IDs pick up where the checkpointed book left off
+    const std::vector<Trade>& tail = resumed.GetListener().trades;
+    ASSERT_GT(trades_before, 0u);
+    ASSERT_EQ(tail.size(), full.GetListener().trades.size() - trades_before);
+    for (size_t i = 0; i < tail.size(); ++i) {
+        EXPECT_EQ(tail[i].execution_id, full.GetListener().trades[trades_before + i].execution_id);
+    }
+}
+
+// Test that a namespaced book refuses to trade past its last execution ID
+TEST(BookCheckpointTest, ExecutionIdRangeIsNotOverrun) {
+    auto checkpoint = [](uint64_t execution_sequence) {
+        std::ostringstream out(std::ios::binary);
+        CheckpointWriter writer(out);
+        CheckpointHeader header;
+        header.bid_levels = 1;
+        header.orders = 1;
+        header.execution_sequence = execution_sequence;
+        writer.WriteHeader(header);
+        writer.WriteLevel(CheckpointLevel{100, 1});
+        writer.WriteOrder(CheckpointOrder{1, 1, 10, 0, 0});
+        writer.Finish();
+        return out.str();
+    };
+    OrderBookConfig config;
+    config.book_id = 7;
+
+    LoggedBook book(config);
+    std::istringstream in(checkpoint(UINT32_MAX - 1), std::ios::binary);
+    book.LoadCheckpoint(in);
+
+    // One ID left: enough for a match against the single resting order
+    EXPECT_TRUE(book.TryAddOrder(2, 2, false, 4, 100, 0, 0).Ok());
+    ASSERT_EQ(book.GetListener().trades.size(), 1u);
+    EXPECT_EQ(book.GetListener().trades[0].execution_id, (uint64_t{7} << 32) | UINT32_MAX);
+
+    // None left: crossing adds and modifies are refused, passive ones are not
+    EXPECT_EQ(book.TryAddOrder(3, 2, false, 4, 100, 0, 0).status, OrderStatus::ExecutionIdsExhausted);
+    EXPECT_TRUE(book.TryAddOrder(4, 2, false, 4, 101, 0, 0).Ok());
+    EXPECT_EQ(book.TryModifyOrder(4, 4, 100).status, OrderStatus::ExecutionIdsExhausted);
+    EXPECT_TRUE(book.TryModifyOrder(4, 2, 101).Ok());
+    EXPECT_EQ(book.GetListener().trades.size(), 1u);
+    EXPECT_EQ(book.GetTotalBidVolume(), 6u);
+
+    // A saved sequence beyond the range cannot be loaded into a namespaced book
+    LoggedBook overflowing(config);
+    std::istringstream beyond(checkpoint(uint64_t{UINT32_MAX} + 1), std::ios::binary);
+    EXPECT_THROW(overflowing.LoadCheckpoint(beyond), std::runtime_error);
+    EXPECT_EQ(overflowing.GetOrderPool().InUse(), 0u);
+}
+
+// Test that loading reports the restored book once, without per-order callbacks
+TEST(BookCheckpointTest, LoadPublishesLevelsAndTopOfBook) {
+    LoggedBook original;
+    original.AddOrder(1, 1, true, 10, 99, 0, 0);
+    original.AddOrder(2, 1, true, 5, 99, 0, 0);
+    original.AddOrder(3, 1, true, 7, 98, 0, 0);
+    original.AddOrder(4, 1, false, 3, 101, 0, 0);
+
+    LoggedBook restored;
+    std::istringstream in(SaveToString(original), std::ios::binary);
+    restored.LoadCheckpoint(in);
+
+    const TradeLog& log = restored.GetListener();
+    EXPECT_TRUE(log.trades.empty());
+    EXPECT_EQ(log.top_of_book_updates, 1u);
+    EXPECT_EQ(log.last_bid, 99u);
+    EXPECT_EQ(log.last_ask, 101u);
+    ASSERT_EQ(log.level_updates.size(), 3u);
+    EXPECT_EQ(log.level_updates[0].price, 99u);
+    EXPECT_EQ(log.level_updates[0].quantity, 15u);
+    EXPECT_EQ(log.level_updates[0].order_count, 2u);
+    EXPECT_EQ(log.level_updates[1].price, 98u);
+    EXPECT_EQ(log.level_updates[2].side, BookSide::Ask);
+    for (const LevelUpdate& update : log.level_updates) {
+        EXPECT_EQ(update.action, LevelAction::Add);
+    }
+}
+
+// Test that OrderBook checkpoints round-trip through a file
+TEST(BookCheckpointTest, FileRoundTrip) {
+    const std::string path = ::testing::TempDir() + "book_checkpoint_test.bin";
+    OrderBook original;
+    original.AddOrder(1, 1, true, 10, 100, 5, 5);
+    original.AddOrder(2, 2, false, 20, 110, 6, 6);
+    original.SaveCheckpoint(path, CheckpointInfo{42, 7});
+
+    OrderBook restored;
+    CheckpointInfo info = restored.LoadCheckpoint(path);
+    EXPECT_EQ(info.sequence, 42u);
+    EXPECT_EQ(info.timestamp, 7u);
+    EXPECT_EQ(restored.GetBestBid(), 100u);
+    EXPECT_EQ(restored.GetBestAsk(), 110u);
+    EXPECT_EQ(restored.GetBestBidVolume(), 10u);
+    EXPECT_EQ(restored.GetBestAskVolume(), 20u);
+
+    // The restored orders are live: they can be cancelled by ID
+    restored.CancelOrder(1);
+    EXPECT_EQ(restored.GetBestBid(), 0u);
+    std::remove(path.c_str());
+
+    OrderBook missing;
+    EXPECT_THROW(missing.LoadCheckpoint(path), std::runtime_error);
+}
+
+// Test that damaged or unsuitable checkpoints are rejected and leave the book empty
+TEST(BookCheckpointTest, RejectsBadCheckpoints) {
+    LoggedBook original;
+    original.ApplyBatch(RandomCommands(2000, 3));
+    const std::string good = SaveToString(original);
+
+    auto load = [](LoggedBook& book, const std::string& bytes) {
+        std::istringstream in(bytes, std::ios::binary);
+        book.LoadCheckpoint(in);
+    };
+
+    {
+        std::string corrupted = good;
+        corrupted[sizeof(CheckpointHeader) + 20] ^= 0x01;
+        LoggedBook book;
+        EXPECT_THROW(load(book, corrupted), std::runtime_error);
+        EXPECT_EQ(book.GetOrderPool().InUse(), 0u);
+    }
+    {
+        LoggedBook book;
+        EXPECT_THROW(load(book, good.substr(0, good.size() - 40)), std::runtime_error);
+        EXPECT_THROW(load(book, good.substr(0, 10)), std::runtime_error);
+        EXPECT_THROW(load(book, std::string(good.size(), 'x')), std::runtime_error);
+    }
+    {
+        // Level counts that do not add up to the header's orders: the file
+        // size and checksum are right, but an order would be left unread
+        std::ostringstream out(std::ios::binary);
+        CheckpointWriter writer(out);
+        CheckpointHeader header;
+        header.bid_levels = 1;
+        header.orders = 2;
+        writer.WriteHeader(header);
+        writer.WriteLevel(CheckpointLevel{100, 1});
+        writer.WriteOrder(CheckpointOrder{1, 1, 10, 0, 0});
+        writer.WriteOrder(CheckpointOrder{2, 1, 10, 0, 0});
+        writer.Finish();
+        LoggedBook book;
+        EXPECT_THROW(load(book, out.str()), std::runtime_error);
+        EXPECT_EQ(book.GetOrderPool().InUse(), 0u);
+        EXPECT_EQ(book.GetBestBid(), 0u);
+    }
+    {
+        // A book that already has orders cannot be loaded into
+        LoggedBook book;
+        book.AddOrder(1, 1, true, 10, 100, 0, 0);
+        EXPECT_THROW(load(book, good), std::runtime_error);
+        EXPECT_EQ(book.GetOrderPool().InUse(), 1u);
+    }
+    {
+        // Prices the ladder cannot hold are refused and the partial load undone
+        LoggedBook mixed;
+        mixed.AddOrder(1, 1, true, 10, 100, 0, 0);
+        mixed.AddOrder(2, 1, true, 10, 95, 0, 0);
+        mixed.AddOrder(3, 1, true, 10, 93, 0, 0);
+        OrderBookConfig config = LadderConfig(PriceLadderType::Flat);
+        config.price_ladder.tick_size = 5;
+        LoggedBook book(config);
+        EXPECT_THROW(load(book, SaveToString(mixed)), std::runtime_error);
+        EXPECT_EQ(book.GetOrderPool().InUse(), 0u);
+        EXPECT_EQ(book.GetBestBid(), 0u);
+        EXPECT_EQ(book.GetTotalBidVolume(), 0u);
+
+        // The book is still usable afterwards
+        book.AddOrder(4, 1, true, 10, 100, 0, 0);
+        EXPECT_EQ(book.GetBestBid(), 100u);
+    }
+}
+
+// Performance test: checkpoint and restore a book with 1M resting orders
+TEST(BookCheckpointTest, CheckpointPerformance) {
+    const size_t num_orders = 1000000;
+    LoggedBook original;
+    std::mt19937_64 rng(5);
+    for (uint64_t id = 1; id <= num_orders; ++id) {
+        bool is_buy = (id & 1) != 0;
+        uint64_t price = is_buy ? 10000 - (rng() % 500) : 10001 + (rng() % 500);
+        original.AddOrder(id, id % 100, is_buy, 1 + rng() % 100, price, id, id);
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+    std::string checkpoint = SaveToString(original, CheckpointInfo{num_orders, 0});
+    auto saved = std::chrono::high_resolution_clock::now();
+
+    LoggedBook restored;
+    std::istringstream in(std::move(checkpoint), std::ios::binary);
+    restored.LoadCheckpoint(in);
+    auto end = std::chrono::high_resolution_clock::now();
+
+    auto save_ms = std::chrono::duration_cast<std::chrono::milliseconds>(saved - start).count();
+    auto load_ms = std::chrono::duration_cast<std::chrono::milliseconds>(end - saved).count();
+    std::cout << "Checkpointed " << num_orders << " orders in " << save_ms << " ms, restored in " << load_ms
+              << " ms" << std::endl;
+
+    ExpectSameDepth(original, restored);
+    EXPECT_LT(save_ms, 2000);
+    EXPECT_LT(load_ms, 2000);
+}
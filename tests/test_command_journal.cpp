@@ -0,0 +1,352 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "CommandJournal.h"
+#include "OrderBook.h"
+
+namespace {
+
+// Fresh, empty directory under the test temp dir, removed again on destruction
+class TempJournalDir {
+public:
+    explicit TempJournalDir(const std::string& name) : path_(::testing::TempDir() + "journal_test_" + name) {
+        std::filesystem::remove_all(path_);
+    }
+    ~TempJournalDir() { std::filesystem::remove_all(path_); }
+    const std::string& Path() const { return path_; }
+
+    std::vector<std::filesystem::path> Segments() const {
+        std::vector<std::filesystem::path> segments;
+        for (const auto& entry : std::filesystem::directory_iterator(path_)) {
+            segments.push_back(entry.path());
+        }
+        std::sort(segments.begin(), segments.end());
+        return segments;
+    }
+
+private:
+    std::string path_;
+};
+
+JournalConfig SmallSegments(const std::string& directory, size_t records_per_segment = 100) {
+    JournalConfig config;
+    config.directory = directory;
+    config.records_per_segment = records_per_segment;
+    return config;
+}
+
+// Random adds, cancels and modifies around a mid of 10000, including some
+// that the book rejects (unknown IDs)
+std::vector<BookCommand> RandomCommands(size_t count, uint32_t seed) {
+    std::mt19937_64 rng(seed);
+    std::vector<BookCommand> commands;
+    uint64_t next_id = 1;
+    for (size_t i = 0; i < count; ++i) {
+        int roll = static_cast<int>(rng() % 10);
+        if (roll < 6 || next_id == 1) {
+            bool is_buy = (rng() & 1) != 0;
+            uint64_t price = is_buy ? 10000 - 1 - rng() % 100 : 10000 + 1 + rng() % 100;
+            commands.push_back(BookCommand::Add(next_id, 1, is_buy, 1 + rng() % 50, price, i, i));
+            ++next_id;
+        } else if (roll < 8) {
+            commands.push_back(BookCommand::Cancel(1 + rng() % next_id));
+        } else {
+            commands.push_back(BookCommand::Modify(1 + rng() % next_id, 1 + rng() % 50, 9950 + rng() % 100));
+        }
+    }
+    return commands;
+}
+
+void ExpectSameBook(const OrderBook& a, const OrderBook& b) {
+    for (BookSide side : {BookSide::Bid, BookSide::Ask}) {
+        std::vector<DepthLevel> depth_a(500), depth_b(500);
+        size_t levels_a = a.GetDepth(side, depth_a.size(), depth_a.data());
+        size_t levels_b = b.GetDepth(side, depth_b.size(), depth_b.data());
+        ASSERT_EQ(levels_a, levels_b);
+        for (size_t i = 0; i < levels_a; ++i) {
+            EXPECT_EQ(depth_a[i].price, depth_b[i].price);
+            EXPECT_EQ(depth_a[i].quantity, depth_b[i].quantity);
+            EXPECT_EQ(depth_a[i].order_count, depth_b[i].order_count);
+        }
+    }
+    EXPECT_EQ(a.GetOrderPool().InUse(), b.GetOrderPool().InUse());
+}
+
+}  // namespace
+
+// Test that only accepted commands are journaled, in order
+TEST(CommandJournalTest, JournalsAcceptedCommandsOnly) {
+    TempJournalDir dir("accepted");
+    CommandJournal journal(SmallSegments(dir.Path()));
+    OrderBook book;
+    book.SetJournal(&journal);
+
+    book.AddOrder(1, 7, true, 10, 100, 11, 12);
+    EXPECT_THROW(book.AddOrder(1, 7, true, 10, 100, 11, 12), std::runtime_error);  // duplicate
+    EXPECT_THROW(book.CancelOrder(99), std::runtime_error);                       // unknown
+    book.ModifyOrder(1, 5, 100);
+    book.AddOrder(2, 8, false, 3, 100, 13, 14);  // fills against order 1
+    book.CancelOrder(1);
+    EXPECT_EQ(journal.LastSequence(), 4u);
+
+    std::vector<BookCommand> replayed;
+    uint64_t last = CommandJournal::Replay(dir.Path(), 0, [&](const BookCommand* commands, size_t count) {
+        replayed.insert(replayed.end(), commands, commands + count);
+    });
+    EXPECT_EQ(last, 4u);
+    ASSERT_EQ(replayed.size(), 4u);
+    EXPECT_EQ(replayed[0].type, BookCommandType::Add);
+    EXPECT_EQ(replayed[0].order_id, 1u);
+    EXPECT_EQ(replayed[0].user_id, 7u);
+    EXPECT_TRUE(replayed[0].is_buy);
+    EXPECT_EQ(replayed[0].ts_received, 11u);
+    EXPECT_EQ(replayed[0].ts_executed, 12u);
+    EXPECT_EQ(replayed[1].type, BookCommandType::Modify);
+    EXPECT_EQ(replayed[1].quantity, 5u);
+    EXPECT_EQ(replayed[2].type, BookCommandType::Add);
+    EXPECT_FALSE(replayed[2].is_buy);
+    EXPECT_EQ(replayed[3].type, BookCommandType::Cancel);
+    EXPECT_EQ(replayed[3].order_id, 1u);
+}
+
+// Test that a book rebuilt from a multi-segment journal matches the original
+TEST(CommandJournalTest, RecoversBookAcrossSegments) {
+    TempJournalDir dir("recover");
+    OrderBook original;
+    {
+        CommandJournal journal(SmallSegments(dir.Path()));
+        original.SetJournal(&journal);
+        original.ApplyBatch(RandomCommands(5000, 3));
+        original.SetJournal(nullptr);
+    }
+    EXPECT_GT(dir.Segments().size(), 10u);
+
+    OrderBook recovered;
+    uint64_t last = RecoverFromJournal(recovered, dir.Path());
+    EXPECT_GT(last, 3000u);
+    ExpectSameBook(original, recovered);
+}
+
+// Test that reopening a journal continues its sequence and recovery replays both runs
+TEST(CommandJournalTest, ReopenContinuesSequence) {
+    TempJournalDir dir("reopen");
+    std::vector<BookCommand> commands = RandomCommands(600, 5);
+    OrderBook original;
+    uint64_t first_run_last = 0;
+    {
+        CommandJournal journal(SmallSegments(dir.Path()));
+        original.SetJournal(&journal);
+        original.ApplyBatch(commands.data(), 300);
+        first_run_last = journal.LastSequence();
+    }
+    {
+        CommandJournal journal(SmallSegments(dir.Path()));
+        EXPECT_EQ(journal.LastSequence(), first_run_last);
+        original.SetJournal(&journal);
+        original.ApplyBatch(commands.data() + 300, commands.size() - 300);
+        EXPECT_GT(journal.LastSequence(), first_run_last);
+        original.SetJournal(nullptr);
+    }
+
+    OrderBook recovered;
+    RecoverFromJournal(recovered, dir.Path());
+    ExpectSameBook(original, recovered);
+}
+
+// Test that a checkpoint plus the journal's tail rebuilds the book
+TEST(CommandJournalTest, CheckpointPlusJournalTail) {
+    TempJournalDir dir("checkpoint");
+    std::vector<BookCommand> commands = RandomCommands(4000, 9);
+    CommandJournal journal(SmallSegments(dir.Path(), 1000));
+    OrderBook original;
+    original.SetJournal(&journal);
+
+    original.ApplyBatch(commands.data(), 2500);
+    std::ostringstream checkpoint(std::ios::binary);
+    original.SaveCheckpoint(checkpoint, CheckpointInfo{journal.LastSequence(), 0});
+    original.ApplyBatch(commands.data() + 2500, commands.size() - 2500);
+
+    OrderBook recovered;
+    TempJournalDir unused_dir("checkpoint_unused");
+    CommandJournal recovered_journal(SmallSegments(unused_dir.Path()));
+    recovered.SetJournal(&recovered_journal);
+    std::istringstream in(checkpoint.str(), std::ios::binary);
+    CheckpointInfo info = recovered.LoadCheckpoint(in);
+    EXPECT_EQ(RecoverFromJournal(recovered, dir.Path(), info.sequence), journal.LastSequence());
+    ExpectSameBook(original, recovered);
+
+    // Recovery detached the book's journal while replaying, then put it back
+    EXPECT_EQ(recovered.GetJournal(), &recovered_journal);
+    EXPECT_EQ(recovered_journal.LastSequence(), 0u);
+}
+
+// Test that a modify's timestamp is journaled, so recovery does not restamp it
+TEST(CommandJournalTest, RecoveryKeepsModifyTimestamps) {
+    TempJournalDir dir("modify_time");
+    auto clock = std::make_shared<ReplayClock>(1000);
+    OrderBookConfig config;
+    config.clock = clock;
+    OrderBook original(config);
+    {
+        CommandJournal journal(SmallSegments(dir.Path()));
+        original.SetJournal(&journal);
+        original.AddOrder(1, 1, true, 10, 100, 5, 5);
+        original.AddOrder(2, 1, true, 10, 100, 6, 6);
+        clock->Advance(2000);
+        original.ModifyOrder(1, 20, 100);  // Loses priority: stamped 2000
+        clock->Advance(3000);
+        original.ModifyOrder(2, 5, 99);    // Moves: stamped 3000
+        original.ModifyOrder(1, 15, 100);  // Keeps priority and its stamp
+        original.SetJournal(nullptr);
+    }
+
+    std::vector<BookCommand> replayed;
+    CommandJournal::Replay(dir.Path(), 0, [&](const BookCommand* commands, size_t count) {
+        replayed.insert(replayed.end(), commands, commands + count);
+    });
+    ASSERT_EQ(replayed.size(), 5u);
+    EXPECT_EQ(replayed[2].ts_executed, 2000u);
+    EXPECT_EQ(replayed[3].ts_executed, 3000u);
+    EXPECT_EQ(replayed[4].ts_executed, 0u);
+
+    // Recovered on the wall clock, the book still carries the original stamps
+    OrderBook recovered;
+    RecoverFromJournal(recovered, dir.Path());
+    std::ostringstream expected(std::ios::binary), actual(std::ios::binary);
+    original.SaveCheckpoint(expected);
+    recovered.SaveCheckpoint(actual);
+    EXPECT_EQ(actual.str(), expected.str());
+}
+
+// Test that a journal that cannot make its next segment rejects commands
+// instead of throwing, and leaves the book untouched
+TEST(CommandJournalTest, FailedAppendRejectsCommand) {
+    TempJournalDir dir("failed");
+    CommandJournal journal(SmallSegments(dir.Path(), 2));
+    OrderBook book;
+    book.SetJournal(&journal);
+    // Once the spare segment exists, take the directory away: the spare
+    // (already mapped) takes records 3 and 4, then no segment can be made
+    while (dir.Segments().size() < 2) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    std::filesystem::remove_all(dir.Path());
+
+    OrderResult result;
+    uint64_t id = 0;
+    while (result.Ok() && id < 100) {
+        result = book.TryAddOrder(++id, 1, true, 10, 100, 0, 0);
+    }
+    EXPECT_EQ(result.status, OrderStatus::JournalWriteFailed);
+    EXPECT_EQ(id, 5u);
+    EXPECT_EQ(book.GetOrderPool().InUse(), id - 1);
+    EXPECT_EQ(book.GetTotalBidVolume(), 10 * (id - 1));
+    EXPECT_EQ(journal.LastSequence(), id - 1);
+    EXPECT_FALSE(journal.LastError().empty());
+
+    EXPECT_EQ(book.TryCancelOrder(1).status, OrderStatus::JournalWriteFailed);
+    EXPECT_EQ(book.TryModifyOrder(1, 5, 100).status, OrderStatus::JournalWriteFailed);
+    EXPECT_THROW(book.CancelOrder(1), std::runtime_error);
+    EXPECT_EQ(book.GetTotalBidVolume(), 10 * (id - 1));
+
+    // Appends resume once a segment can be made again
+    std::filesystem::create_directories(dir.Path());
+    for (int attempt = 0; attempt < 1000 && !book.TryCancelOrder(1).Ok(); ++attempt) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    EXPECT_EQ(book.GetTotalBidVolume(), 10 * (id - 2));
+    EXPECT_TRUE(journal.LastError().empty());
+}
+
+// Test that replay stops at a torn record and the journal resumes after it
+TEST(CommandJournalTest, StopsAtTornRecord) {
+    TempJournalDir dir("torn");
+    {
+        CommandJournal journal(SmallSegments(dir.Path(), 1000));
+        for (uint64_t id = 1; id <= 50; ++id) {
+            journal.Append(BookCommand::Add(id, 1, true, 1, 100, 0, 0));
+        }
+    }
+    // Flip a byte inside record 31 (the segment header takes the first slot)
+    {
+        std::fstream segment(dir.Segments().front(), std::ios::in | std::ios::out | std::ios::binary);
+        segment.seekp(static_cast<std::streamoff>(sizeof(JournalRecord) * 31 + 20));
+        segment.put('\x7f');
+    }
+
+    size_t replayed = 0;
+    uint64_t last = CommandJournal::Replay(dir.Path(), 0, [&](const BookCommand*, size_t count) {
+        replayed += count;
+    });
+    EXPECT_EQ(last, 30u);
+    EXPECT_EQ(replayed, 30u);
+
+    // Reopening continues after the last intact record, and replay picks up
+    // the new segment after the torn one
+    {
+        CommandJournal journal(SmallSegments(dir.Path(), 1000));
+        EXPECT_EQ(journal.LastSequence(), 30u);
+        EXPECT_EQ(journal.Append(BookCommand::Cancel(1)), 31u);
+    }
+    replayed = 0;
+    EXPECT_EQ(CommandJournal::Replay(dir.Path(), 0, [&](const BookCommand*, size_t count) { replayed += count; }),
+              31u);
+    EXPECT_EQ(replayed, 31u);
+
+    // Asking for commands older than the journal holds is an error
+    std::filesystem::remove(dir.Segments().front());
+    EXPECT_THROW(CommandJournal::Replay(dir.Path(), 0, [](const BookCommand*, size_t) {}), std::runtime_error);
+    EXPECT_EQ(CommandJournal::Replay(dir.Path(), 30, [](const BookCommand*, size_t) {}), 31u);
+}
+
+// Performance test: journal 1M commands, then recover a book from them
+TEST(CommandJournalTest, JournalPerformance) {
+    TempJournalDir dir("performance");
+    const size_t num_commands = 1000000;
+    std::vector<BookCommand> commands = RandomCommands(num_commands, 13);
+
+    OrderBook plain;
+    auto start = std::chrono::high_resolution_clock::now();
+    for (const BookCommand& command : commands) {
+        plain.Apply(command);
+    }
+    auto plain_end = std::chrono::high_resolution_clock::now();
+
+    JournalConfig config;
+    config.directory = dir.Path();
+    config.records_per_segment = 1 << 18;
+    CommandJournal journal(config);
+    OrderBook journaled;
+    journaled.SetJournal(&journal);
+    auto journaled_start = std::chrono::high_resolution_clock::now();
+    for (const BookCommand& command : commands) {
+        journaled.Apply(command);
+    }
+    auto journaled_end = std::chrono::high_resolution_clock::now();
+    journaled.SetJournal(nullptr);
+
+    OrderBook recovered;
+    auto recover_start = std::chrono::high_resolution_clock::now();
+    RecoverFromJournal(recovered, dir.Path());
+    auto recover_end = std::chrono::high_resolution_clock::now();
+
+    auto ms = [](auto from, auto to) { return std::chrono::duration_cast<std::chrono::milliseconds>(to - from).count(); };
+    std::cout << "Applied " << num_commands << " commands in " << ms(start, plain_end) << " ms without a journal, "
+              << ms(journaled_start, journaled_end) << " ms with one (" << journal.LastSequence()
+              << " journaled); recovered in " << ms(recover_start, recover_end) << " ms" << std::endl;
+
+    ExpectSameBook(journaled, recovered);
+    EXPECT_LT(ms(journaled_start, journaled_end), 5000);
+    EXPECT_LT(ms(recover_start, recover_end), 5000);
+}
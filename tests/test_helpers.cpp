@@ -3,8 +3,11 @@
 #include <thread>
 #include <vector>
 #include <chrono>
+#include <cstdlib>
+#include <iostream>
 
 #include "Helpers.h"
+#include "TscClock.h"
 
 class HelpersTest : public ::testing::Test {
 protected:
@@ -276,3 +279,86 @@ TEST_F(HelpersTest, GetTimeStampPerformance) {
     std::cout << "Generated " << num_calls << " timestamps in " 
               << duration.count() << " microseconds" << std::endl;
 }
+
+// Test that the TSC clock agrees with CLOCK_MONOTONIC_RAW and the wall clock
+TEST_F(HelpersTest, TscClockTracksReferenceClocks) {
+    TscClock& clock = TscClock::Instance();
+    if (clock.UsesTsc()) {
+        EXPECT_GT(clock.TicksPerNanosecond(), 0.01);
+        EXPECT_LT(clock.TicksPerNanosecond(), 100.0);
+    }
+
+    for (int i = 0; i < 5; ++i) {
+        uint64_t reference = TscClock::ReadMonotonicRaw();
+        int64_t difference = static_cast<int64_t>(clock.Now() - reference);
+        EXPECT_LT(std::llabs(difference), 100000) << "More than 100us from CLOCK_MONOTONIC_RAW";
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    // Bracket the reading with two system_clock reads so a preemption between
+    // them widens the window instead of failing the test
+    auto system_ns = []() {
+        return static_cast<int64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count());
+    };
+    int64_t before = system_ns();
+    int64_t unix_ns = static_cast<int64_t>(Helpers::GetTimeStampNs());
+    int64_t after = system_ns();
+    EXPECT_GE(unix_ns, before - 2000000) << "More than 2ms behind system_clock";
+    EXPECT_LE(unix_ns, after + 2000000) << "More than 2ms ahead of system_clock";
+}
+
+// Test that readings never go backwards, across threads and through resyncs
+TEST_F(HelpersTest, TscClockIsMonotonicThroughResyncs) {
+    TscClock clock(std::chrono::milliseconds(2), std::chrono::microseconds(200));
+    const int num_threads = 2;
+    std::vector<std::thread> threads;
+    std::vector<int> backwards(num_threads, 0);
+    for (int t = 0; t < num_threads; ++t) {
+        threads.emplace_back([&clock, &backwards, t]() {
+            uint64_t previous = clock.Now();
+            uint64_t end = TscClock::ReadMonotonicRaw() + 30000000;  // 30ms
+            while (TscClock::ReadMonotonicRaw() < end) {
+                uint64_t now = clock.Now();
+                if (now < previous) {
+                    ++backwards[t];
+                }
+                previous = now;
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    for (int t = 0; t < num_threads; ++t) {
+        EXPECT_EQ(backwards[t], 0);
+    }
+    if (clock.UsesTsc()) {
+        EXPECT_GT(clock.ResyncCount(), 10u);
+    }
+    int64_t difference = static_cast<int64_t>(clock.Now() - TscClock::ReadMonotonicRaw());
+    EXPECT_LT(std::llabs(difference), 100000);
+}
+
+// Performance test: TSC reads against the system clock
+TEST_F(HelpersTest, TscClockPerformance) {
+    const int num_calls = 1000000;
+    TscClock& clock = TscClock::Instance();
+    uint64_t sink = 0;
+
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < num_calls; ++i) {
+        sink += clock.Now();
+    }
+    auto tsc_end = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < num_calls; ++i) {
+        sink += static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+    }
+    auto steady_end = std::chrono::high_resolution_clock::now();
+
+    auto tsc_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(tsc_end - start).count() / num_calls;
+    auto steady_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(steady_end - tsc_end).count() / num_calls;
+    std::cout << "TscClock::Now " << tsc_ns << " ns/call, steady_clock::now " << steady_ns << " ns/call"
+              << (clock.UsesTsc() ? "" : " (no invariant TSC)") << " [" << (sink & 1) << "]" << std::endl;
+    EXPECT_LT(tsc_ns, 1000);
+}
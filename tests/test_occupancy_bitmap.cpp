@@ -0,0 +1,116 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <set>
+
+#include "OccupancyBitmap.h"
+#include "FlatPriceLadder.h"
+#include "Order.h"
+#include "OrderPool.h"
+
+// Test an empty bitmap
+TEST(OccupancyBitmapTest, EmptyBitmap) {
+    OccupancyBitmap bitmap(4096);
+    EXPECT_FALSE(bitmap.Any());
+    EXPECT_EQ(bitmap.FindFirst(), OccupancyBitmap::npos);
+    EXPECT_EQ(bitmap.FindLast(), OccupancyBitmap::npos);
+    EXPECT_EQ(bitmap.FindNext(100), OccupancyBitmap::npos);
+    EXPECT_EQ(bitmap.FindPrev(100), OccupancyBitmap::npos);
+}
+
+// Test set/clear and searches within a single word
+TEST(OccupancyBitmapTest, SingleWord) {
+    OccupancyBitmap bitmap(64);
+    bitmap.Set(3);
+    bitmap.Set(40);
+
+    EXPECT_TRUE(bitmap.Test(3));
+    EXPECT_FALSE(bitmap.Test(4));
+    EXPECT_EQ(bitmap.FindFirst(), 3);
+    EXPECT_EQ(bitmap.FindLast(), 40);
+    EXPECT_EQ(bitmap.FindNext(4), 40);
+    EXPECT_EQ(bitmap.FindPrev(39), 3);
+    EXPECT_EQ(bitmap.FindNext(41), OccupancyBitmap::npos);
+
+    bitmap.Clear(3);
+    EXPECT_EQ(bitmap.FindFirst(), 40);
+}
+
+// Test searches that have to climb and descend the summary tiers
+TEST(OccupancyBitmapTest, SparseAcrossTiers) {
+    OccupancyBitmap bitmap(size_t{1} << 20);
+    bitmap.Set(5);
+    bitmap.Set(700000);
+    bitmap.Set((size_t{1} << 20) - 1);
+
+    EXPECT_EQ(bitmap.FindNext(6), 700000);
+    EXPECT_EQ(bitmap.FindNext(700001), (size_t{1} << 20) - 1);
+    EXPECT_EQ(bitmap.FindPrev(699999), 5);
+    EXPECT_EQ(bitmap.FindPrev(4), OccupancyBitmap::npos);
+
+    // Clearing the last bit in a word clears the summaries above it
+    bitmap.Clear(700000);
+    EXPECT_EQ(bitmap.FindNext(6), (size_t{1} << 20) - 1);
+    EXPECT_EQ(bitmap.FindPrev((size_t{1} << 20) - 2), 5);
+}
+
+// Test the bitmap against a std::set on random operations
+TEST(OccupancyBitmapTest, MatchesReferenceSet) {
+    const size_t size = 300000;  // Three tiers, partial top-level words
+    OccupancyBitmap bitmap(size);
+    std::set<size_t> reference;
+    std::mt19937 gen(7);
+    std::uniform_int_distribution<size_t> index_dist(0, size - 1);
+
+    for (int i = 0; i < 20000; ++i) {
+        size_t index = index_dist(gen);
+        if (gen() % 3 == 0) {
+            bitmap.Clear(index);
+            reference.erase(index);
+        } else {
+            bitmap.Set(index);
+            reference.insert(index);
+        }
+
+        size_t probe = index_dist(gen);
+        auto next = reference.lower_bound(probe);
+        ASSERT_EQ(bitmap.FindNext(probe), next == reference.end() ? OccupancyBitmap::npos : *next);
+        auto prev = reference.upper_bound(probe);
+        ASSERT_EQ(bitmap.FindPrev(probe), prev == reference.begin() ? OccupancyBitmap::npos : *std::prev(prev));
+    }
+}
+
+// Performance test: emptying the best level of a sparse flat ladder
+TEST(OccupancyBitmapTest, SparseLadderBestLevelPerformance) {
+    PriceLadderConfig config;
+    config.type = PriceLadderType::Flat;
+    config.tick_size = 1;
+    config.initial_window_ticks = size_t{1} << 18;
+    config.max_window_ticks = size_t{1} << 18;
+    FlatPriceLadder<BookSide::Ask> asks(config);
+
+    // Two levels ~200k ticks apart; repeatedly empty and refill the best one
+    OrderPool pool;
+    OrderHandle far_order = pool.Acquire(Order{1, 300000, 10, false});
+    asks.GetOrCreate(300000).AddOrder(pool, far_order);
+    OrderHandle near_order = pool.Acquire(Order{2, 100000, 10, false});
+
+    const int iterations = 100000;
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        asks.GetOrCreate(100000).AddOrder(pool, near_order);
+        ASSERT_EQ(asks.Best()->GetPrice(), 100000);
+        asks.Find(100000)->RemoveOrder(pool, near_order);
+        asks.Erase(100000);
+        ASSERT_EQ(asks.Best()->GetPrice(), 300000);
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+
+    // A linear scan would touch ~200k empty ticks per iteration
+    EXPECT_LT(duration.count(), 500000);  // Less than 500ms
+    std::cout << "Emptied the best level of a sparse ladder " << iterations << " times in "
+              << duration.count() << " microseconds" << std::endl;
+}
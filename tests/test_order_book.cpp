@@ -2,11 +2,19 @@
 #include <vector>
 #include <memory>
 #include <chrono>
+#include <algorithm>
+#include <iostream>
+#include <map>
+#include <random>
+#include <cstring>
+#include <array>
 
 #include "OrderBook.h"
 #include "Trade.h"
 #include "Order.h"
 #include "PriceLevel.h"
+#include "AllocationFailure.h"
+#include "RecordingClient.h"
 
 class OrderBookTest : public ::testing::Test {
 protected:
@@ -93,6 +101,48 @@ TEST_F(OrderBookTest, OrderCancellation) {
     // This depends on implementation details
 }
 
+// Test that cancelling the only order at the best price moves the best price
+TEST_F(OrderBookTest, CancelBestLevelUpdatesBestPrice) {
+    book->AddOrder(1001, 1, true, 100, 10000);   // Buy 100 @ 100.00
+    book->AddOrder(1002, 1, true, 150, 10020);   // Buy 150 @ 100.20
+    book->AddOrder(2001, 2, false, 200, 10050);  // Sell 200 @ 100.50
+    
+    book->CancelOrder(1002);
+    EXPECT_EQ(book->GetBestBid(), 10000);
+    
+    book->CancelOrder(2001);
+    EXPECT_EQ(book->GetBestAsk(), 0);  // Empty level is removed
+}
+
+// Test best-level volumes and side totals across fills, cancels and modifies
+TEST_F(OrderBookTest, CachedVolumesTrackEveryMutation) {
+    book->AddOrder(1001, 1, true, 100, 10000);   // Buy 100 @ 100.00
+    book->AddOrder(1002, 1, true, 50, 10000);    // Buy 50 @ 100.00
+    book->AddOrder(1003, 1, true, 70, 9990);     // Buy 70 @ 99.90
+    book->AddOrder(2001, 2, false, 40, 10010);   // Sell 40 @ 100.10
+    
+    EXPECT_EQ(book->GetBestBidVolume(), 150);
+    EXPECT_EQ(book->GetBestAskVolume(), 40);
+    EXPECT_EQ(book->GetTotalBidVolume(), 220);
+    
+    // Sell 170 sweeps the 100.00 level and takes 20 from 99.90
+    book->AddOrder(2002, 3, false, 170, 9990);
+    EXPECT_EQ(book->GetBestBid(), 9990);
+    EXPECT_EQ(book->GetBestBidVolume(), 50);
+    EXPECT_EQ(book->GetTotalBidVolume(), 50);
+    
+    // Modify moves the ask to a better price
+    book->ModifyOrder(2001, 30, 10005);
+    EXPECT_EQ(book->GetBestAsk(), 10005);
+    EXPECT_EQ(book->GetBestAskVolume(), 30);
+    EXPECT_EQ(book->GetTotalAskVolume(), 30);
+    
+    book->CancelOrder(1003);
+    EXPECT_EQ(book->GetBestBid(), 0);
+    EXPECT_EQ(book->GetBestBidVolume(), 0);
+    EXPECT_EQ(book->GetTotalBidVolume(), 0);
+}
+
 // Test cancelling non-existent order
 TEST_F(OrderBookTest, CancelNonExistentOrder) {
     EXPECT_THROW(book->CancelOrder(99999), std::runtime_error);
@@ -155,6 +205,27 @@ TEST_F(OrderBookTest, PartialFillMultipleLevels) {
     EXPECT_EQ(book->GetTotalBidVolume(), 75);    // Unmatched portion becomes resting order
 }
 
+// Test that clients receive each trade as it executes, in sweep order and
+// before the aggressor is acknowledged
+TEST_F(OrderBookTest, TradesStreamToClientsDuringSweep) {
+    book->AddOrder(2001, 2, false, 50, 10050);
+    book->AddOrder(2002, 2, false, 75, 10060);
+    book->AddOrder(2003, 2, false, 100, 10060);
+
+    auto client = std::make_shared<RecordingClient>(1, book.get());
+    book->RegisterClient(client);
+    book->AddOrder(1001, 1, true, 250, 10065);
+
+    std::vector<std::string> expected{"trade 2001", "trade 2002", "trade 2003", "ack 1001", "tob 10065/0"};
+    EXPECT_EQ(client->events, expected);
+    ASSERT_EQ(client->trades.size(), 3);
+    EXPECT_EQ(client->trades[2].quantity, 100);
+    EXPECT_EQ(client->trades[2].price, 10060);
+    // Side totals already reflect each level's fill when its trades arrive
+    EXPECT_EQ(client->volumes_at_trade[0].second, 175);
+    EXPECT_EQ(client->volumes_at_trade[2].second, 0);
+}
+
 // Test that orders at same price maintain time priority
 TEST_F(OrderBookTest, TimePriorityAtSamePrice) {
     // Add multiple buy orders at same price
@@ -331,3 +402,799 @@ TEST_F(OrderBookTest, ModifyOrderTimePriority) {
     EXPECT_EQ(book->GetTotalBidVolume(), 225);  // 25 + 100 + 100
     EXPECT_EQ(book->GetTotalAskVolume(), 0);    // Sell order fully filled
 }
+
+// Test the non-throwing API: statuses, resulting order state and rejection notifications
+TEST_F(OrderBookTest, TryApiReportsStatusWithoutThrowing) {
+    auto client = std::make_shared<RecordingClient>();
+    book->RegisterClient(client);
+
+    OrderResult result = book->TryAddOrder(2001, 2, false, 50, 10050, 1, 1);
+    EXPECT_TRUE(result.Ok());
+    EXPECT_EQ(result.state, OrderState::Resting);
+    EXPECT_EQ(result.resting_quantity, 50);
+
+    EXPECT_EQ(book->TryAddOrder(2001, 2, false, 50, 10050, 1, 1).status, OrderStatus::DuplicateOrderId);
+    EXPECT_EQ(book->TryAddOrder(2002, 2, false, 0, 10050, 1, 1).status, OrderStatus::ZeroQuantity);
+    EXPECT_EQ(book->TryCancelOrder(9999).status, OrderStatus::OrderNotFound);
+    EXPECT_EQ(book->TryModifyOrder(9999, 10, 10050).status, OrderStatus::OrderNotFound);
+    result = book->TryModifyOrder(2001, 0, 10050);
+    EXPECT_EQ(result.status, OrderStatus::ZeroModifiedQuantity);
+    EXPECT_EQ(result.state, OrderState::Rejected);
+    EXPECT_EQ(client->last_reject_reason, "Modified order quantity must be greater than zero");
+
+    // Partial fill of the aggressor leaves the rest resting
+    result = book->TryAddOrder(1001, 1, true, 80, 10050, 2, 2);
+    EXPECT_EQ(result.state, OrderState::Resting);
+    EXPECT_EQ(result.filled_quantity, 50);
+    EXPECT_EQ(result.resting_quantity, 30);
+
+    // Crossing modify that fills completely
+    book->AddOrder(2003, 2, false, 30, 10100);
+    result = book->TryModifyOrder(2003, 30, 10000);
+    EXPECT_EQ(result.state, OrderState::Filled);
+    EXPECT_EQ(result.filled_quantity, 30);
+
+    result = book->TryAddOrder(1002, 1, true, 10, 10000, 3, 3);
+    EXPECT_EQ(book->TryCancelOrder(1002).state, OrderState::Cancelled);
+    EXPECT_EQ(book->GetTotalBidVolume(), 0);
+
+    // Every rejection still reached the client
+    size_t rejections = std::count_if(client->events.begin(), client->events.end(),
+                                      [](const std::string& event) { return event.rfind("reject", 0) == 0; });
+    EXPECT_EQ(rejections, 5);
+    EXPECT_EQ(std::string(ToString(OrderStatus::DuplicateOrderId)), "Order ID already exists");
+}
+
+// The throwing wrappers keep the messages they had before the Try* API
+TEST_F(OrderBookTest, ThrowingApiKeepsRejectionMessages) {
+    book->AddOrder(1001, 1, true, 100, 10000);
+    auto message = [](const auto& operation) {
+        try {
+            operation();
+        } catch (const std::exception& error) {
+            return std::string(error.what());
+        }
+        return std::string();
+    };
+    EXPECT_EQ(message([&] { book->AddOrder(1002, 1, true, 0, 10000); }), "Order quantity must be greater than zero");
+    EXPECT_EQ(message([&] { book->ModifyOrder(1001, 0, 10000); }), "Modified order quantity must be greater than zero");
+    EXPECT_EQ(message([&] { book->AddOrder(1001, 1, true, 10, 10000); }), "Order ID already exists");
+    EXPECT_EQ(message([&] { book->CancelOrder(9999); }), "Order ID not found");
+}
+
+// Test that quantities beyond the order's 32-bit field are refused, not truncated
+TEST_F(OrderBookTest, QuantityAboveUint32IsRejected) {
+    const uint64_t too_large = uint64_t{UINT32_MAX} + 1;
+    EXPECT_EQ(book->TryAddOrder(1, 1, true, too_large, 10000, 0, 0).status, OrderStatus::QuantityTooLarge);
+    EXPECT_THROW(book->AddOrder(1, 1, true, too_large, 10000), std::invalid_argument);
+    EXPECT_EQ(book->GetTotalBidVolume(), 0);
+
+    OrderResult result = book->TryAddOrder(2, 1, true, UINT32_MAX, 10000, 0, 0);
+    EXPECT_EQ(result.resting_quantity, UINT32_MAX);
+    EXPECT_EQ(book->TryModifyOrder(2, too_large, 10000).status, OrderStatus::QuantityTooLarge);
+    EXPECT_EQ(book->GetBestBidVolume(), UINT32_MAX);
+}
+
+// Performance test: rejected operations through the status API versus exceptions
+TEST_F(OrderBookTest, RejectedOperationsPerformance) {
+    book->AddOrder(1, 1, true, 100, 10000);
+    const int iterations = 100000;
+
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        try {
+            book->AddOrder(1, 1, true, 100, 10000, 0, 0);
+        } catch (const std::runtime_error&) {
+        }
+        try {
+            book->CancelOrder(2);
+        } catch (const std::runtime_error&) {
+        }
+    }
+    auto middle = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        ASSERT_FALSE(book->TryAddOrder(1, 1, true, 100, 10000, 0, 0).Ok());
+        ASSERT_FALSE(book->TryCancelOrder(2).Ok());
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+
+    auto throwing_us = std::chrono::duration_cast<std::chrono::microseconds>(middle - start).count();
+    auto status_us = std::chrono::duration_cast<std::chrono::microseconds>(end - middle).count();
+    EXPECT_LT(status_us, 100000);  // Less than 100ms
+    std::cout << 2 * iterations << " rejected operations: exceptions " << throwing_us
+              << " us, status codes " << status_us << " us" << std::endl;
+}
+
+// Test the in-place modify paths: queue position, re-queueing and crossing
+TEST_F(OrderBookTest, ModifyOrderInPlacePaths) {
+    book->AddOrder(1001, 1, true, 100, 10000);
+    book->AddOrder(1002, 2, true, 100, 10000);
+    book->AddOrder(1003, 3, true, 100, 9990);
+    book->AddOrder(2001, 4, false, 100, 10100);
+    size_t orders_in_use = book->GetOrderPool().InUse();
+
+    auto client = std::make_shared<RecordingClient>();
+    book->RegisterClient(client);
+
+    // Size increase at the same price goes to the back of the queue
+    book->ModifyOrder(1001, 150, 10000);
+    EXPECT_EQ(book->GetBestBidVolume(), 250);
+    // Price move to an occupied level joins behind the orders already there
+    book->ModifyOrder(1003, 40, 10000);
+    EXPECT_EQ(book->GetBestBidVolume(), 290);
+    EXPECT_EQ(book->GetTotalBidVolume(), 290);
+
+    // A sell for 120 fills 1002 first, then 1001
+    book->AddOrder(2002, 4, false, 120, 10000);
+    ASSERT_EQ(client->trades.size(), 2);
+    EXPECT_EQ(client->trades[0].resting_order_id, 1002);
+    EXPECT_EQ(client->trades[1].resting_order_id, 1001);
+    EXPECT_EQ(client->trades[1].quantity, 20);
+    EXPECT_EQ(book->GetTotalBidVolume(), 170);
+
+    // Crossing modify matches, then rests the remainder at its new price
+    OrderResult result = book->TryModifyOrder(1003, 140, 10100);
+    EXPECT_EQ(result.filled_quantity, 100);
+    EXPECT_EQ(result.state, OrderState::Resting);
+    EXPECT_EQ(book->GetBestBid(), 10100);
+    EXPECT_EQ(book->GetBestBidVolume(), 40);
+    EXPECT_EQ(book->GetBestAsk(), 0);
+
+    // None of the modifies allocated a new order
+    EXPECT_EQ(book->GetOrderPool().InUse(), orders_in_use - 2);
+}
+
+// Performance test: aggressive orders alternately sweeping each side
+TEST_F(OrderBookTest, MatchingSweepPerformance) {
+    const int rounds = 2000;
+    const int levels = 10;
+    uint64_t next_id = 1;
+
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int round = 0; round < rounds; ++round) {
+        bool sweep_asks = (round % 2) == 0;
+        // Build `levels` levels of two orders each, then take them all out
+        for (int level = 0; level < levels; ++level) {
+            uint64_t price = sweep_asks ? 10100 + level : 9900 - level;
+            book->AddOrder(next_id++, 1, !sweep_asks, 50, price);
+            book->AddOrder(next_id++, 1, !sweep_asks, 50, price);
+        }
+        book->AddOrder(next_id++, 2, sweep_asks, 100 * levels, sweep_asks ? 10100 + levels : 9900 - levels);
+        ASSERT_EQ(book->GetTotalBidVolume() + book->GetTotalAskVolume(), 0);
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+
+    EXPECT_LT(duration.count(), 500000);  // Less than 500ms
+    std::cout << "Swept " << rounds * levels << " levels (" << rounds * levels * 2 << " fills) in "
+              << duration.count() << " microseconds" << std::endl;
+}
+
+// Test the passive add path alongside crossing adds and duplicate IDs
+TEST_F(OrderBookTest, PassiveAddSkipsMatching) {
+    auto client = std::make_shared<RecordingClient>();
+    book->RegisterClient(client);
+
+    book->AddOrder(2001, 2, false, 100, 10050);
+    // Bids below the best ask rest without trading
+    OrderResult result = book->TryAddOrder(1001, 1, true, 100, 10049, 0, 0);
+    EXPECT_EQ(result.state, OrderState::Resting);
+    EXPECT_EQ(result.filled_quantity, 0);
+    EXPECT_TRUE(client->trades.empty());
+
+    // A duplicate ID is refused and does not hold on to a pooled order
+    size_t orders_in_use = book->GetOrderPool().InUse();
+    EXPECT_EQ(book->TryAddOrder(1001, 1, true, 100, 10000, 0, 0).status, OrderStatus::DuplicateOrderId);
+    EXPECT_EQ(book->GetOrderPool().InUse(), orders_in_use);
+
+    // Touching the best ask still matches, and a filled aggressor's ID is free again
+    result = book->TryAddOrder(1002, 1, true, 100, 10050, 0, 0);
+    EXPECT_EQ(result.state, OrderState::Filled);
+    EXPECT_EQ(client->trades.size(), 1);
+    EXPECT_TRUE(book->TryAddOrder(1002, 1, false, 10, 10060, 0, 0).Ok());
+}
+
+// Test that a batch applies every command and notifies clients once at the end
+TEST_F(OrderBookTest, ApplyBatchDefersNotifications) {
+    auto client = std::make_shared<RecordingClient>();
+    book->RegisterClient(client);
+
+    std::vector<BookCommand> commands{
+        BookCommand::Add(2001, 2, false, 100, 10050, 1, 1),
+        BookCommand::Add(1001, 1, true, 100, 10000, 2, 2),
+        BookCommand::Modify(1001, 60, 10000),
+        BookCommand::Cancel(9999),                           // Unknown ID
+        BookCommand::Add(1002, 1, true, 40, 10050, 3, 3),    // Crosses
+        BookCommand::Cancel(1001),
+    };
+    std::vector<OrderResult> results;
+    size_t applied = book->ApplyBatch(commands, &results);
+
+    EXPECT_EQ(applied, 5);
+    ASSERT_EQ(results.size(), commands.size());
+    EXPECT_EQ(results[3].status, OrderStatus::OrderNotFound);
+    EXPECT_EQ(results[4].state, OrderState::Filled);
+    EXPECT_EQ(results[4].filled_quantity, 40);
+
+    // Callbacks arrive in command order, with a single top-of-book update
+    std::vector<std::string> expected{"ack 2001", "ack 1001", "modify 1001", "reject 9999",
+                                      "trade 2001", "cancel 1001", "tob 0/10050"};
+    EXPECT_EQ(client->events, expected);
+    EXPECT_EQ(book->GetBestAskVolume(), 60);
+
+    // Buffers are reused: a second batch only reports its own events
+    client->events.clear();
+    book->ApplyBatch(std::vector<BookCommand>{BookCommand::Cancel(2001)});
+    EXPECT_EQ(client->events, (std::vector<std::string>{"cancel 2001", "tob 0/0"}));
+}
+
+// Test that top-of-book updates are only published when the top changes
+TEST_F(OrderBookTest, TopOfBookPublishedOnlyOnChange) {
+    auto client = std::make_shared<RecordingClient>();
+    book->RegisterClient(client);
+
+    book->AddOrder(1, 1, true, 10, 10000, 0, 0);   // New best bid
+    book->AddOrder(2, 1, true, 10, 9900, 0, 0);    // Below the best: no TOB
+    book->ModifyOrder(2, 5, 9900);                 // Still below the best: no TOB
+    book->CancelOrder(2);                          // Deep cancel: no TOB
+    book->AddOrder(3, 1, true, 10, 10000, 0, 0);   // Best bid size changes
+    book->AddOrder(4, 2, false, 20, 10000, 0, 0);  // Fully filled aggressor still moves the top
+    std::vector<std::string> expected{"ack 1", "tob 10000/0", "ack 2", "modify 2", "cancel 2",
+                                      "ack 3", "tob 10000/0", "trade 1", "trade 3", "tob 0/0"};
+    EXPECT_EQ(client->events, expected);
+    EXPECT_EQ(book->GetTopOfBook(), TopOfBook{});
+}
+
+// Test that BeginEvent/EndEvent publish at most one top-of-book update per event
+TEST_F(OrderBookTest, TopOfBookCoalescedPerEvent) {
+    auto client = std::make_shared<RecordingClient>();
+    book->RegisterClient(client);
+
+    book->BeginEvent();
+    book->AddOrder(1, 1, true, 10, 10000, 0, 0);
+    book->AddOrder(2, 2, false, 10, 10100, 0, 0);
+    book->AddOrder(3, 2, false, 10, 10050, 0, 0);
+    EXPECT_EQ(client->events, (std::vector<std::string>{"ack 1", "ack 2", "ack 3"}));
+    book->EndEvent();
+    EXPECT_EQ(client->events.back(), "tob 10000/10050");
+    EXPECT_EQ(client->events.size(), 4);
+
+    // An event that ends where it started publishes nothing
+    client->events.clear();
+    book->BeginEvent();
+    book->AddOrder(4, 1, true, 10, 10010, 0, 0);
+    book->CancelOrder(4);
+    book->EndEvent();
+    EXPECT_EQ(client->events, (std::vector<std::string>{"ack 4", "cancel 4"}));
+
+    // A batch inside an event waits for the event
+    client->events.clear();
+    book->BeginEvent();
+    book->ApplyBatch(std::vector<BookCommand>{BookCommand::Cancel(3)});
+    EXPECT_EQ(client->events, (std::vector<std::string>{"cancel 3"}));
+    book->EndEvent();
+    book->EndEvent();  // Unbalanced EndEvent is ignored
+    EXPECT_EQ(client->events, (std::vector<std::string>{"cancel 3", "tob 10000/10100"}));
+}
+
+// Performance test: batched commands versus one call per command with a client attached
+TEST_F(OrderBookTest, ApplyBatchPerformance) {
+    auto client = std::make_shared<RecordingClient>();
+    book->RegisterClient(client);
+    const uint64_t orders = 20000;
+
+    // Rest, reprice and cancel every order
+    std::vector<BookCommand> commands;
+    for (uint64_t i = 0; i < orders; ++i) {
+        commands.push_back(BookCommand::Add(i + 1, 1, i % 2 == 0, 10, i % 2 == 0 ? 9000 + i % 100 : 11000 - i % 100, 0, 0));
+    }
+    for (uint64_t i = 0; i < orders; ++i) {
+        commands.push_back(BookCommand::Modify(i + 1, 5, i % 2 == 0 ? 9100 : 10900));
+    }
+    for (uint64_t i = 0; i < orders; ++i) {
+        commands.push_back(BookCommand::Cancel(i + 1));
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+    for (const BookCommand& command : commands) {
+        book->Apply(command);
+    }
+    auto middle = std::chrono::high_resolution_clock::now();
+    client->events.clear();
+    size_t applied = book->ApplyBatch(commands.data(), commands.size());
+    auto end = std::chrono::high_resolution_clock::now();
+
+    EXPECT_EQ(applied, commands.size());
+    EXPECT_EQ(client->events.size(), commands.size());  // One callback each; the book ends empty as it began, so no TOB
+    auto single_us = std::chrono::duration_cast<std::chrono::microseconds>(middle - start).count();
+    auto batch_us = std::chrono::duration_cast<std::chrono::microseconds>(end - middle).count();
+    EXPECT_LT(batch_us, 1000000);  // Less than 1 second
+    std::cout << commands.size() << " commands: one call each " << single_us
+              << " us, one batch " << batch_us << " us" << std::endl;
+}
+
+// Listener resolved at compile time: counts events and remembers the last TOB
+struct CountingListener : BookListener {
+    void OnTrade(const Trade& trade) {
+        ++trades;
+        traded_quantity += trade.quantity;
+    }
+    void OnOrderAcknowledged(uint64_t) { ++acks; }
+    void OnOrderCancelled(uint64_t) { ++cancels; }
+    void OnOrderRejected(uint64_t, OrderStatus status) { last_reject = status; }
+    void OnTopOfBook(uint64_t best_bid, uint64_t best_ask, uint64_t, uint64_t) {
+        ++tob_updates;
+        last_bid = best_bid;
+        last_ask = best_ask;
+    }
+
+    uint64_t trades = 0;
+    uint64_t traded_quantity = 0;
+    uint64_t acks = 0;
+    uint64_t cancels = 0;
+    uint64_t tob_updates = 0;
+    uint64_t last_bid = 0;
+    uint64_t last_ask = 0;
+    OrderStatus last_reject = OrderStatus::Ok;
+};
+
+// Test that a static listener sees the same events a registered client would
+TEST(BasicOrderBookTest, StaticListenerReceivesEvents) {
+    BasicOrderBook<CountingListener> book;
+    book.AddOrder(1, 1, false, 10, 10100, 0, 0);
+    book.AddOrder(2, 1, false, 10, 10200, 0, 0);
+    book.AddOrder(3, 2, true, 15, 10200, 0, 0);  // Takes all of order 1 and half of order 2
+    book.AddOrder(4, 2, true, 5, 9900, 0, 0);
+    book.CancelOrder(4);
+    EXPECT_FALSE(book.TryCancelOrder(4).Ok());
+
+    const CountingListener& listener = book.GetListener();
+    EXPECT_EQ(listener.trades, 2);
+    EXPECT_EQ(listener.traded_quantity, 15);
+    EXPECT_EQ(listener.acks, 3);  // The filled aggressor is not acknowledged
+    EXPECT_EQ(listener.cancels, 1);
+    EXPECT_EQ(listener.last_reject, OrderStatus::OrderNotFound);
+    EXPECT_EQ(listener.last_bid, 0);
+    EXPECT_EQ(listener.last_ask, 10200);
+
+    // Batches replay the same hooks once the batch is done
+    std::vector<BookCommand> commands = {BookCommand::Add(5, 3, true, 1, 10000, 0, 0), BookCommand::Cancel(5)};
+    EXPECT_EQ(book.ApplyBatch(commands), 2);
+    EXPECT_EQ(listener.acks, 4);
+    EXPECT_EQ(listener.cancels, 2);
+
+    // A book nobody listens to still matches
+    BasicOrderBook<NullBookListener> silent;
+    silent.AddOrder(1, 1, false, 10, 10100, 0, 0);
+    EXPECT_EQ(silent.TryAddOrder(2, 1, true, 4, 10100, 0, 0).filled_quantity, 4);
+    EXPECT_EQ(silent.GetTotalAskVolume(), 6);
+}
+
+// Performance test: the same flow through a registered IClient and a static listener
+TEST(BasicOrderBookTest, StaticListenerPerformance) {
+    const uint64_t orders = 200000;
+    auto run = [orders](auto& book) {
+        auto start = std::chrono::high_resolution_clock::now();
+        for (uint64_t i = 0; i < orders; ++i) {
+            bool is_buy = i % 2 == 0;
+            // Every fourth order crosses; the rest rest near the spread
+            uint64_t price = i % 4 == 3 ? (is_buy ? 10100 : 9900) : (is_buy ? 9990 - i % 10 : 10010 + i % 10);
+            book.TryAddOrder(i + 1, 1, is_buy, 10, price, 0, 0);
+            if (i % 4 == 1) {
+                book.TryCancelOrder(i);
+            }
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        return std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+    };
+
+    OrderBook dynamic_book;
+    auto client = std::make_shared<RecordingClient>();
+    dynamic_book.RegisterClient(client);
+    auto dynamic_us = run(dynamic_book);
+
+    BasicOrderBook<CountingListener> static_book;
+    auto static_us = run(static_book);
+
+    EXPECT_EQ(static_book.GetListener().trades, client->trades.size());
+    EXPECT_LT(static_us, 2000000);  // Less than 2 seconds
+    std::cout << orders << " orders: IClient registry " << dynamic_us << " us, static listener " << static_us
+              << " us" << std::endl;
+}
+
+// Test that GetDepth copies the best levels of each side in order
+TEST_F(OrderBookTest, GetDepthCopiesTopLevels) {
+    book->AddOrder(1, 1, true, 10, 10000, 0, 0);
+    book->AddOrder(2, 1, true, 5, 10000, 0, 0);
+    book->AddOrder(3, 1, true, 7, 9900, 0, 0);
+    book->AddOrder(4, 1, true, 1, 9800, 0, 0);
+    book->AddOrder(5, 2, false, 4, 10100, 0, 0);
+
+    DepthLevel depth[2];
+    ASSERT_EQ(book->GetDepth(BookSide::Bid, 2, depth), 2);
+    EXPECT_EQ(depth[0].price, 10000);
+    EXPECT_EQ(depth[0].quantity, 15);
+    EXPECT_EQ(depth[0].order_count, 2);
+    EXPECT_EQ(depth[1].price, 9900);
+    EXPECT_EQ(depth[1].quantity, 7);
+
+    DepthLevel asks[8];
+    ASSERT_EQ(book->GetDepth(BookSide::Ask, 8, asks), 1);
+    EXPECT_EQ(asks[0].price, 10100);
+    EXPECT_EQ(asks[0].quantity, 4);
+    EXPECT_EQ(book->GetDepth(BookSide::Ask, 0, asks), 0);
+}
+
+// Listener that keeps its own L2 book from level updates alone
+struct L2Listener : BookListener {
+    bool WantsLevelUpdates() const { return true; }
+    void OnLevelUpdate(const LevelUpdate& update) {
+        auto& side = update.side == BookSide::Bid ? bids : asks;
+        switch (update.action) {
+            case LevelAction::Add:
+                EXPECT_EQ(side.count(update.price), 0u) << "Add of existing level " << update.price;
+                side[update.price] = DepthLevel{update.price, update.quantity, update.order_count};
+                break;
+            case LevelAction::Update:
+                EXPECT_EQ(side.count(update.price), 1u) << "Update of unknown level " << update.price;
+                side[update.price] = DepthLevel{update.price, update.quantity, update.order_count};
+                break;
+            case LevelAction::Remove:
+                EXPECT_EQ(side.erase(update.price), 1u) << "Remove of unknown level " << update.price;
+                break;
+        }
+        ++updates;
+    }
+
+    std::map<uint64_t, DepthLevel> bids;
+    std::map<uint64_t, DepthLevel> asks;
+    uint64_t updates = 0;
+};
+
+// Test that applying level updates in order reproduces the book's depth
+TEST(BasicOrderBookTest, LevelUpdatesRebuildDepth) {
+    for (PriceLadderType type : {PriceLadderType::Map, PriceLadderType::Flat}) {
+        OrderBookConfig config;
+        config.price_ladder.type = type;
+        BasicOrderBook<L2Listener> book(config);
+        std::mt19937 rng(11);
+        std::vector<uint64_t> live;
+
+        auto check = [&book]() {
+            const L2Listener& l2 = book.GetListener();
+            DepthLevel depth[512];
+            size_t bid_levels = book.GetDepth(BookSide::Bid, 512, depth);
+            ASSERT_EQ(bid_levels, l2.bids.size());
+            auto bid = l2.bids.rbegin();
+            for (size_t i = 0; i < bid_levels; ++i, ++bid) {
+                EXPECT_EQ(depth[i].price, bid->second.price);
+                EXPECT_EQ(depth[i].quantity, bid->second.quantity);
+                EXPECT_EQ(depth[i].order_count, bid->second.order_count);
+            }
+            size_t ask_levels = book.GetDepth(BookSide::Ask, 512, depth);
+            ASSERT_EQ(ask_levels, l2.asks.size());
+            auto ask = l2.asks.begin();
+            for (size_t i = 0; i < ask_levels; ++i, ++ask) {
+                EXPECT_EQ(depth[i].price, ask->second.price);
+                EXPECT_EQ(depth[i].quantity, ask->second.quantity);
+            }
+        };
+
+        std::vector<BookCommand> batch;
+        for (uint64_t step = 0; step < 20000; ++step) {
+            uint32_t action = rng() % 10;
+            BookCommand command;
+            if (action < 5 || live.empty()) {
+                bool is_buy = rng() % 2 == 0;
+                // Centered on 10000 so adds regularly cross and sweep levels
+                uint64_t price = is_buy ? 9950 + rng() % 60 : 9990 + rng() % 60;
+                command = BookCommand::Add(step + 1, 1, is_buy, 1 + rng() % 20, price, 0, 0);
+                live.push_back(step + 1);
+            } else {
+                size_t pick = rng() % live.size();
+                uint64_t order_id = live[pick];
+                if (action < 8) {
+                    command = BookCommand::Cancel(order_id);
+                    live[pick] = live.back();
+                    live.pop_back();
+                } else {
+                    command = BookCommand::Modify(order_id, 1 + rng() % 20, 9960 + rng() % 80);
+                }
+            }
+            // Every other stretch goes through ApplyBatch to cover deferred updates
+            if ((step / 500) % 2 == 0) {
+                book.Apply(command);
+            } else {
+                batch.push_back(command);
+                if (batch.size() == 50) {
+                    book.ApplyBatch(batch);
+                    batch.clear();
+                }
+            }
+            if (step % 1000 == 999) {
+                check();
+            }
+        }
+        book.ApplyBatch(batch);
+        check();
+        EXPECT_GT(book.GetListener().updates, 10000u);
+    }
+}
+
+// Test that registered clients only get level updates if they ask for them
+TEST_F(OrderBookTest, LevelUpdatesAreOptInForClients) {
+    struct DepthClient : RecordingClient {
+        using RecordingClient::RecordingClient;
+        bool WantsLevelUpdates() const override { return true; }
+        void OnLevelUpdate(const LevelUpdate& update) override { updates.push_back(update); }
+        std::vector<LevelUpdate> updates;
+    };
+    auto depth_client = std::make_shared<DepthClient>(1);
+    auto plain_client = std::make_shared<RecordingClient>(2);
+    book->RegisterClient(depth_client);
+    book->RegisterClient(plain_client);
+
+    book->AddOrder(1, 1, false, 10, 10100, 0, 0);
+    book->AddOrder(2, 1, false, 5, 10100, 0, 0);
+    book->AddOrder(3, 2, true, 12, 10100, 0, 0);  // Leaves 3 resting at 10100
+    book->CancelOrder(2);
+
+    ASSERT_EQ(depth_client->updates.size(), 4);
+    EXPECT_EQ(depth_client->updates[0].action, LevelAction::Add);
+    EXPECT_EQ(depth_client->updates[0].side, BookSide::Ask);
+    EXPECT_EQ(depth_client->updates[1].quantity, 15);
+    EXPECT_EQ(depth_client->updates[1].order_count, 2);
+    EXPECT_EQ(depth_client->updates[2].action, LevelAction::Update);
+    EXPECT_EQ(depth_client->updates[2].quantity, 3);
+    EXPECT_EQ(depth_client->updates[2].order_count, 1);
+    EXPECT_EQ(depth_client->updates[3].action, LevelAction::Remove);
+    EXPECT_EQ(depth_client->updates[3].price, 10100);
+
+    // Unregistering the only subscriber turns level updates off again
+    book->UnregisterClient(1);
+    book->AddOrder(4, 1, true, 1, 9000, 0, 0);
+    EXPECT_EQ(depth_client->updates.size(), 4);
+}
+
+// Test that the legacy AddOrder and re-queuing modifies read the injected clock
+TEST(BasicOrderBookTest, InjectedClockStampsOrders) {
+    auto clock = std::make_shared<ReplayClock>(1000);
+    OrderBookConfig config;
+    config.clock = clock;
+    OrderBook book(config);
+    auto client = std::make_shared<RecordingClient>(1);
+    book.RegisterClient(client);
+
+    book.AddOrder(1, 1, true, 10, 100);  // Stamped 1000
+    clock->Advance(2000);
+    clock->Advance(1500);                // Never goes backwards
+    EXPECT_EQ(clock->Now(), 2000);
+    book.AddOrder(2, 2, false, 4, 100);  // Aggressor stamped 2000
+    ASSERT_EQ(client->trades.size(), 1);
+    EXPECT_EQ(client->trades[0].ts_received, 2000);
+    EXPECT_EQ(client->trades[0].ts_executed, 2000);
+
+    // A modify that loses priority restamps ts_executed; one that crosses
+    // reports it as the aggressor's
+    book.AddOrder(3, 3, false, 2, 105, 5, 5);
+    clock->Advance(3000);
+    book.ModifyOrder(1, 6, 105);
+    ASSERT_EQ(client->trades.size(), 2);
+    EXPECT_EQ(client->trades[1].aggressor_order_id, 1);
+    EXPECT_EQ(client->trades[1].ts_received, 1000);
+    EXPECT_EQ(client->trades[1].ts_executed, 3000);
+}
+
+// Test that two replays with injected clock and ID source produce identical trades
+TEST(BasicOrderBookTest, ReplaysAreDeterministic) {
+    struct TradeLog : BookListener {
+        void OnTrade(const Trade& trade) { trades.push_back(trade); }
+        std::vector<Trade> trades;
+    };
+
+    std::mt19937_64 rng(17);
+    std::vector<BookCommand> feed;
+    for (uint64_t i = 1; i <= 20000; ++i) {
+        switch (rng() % 4) {
+            case 0:
+                feed.push_back(BookCommand::Cancel(1 + rng() % i));
+                break;
+            case 1:
+                feed.push_back(BookCommand::Modify(1 + rng() % i, 1 + rng() % 20, 9950 + rng() % 100));
+                break;
+            default:
+                bool is_buy = (rng() & 1) != 0;
+                feed.push_back(BookCommand::Add(i, i % 7, is_buy, 1 + rng() % 20, 9950 + rng() % 100, 0, 0));
+                break;
+        }
+    }
+
+    auto replay = [&feed]() {
+        auto clock = std::make_shared<ReplayClock>();
+        OrderBookConfig config;
+        config.clock = clock;
+        config.execution_ids = std::make_shared<SequentialExecutionIdSource>();
+        BasicOrderBook<TradeLog> book(config);
+        uint64_t ts_recv = 1700000000000000000ull;
+        for (const BookCommand& command : feed) {
+            ts_recv += 1 + command.order_id % 13;
+            clock->Advance(ts_recv);
+            BookCommand stamped = command;
+            if (stamped.type == BookCommandType::Add) {
+                stamped.ts_received = stamped.ts_executed = ts_recv;
+            }
+            book.Apply(stamped);
+        }
+        return book.GetListener().trades;
+    };
+
+    std::vector<Trade> first = replay();
+    std::vector<Trade> second = replay();
+    ASSERT_GT(first.size(), 1000u);
+    ASSERT_EQ(first.size(), second.size());
+    for (size_t i = 0; i < first.size(); ++i) {
+        EXPECT_EQ(first[i].execution_id, i + 1);
+        EXPECT_EQ(std::memcmp(&first[i], &second[i], sizeof(Trade)), 0) << "Trade " << i << " differs";
+    }
+}
+
+// Test that each book numbers its trades from its own counter, optionally namespaced
+TEST(BasicOrderBookTest, PerBookExecutionIds) {
+    struct TradeLog : BookListener {
+        void OnTrade(const Trade& trade) { trades.push_back(trade); }
+        std::vector<Trade> trades;
+    };
+    auto cross_twice = [](BasicOrderBook<TradeLog>& book) {
+        book.AddOrder(1, 1, true, 10, 100);
+        book.AddOrder(2, 2, false, 4, 100);
+        book.AddOrder(3, 2, false, 4, 100);
+    };
+
+    BasicOrderBook<TradeLog> first;
+    BasicOrderBook<TradeLog> second;
+    cross_twice(first);
+    cross_twice(second);
+    ASSERT_EQ(first.GetListener().trades.size(), 2u);
+    ASSERT_EQ(second.GetListener().trades.size(), 2u);
+    for (const auto* book : {&first, &second}) {
+        EXPECT_EQ(book->GetListener().trades[0].execution_id, 1u);
+        EXPECT_EQ(book->GetListener().trades[1].execution_id, 2u);
+    }
+
+    OrderBookConfig config;
+    config.book_id = 42;
+    BasicOrderBook<TradeLog> namespaced(config);
+    cross_twice(namespaced);
+    ASSERT_EQ(namespaced.GetListener().trades.size(), 2u);
+    EXPECT_EQ(namespaced.GetListener().trades[0].execution_id, (uint64_t{42} << 32) | 1);
+    EXPECT_EQ(namespaced.GetListener().trades[1].execution_id, (uint64_t{42} << 32) | 2);
+
+    // An injected source takes precedence over the book's own counter
+    config.execution_ids = std::make_shared<SequentialExecutionIdSource>(500);
+    BasicOrderBook<TradeLog> injected(config);
+    cross_twice(injected);
+    EXPECT_EQ(injected.GetListener().trades[0].execution_id, 500u);
+    EXPECT_EQ(injected.GetListener().trades[1].execution_id, 501u);
+}
+
+// Test that an add or modify running out of memory at any of its allocations
+// is rejected whole, with the book left as it was and still usable
+TEST(BasicOrderBookTest, OutOfMemoryRejectsWholeCommand) {
+    for (PriceLadderType type : {PriceLadderType::Map, PriceLadderType::Flat}) {
+        for (std::ptrdiff_t allowed = 0;; ++allowed) {
+            // 14 orders fill both the pool and the index, so the next add has
+            // to grow each of them; the new prices lie outside the flat window
+            OrderBookConfig config;
+            config.order_pool.initial_capacity = 14;
+            config.order_pool.min_growth = 1;
+            config.price_ladder.type = type;
+            config.price_ladder.initial_window_ticks = 16;
+            BasicOrderBook<BookListener> book(config);
+            for (uint64_t id = 1; id <= 13; ++id) {
+                book.AddOrder(id, 1, true, 10, 10000);
+            }
+            book.AddOrder(14, 2, false, 10, 10100);
+
+            OrderResult add;
+            OrderResult modify;
+            size_t failures = 0;
+            {
+                ScopedAllocationFailure failure(allowed);
+                add = book.TryAddOrder(15, 1, true, 10, 9000, 1, 1);
+                modify = book.TryModifyOrder(14, 10, 10300, 1);
+                failures = failure.Failures();
+            }
+
+            if (add.Ok()) {
+                EXPECT_EQ(book.GetTotalBidVolume(), 140u);
+            } else {
+                EXPECT_EQ(add.status, OrderStatus::CapacityExhausted) << "allowed " << allowed;
+                EXPECT_EQ(book.GetTotalBidVolume(), 130u);
+                EXPECT_EQ(book.TryCancelOrder(15).status, OrderStatus::OrderNotFound);
+            }
+            if (modify.Ok()) {
+                EXPECT_EQ(book.GetBestAsk(), 10300u);
+            } else {
+                EXPECT_EQ(modify.status, OrderStatus::CapacityExhausted) << "allowed " << allowed;
+                EXPECT_EQ(book.GetBestAsk(), 10100u);
+            }
+            EXPECT_EQ(book.GetBestBid(), 10000u);
+            EXPECT_EQ(book.GetTotalAskVolume(), 10u);
+            EXPECT_TRUE(book.TryAddOrder(16, 3, false, 140, 9000, 1, 1).Ok());
+            EXPECT_EQ(book.GetTotalBidVolume(), 0u);
+
+            if (failures == 0) {
+                break;
+            }
+        }
+    }
+}
+
+// Test that a batch whose notification buffers cannot grow still delivers
+// every callback, in order, and applies the same commands
+TEST(BasicOrderBookTest, ApplyBatchDeliversEverythingWhenBuffersCannotGrow) {
+    // Records into fixed storage so the listener itself never allocates
+    struct FixedLog : BookListener {
+        bool WantsLevelUpdates() const { return true; }
+        void OnTrade(const Trade& trade) { Record('T', trade.resting_order_id); }
+        void OnOrderAcknowledged(uint64_t order_id) { Record('A', order_id); }
+        void OnOrderCancelled(uint64_t order_id) { Record('C', order_id); }
+        void OnOrderModified(uint64_t order_id, uint64_t, uint64_t) { Record('M', order_id); }
+        void OnOrderRejected(uint64_t order_id, OrderStatus) { Record('R', order_id); }
+        void OnLevelUpdate(const LevelUpdate& update) { Record('L', update.price); }
+        void OnTopOfBook(uint64_t best_bid, uint64_t, uint64_t, uint64_t) { Record('B', best_bid); }
+        void Record(char kind, uint64_t value) {
+            if (count < events.size()) {
+                events[count++] = {kind, value};
+            }
+        }
+        std::array<std::pair<char, uint64_t>, 64> events{};
+        size_t count = 0;
+    };
+    // The flat ladder creates levels inside its window without allocating,
+    // so only the notification buffers can run out
+    OrderBookConfig config;
+    config.price_ladder.type = PriceLadderType::Flat;
+    const BookCommand commands[] = {
+        BookCommand::Add(3, 1, true, 10, 10000, 1, 1),
+        BookCommand::Add(4, 1, false, 5, 10100, 1, 1),
+        BookCommand::Modify(3, 5, 10000, 1),
+        BookCommand::Cancel(99),
+        BookCommand::Add(5, 1, true, 15, 10100, 1, 1),
+        BookCommand::Cancel(2),
+    };
+    constexpr size_t kCount = sizeof(commands) / sizeof(commands[0]);
+    auto run = [&](BasicOrderBook<FixedLog>& book, std::ptrdiff_t allowed, OrderResult* results) {
+        book.AddOrder(1, 1, false, 10, 10100);
+        book.AddOrder(2, 1, true, 10, 10000);
+        book.GetListener().count = 0;
+        ScopedAllocationFailure failure(allowed);
+        book.ApplyBatch(commands, kCount, results);
+        return failure.Failures();
+    };
+
+    BasicOrderBook<FixedLog> reference(config);
+    OrderResult expected[kCount];
+    run(reference, PTRDIFF_MAX, expected);
+    const FixedLog& expected_log = reference.GetListener();
+    ASSERT_GT(expected_log.count, kCount);
+
+    for (std::ptrdiff_t allowed = 0;; ++allowed) {
+        BasicOrderBook<FixedLog> book(config);
+        OrderResult results[kCount];
+        const size_t failures = run(book, allowed, results);
+
+        const FixedLog& log = book.GetListener();
+        ASSERT_EQ(log.count, expected_log.count) << "allowed " << allowed;
+        for (size_t i = 0; i < log.count; ++i) {
+            EXPECT_EQ(log.events[i], expected_log.events[i]) << "allowed " << allowed << ", event " << i;
+        }
+        for (size_t i = 0; i < kCount; ++i) {
+            EXPECT_EQ(results[i].status, expected[i].status);
+            EXPECT_EQ(results[i].filled_quantity, expected[i].filled_quantity);
+        }
+        if (failures == 0) {
+            break;
+        }
+    }
+}
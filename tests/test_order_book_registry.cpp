@@ -0,0 +1,139 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include "OrderBookRegistry.h"
+#include "RecordingClient.h"
+
+// Test that books are created lazily, one per instrument, in dense slots
+TEST(OrderBookRegistryTest, CreatesBooksLazilyPerInstrument) {
+    OrderBookRegistry registry;
+    EXPECT_EQ(registry.Size(), 0);
+    EXPECT_EQ(registry.Find(42), nullptr);
+    EXPECT_EQ(registry.FindSlot(42), OrderBookRegistry::npos);
+
+    OrderBook& es = registry.GetOrCreate(42);
+    OrderBook& nq = registry.GetOrCreate(7);
+    EXPECT_EQ(registry.Size(), 2);
+    EXPECT_NE(&es, &nq);
+    EXPECT_EQ(&registry.GetOrCreate(42), &es);
+    EXPECT_EQ(registry.Find(42), &es);
+    EXPECT_EQ(registry.Size(), 2);
+
+    EXPECT_EQ(registry.FindSlot(42), 0);
+    EXPECT_EQ(registry.FindSlot(7), 1);
+    EXPECT_EQ(registry.InstrumentIdAt(0), 42);
+    EXPECT_EQ(registry.InstrumentIdAt(1), 7);
+    EXPECT_EQ(&registry.BookAt(1), &nq);
+    EXPECT_EQ(registry.SharedBookAt(0).get(), &es);
+
+    // Books are independent: the same order ID can rest in both
+    es.AddOrder(1, 1, true, 10, 100);
+    nq.AddOrder(1, 1, false, 5, 200);
+    EXPECT_EQ(es.GetBestBid(), 100);
+    EXPECT_EQ(es.GetBestAsk(), 0);
+    EXPECT_EQ(nq.GetBestAsk(), 200);
+    EXPECT_EQ(nq.GetBestBid(), 0);
+}
+
+// Test IDs on both sides of the direct-lookup limit
+TEST(OrderBookRegistryTest, LargeIdsUseOverflowMap) {
+    OrderBookRegistry registry(OrderBookConfig(), 1000);
+
+    size_t small = registry.GetOrCreateSlot(999);
+    size_t large = registry.GetOrCreateSlot(1000);
+    size_t huge = registry.GetOrCreateSlot(UINT32_MAX);
+    EXPECT_EQ(small, 0);
+    EXPECT_EQ(large, 1);
+    EXPECT_EQ(huge, 2);
+
+    EXPECT_EQ(registry.FindSlot(999), small);
+    EXPECT_EQ(registry.FindSlot(1000), large);
+    EXPECT_EQ(registry.FindSlot(UINT32_MAX), huge);
+    EXPECT_EQ(registry.FindSlot(998), OrderBookRegistry::npos);
+    EXPECT_EQ(registry.FindSlot(1001), OrderBookRegistry::npos);
+    EXPECT_EQ(registry.GetOrCreateSlot(UINT32_MAX), huge);
+    EXPECT_EQ(registry.Size(), 3);
+}
+
+// Test per-instrument config and the creation callback
+TEST(OrderBookRegistryTest, InstrumentConfigAndCreationCallback) {
+    OrderBookRegistry registry;
+
+    OrderBookConfig flat;
+    flat.price_ladder.type = PriceLadderType::Flat;
+    flat.price_ladder.tick_size = 25;
+    registry.SetInstrumentConfig(5, flat);
+
+    std::vector<std::pair<size_t, uint32_t>> created;
+    registry.SetBookCreatedCallback([&](size_t slot, uint32_t instrument_id, const std::shared_ptr<OrderBook>& book) {
+        ASSERT_NE(book, nullptr);
+        created.push_back({slot, instrument_id});
+    });
+
+    OrderBook& ticked = registry.GetOrCreate(5);
+    OrderBook& plain = registry.GetOrCreate(6);
+    registry.GetOrCreate(5);
+    ASSERT_EQ(created.size(), 2);
+    EXPECT_EQ(created[0], std::make_pair(size_t{0}, uint32_t{5}));
+    EXPECT_EQ(created[1], std::make_pair(size_t{1}, uint32_t{6}));
+
+    // Instrument 5 is on a 25-tick grid; instrument 6 takes any price
+    EXPECT_FALSE(ticked.TryAddOrder(1, 1, true, 10, 110, 0, 0).Ok());
+    EXPECT_TRUE(ticked.TryAddOrder(1, 1, true, 10, 100, 0, 0).Ok());
+    EXPECT_TRUE(plain.TryAddOrder(1, 1, true, 10, 110, 0, 0).Ok());
+
+    // Config cannot change once the book exists
+    EXPECT_THROW(registry.SetInstrumentConfig(5, OrderBookConfig()), std::invalid_argument);
+}
+
+// Test that each book's trade IDs are namespaced by its instrument ID
+TEST(OrderBookRegistryTest, TradeIdsNamespacedByInstrument) {
+    OrderBookRegistry registry;
+    auto client = std::make_shared<RecordingClient>();
+    for (uint32_t instrument_id : {3u, 9u}) {
+        OrderBook& book = registry.GetOrCreate(instrument_id);
+        book.RegisterClient(client);
+        book.AddOrder(1, 1, true, 10, 100);
+        book.AddOrder(2, 1, false, 10, 100);
+    }
+    ASSERT_EQ(client->trades.size(), 2);
+    EXPECT_EQ(client->trades[0].execution_id, (uint64_t{3} << 32) | 1);
+    EXPECT_EQ(client->trades[1].execution_id, (uint64_t{9} << 32) | 1);
+}
+
+// Performance test for routing messages to books by instrument ID
+TEST(OrderBookRegistryTest, RoutingPerformance) {
+    const uint32_t num_instruments = 64;
+    const int num_lookups = 1000000;
+    OrderBookRegistry registry;
+
+    std::mt19937 rng(7);
+    std::vector<uint32_t> instrument_ids;
+    for (uint32_t i = 0; i < num_instruments; ++i) {
+        instrument_ids.push_back(rng() % 500000);
+        registry.GetOrCreate(instrument_ids.back());
+    }
+    std::vector<uint32_t> stream(num_lookups);
+    for (auto& id : stream) {
+        id = instrument_ids[rng() % num_instruments];
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+    uintptr_t checksum = 0;
+    for (uint32_t id : stream) {
+        checksum += reinterpret_cast<uintptr_t>(registry.Find(id));
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+
+    std::cout << "Routed " << num_lookups << " messages across " << num_instruments << " books in "
+              << duration.count() << " microseconds" << std::endl;
+    EXPECT_NE(checksum, 0u);
+    EXPECT_LT(duration.count(), 100000);  // Should complete in less than 100ms
+}
@@ -0,0 +1,150 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+#include "OrderIndex.h"
+#include "Order.h"
+
+class OrderIndexTest : public ::testing::Test {
+protected:
+    // Distinct non-empty handles to store as values
+    static OrderHandle OrderAt(size_t i) { return static_cast<OrderHandle>(i % 64); }
+};
+
+// Test insert, find and erase
+TEST_F(OrderIndexTest, InsertFindErase) {
+    OrderIndex index;
+    EXPECT_TRUE(index.Empty());
+    EXPECT_EQ(index.Find(42), kNoOrder);
+
+    EXPECT_TRUE(index.Insert(42, OrderAt(1)));
+    EXPECT_TRUE(index.Insert(7, OrderAt(2)));
+    EXPECT_EQ(index.Size(), 2);
+    EXPECT_EQ(index.Find(42), OrderAt(1));
+    EXPECT_EQ(index.Find(7), OrderAt(2));
+    EXPECT_TRUE(index.Contains(7));
+
+    EXPECT_TRUE(index.Erase(42));
+    EXPECT_FALSE(index.Erase(42));
+    EXPECT_EQ(index.Find(42), kNoOrder);
+    EXPECT_EQ(index.Find(7), OrderAt(2));
+    EXPECT_EQ(index.Size(), 1);
+}
+
+// Test that duplicates are refused and empty handles rejected
+TEST_F(OrderIndexTest, DuplicateAndNull) {
+    OrderIndex index;
+    EXPECT_TRUE(index.Insert(5, OrderAt(1)));
+    EXPECT_FALSE(index.Insert(5, OrderAt(2)));
+    EXPECT_EQ(index.Find(5), OrderAt(1));
+    EXPECT_EQ(index.Size(), 1);
+
+    EXPECT_THROW(index.Insert(6, kNoOrder), std::invalid_argument);
+}
+
+// Test the pre-size hint and growth
+TEST_F(OrderIndexTest, ReserveAndGrowth) {
+    OrderIndex index(1000);
+    size_t capacity = index.Capacity();
+    EXPECT_GE(capacity, 1000);
+
+    for (uint64_t id = 0; id < 1000; ++id) {
+        index.Insert(id, OrderAt(id));
+    }
+    EXPECT_EQ(index.Capacity(), capacity);  // No rehash within the hint
+
+    for (uint64_t id = 1000; id < 10000; ++id) {
+        index.Insert(id, OrderAt(id));
+    }
+    EXPECT_GT(index.Capacity(), capacity);
+    for (uint64_t id = 0; id < 10000; ++id) {
+        ASSERT_EQ(index.Find(id), OrderAt(id));
+    }
+
+    index.Clear();
+    EXPECT_TRUE(index.Empty());
+    EXPECT_EQ(index.Find(500), kNoOrder);
+}
+
+// Test the index against std::unordered_map on random sparse IDs, including
+// long runs of add/erase churn that would fill a tombstoning table
+TEST_F(OrderIndexTest, MatchesReferenceMap) {
+    OrderIndex index;
+    std::unordered_map<uint64_t, OrderHandle> reference;
+    std::vector<uint64_t> live_ids;
+    std::mt19937_64 gen(99);
+
+    for (int i = 0; i < 200000; ++i) {
+        if (live_ids.size() < 2000 && (gen() % 3 != 0 || live_ids.empty())) {
+            // Mix sparse 64-bit IDs with a few small ones to force collisions
+            uint64_t id = (i % 4 == 0) ? gen() % 5000 : gen();
+            OrderHandle order = OrderAt(i);
+            bool inserted = reference.emplace(id, order).second;
+            ASSERT_EQ(index.Insert(id, order), inserted);
+            if (inserted) live_ids.push_back(id);
+        } else {
+            size_t position = gen() % live_ids.size();
+            uint64_t id = live_ids[position];
+            live_ids[position] = live_ids.back();
+            live_ids.pop_back();
+            reference.erase(id);
+            ASSERT_TRUE(index.Erase(id));
+        }
+
+        uint64_t probe = (i % 2 == 0 && !live_ids.empty()) ? live_ids[gen() % live_ids.size()] : gen() % 5000;
+        auto it = reference.find(probe);
+        ASSERT_EQ(index.Find(probe), it == reference.end() ? kNoOrder : it->second);
+    }
+
+    EXPECT_EQ(index.Size(), reference.size());
+    // Churn must not grow the table past what the live set needs
+    EXPECT_LE(index.Capacity(), 4096);
+}
+
+// Performance test: add/cancel mix against std::unordered_map
+TEST_F(OrderIndexTest, AddCancelMixPerformance) {
+    // ~50k live orders with sparse exchange IDs; each step adds one order,
+    // looks one up and cancels one, like a steady-state MBO feed
+    const size_t live_count = 50000;
+    const size_t operations = 1000000;
+    std::mt19937_64 gen(2024);
+    std::vector<uint64_t> ids(live_count + operations);
+    for (auto& id : ids) id = gen();
+
+    auto run = [&](auto& table, auto insert, auto find, auto erase) {
+        size_t checksum = 0;
+        auto start = std::chrono::high_resolution_clock::now();
+        for (size_t i = 0; i < live_count; ++i) {
+            insert(table, ids[i], OrderAt(i));
+        }
+        for (size_t i = 0; i < operations; ++i) {
+            insert(table, ids[live_count + i], OrderAt(i));
+            checksum += find(table, ids[i + live_count / 2]) != kNoOrder;
+            erase(table, ids[i]);
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        EXPECT_EQ(checksum, operations);
+        return std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+    };
+
+    std::unordered_map<uint64_t, OrderHandle> map;
+    map.reserve(live_count);
+    auto map_us = run(map,
+        [](auto& m, uint64_t id, OrderHandle o) { m.emplace(id, o); },
+        [](auto& m, uint64_t id) { auto it = m.find(id); return it == m.end() ? kNoOrder : it->second; },
+        [](auto& m, uint64_t id) { m.erase(id); });
+
+    OrderIndex index(live_count);
+    auto index_us = run(index,
+        [](auto& t, uint64_t id, OrderHandle o) { t.Insert(id, o); },
+        [](auto& t, uint64_t id) { return t.Find(id); },
+        [](auto& t, uint64_t id) { t.Erase(id); });
+
+    EXPECT_EQ(index.Size(), live_count);
+    EXPECT_LT(index_us, 2000000);  // Less than 2 seconds
+    std::cout << operations << " add/find/cancel steps: std::unordered_map " << map_us
+              << " us, OrderIndex " << index_us << " us" << std::endl;
+}
@@ -0,0 +1,264 @@
+#include <gtest/gtest.h>
+#include <set>
+#include <stdexcept>
+#include <vector>
+
+#include "AllocationFailure.h"
+#include "OrderPool.h"
+#include "OrderBook.h"
+#include "Order.h"
+
+class OrderPoolTest : public ::testing::Test {
+protected:
+    static Order MakeOrder(uint64_t order_id) {
+        return Order{order_id, 10000, 100, true};
+    }
+};
+
+// Test that the initial capacity is allocated up front
+TEST_F(OrderPoolTest, InitialCapacity) {
+    OrderPoolConfig config;
+    config.initial_capacity = 64;
+    OrderPool pool(config);
+
+    EXPECT_EQ(pool.Capacity(), 64);
+    EXPECT_EQ(pool.Available(), 64);
+    EXPECT_EQ(pool.InUse(), 0);
+    EXPECT_EQ(pool.ChunkCount(), 1);
+}
+
+// Test that Acquire copies the initial values into the pooled order
+TEST_F(OrderPoolTest, AcquireInitialisesOrder) {
+    OrderPool pool;
+    OrderHandle handle = pool.Acquire(MakeOrder(42), OrderDetails{7, 1, 2});
+
+    ASSERT_NE(handle, kNoOrder);
+    const Order& order = pool.Get(handle);
+    EXPECT_EQ(order.order_id, 42);
+    EXPECT_EQ(order.quantity, 100);
+    EXPECT_EQ(order.price, 10000);
+    EXPECT_FALSE(order.IsResting());
+    EXPECT_EQ(order.prev_in_level, kNoOrder);
+    EXPECT_EQ(order.next_in_level, kNoOrder);
+    EXPECT_EQ(pool.Details(handle).user_id, 7);
+    EXPECT_EQ(pool.InUse(), 1);
+}
+
+// Test that two orders share each cache line
+TEST_F(OrderPoolTest, TwoOrdersPerCacheLine) {
+    OrderPool pool;
+    OrderHandle first = pool.Acquire(MakeOrder(1));
+    OrderHandle second = pool.Acquire(MakeOrder(2));
+
+    const auto first_address = reinterpret_cast<uintptr_t>(&pool.Get(first));
+    EXPECT_EQ(first_address % 64, 0u);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(&pool.Get(second)), first_address + 32);
+}
+
+// Test that released orders are handed out again before the pool grows
+TEST_F(OrderPoolTest, ReleasedOrdersAreRecycled) {
+    OrderPoolConfig config;
+    config.initial_capacity = 4;
+    OrderPool pool(config);
+
+    OrderHandle first = pool.Acquire(MakeOrder(1));
+    pool.Release(first);
+    OrderHandle second = pool.Acquire(MakeOrder(2));
+
+    EXPECT_EQ(first, second);  // LIFO reuse
+    EXPECT_EQ(pool.Get(second).order_id, 2);
+    EXPECT_EQ(pool.Capacity(), 4);
+}
+
+// Test growth when the pool is exhausted
+TEST_F(OrderPoolTest, GrowsWhenExhausted) {
+    OrderPoolConfig config;
+    config.initial_capacity = 8;
+    config.growth_factor = 2.0;
+    config.min_growth = 1;
+    OrderPool pool(config);
+
+    std::set<OrderHandle> orders;
+    for (uint64_t i = 0; i < 9; ++i) {
+        orders.insert(pool.Acquire(MakeOrder(i)));
+    }
+
+    EXPECT_EQ(orders.size(), 9);       // All distinct
+    EXPECT_EQ(pool.Capacity(), 16);    // Doubled once
+    EXPECT_EQ(pool.ChunkCount(), 2);
+    EXPECT_EQ(pool.InUse(), 9);
+}
+
+// Test that a growth factor of 1.0 still grows geometrically, so the 255
+// addressable chunks cannot run out after 255 * min_growth orders
+TEST_F(OrderPoolTest, UnitGrowthFactorStillGrowsGeometrically) {
+    OrderPoolConfig config;
+    config.initial_capacity = 0;
+    config.growth_factor = 1.0;
+    config.min_growth = 1;
+    OrderPool pool(config);
+
+    for (uint64_t i = 0; i < 100000; ++i) {
+        ASSERT_NE(pool.TryAcquire(MakeOrder(i)), kNoOrder);
+    }
+    EXPECT_EQ(pool.InUse(), 100000);
+    EXPECT_LT(pool.ChunkCount(), 100);
+}
+
+// Test that a grow that cannot happen leaves the pool usable and unchanged
+TEST_F(OrderPoolTest, FailedGrowLeavesPoolUnchanged) {
+    OrderPoolConfig config;
+    config.initial_capacity = 2;
+    OrderPool pool(config);
+    OrderHandle first = pool.Acquire(MakeOrder(1));
+    pool.Acquire(MakeOrder(2));
+
+    // More than 32-bit handles can address
+    EXPECT_THROW(pool.Reserve(size_t{1} << 33), std::length_error);
+    {
+        ScopedAllocationFailure failure;
+        EXPECT_EQ(pool.TryAcquire(MakeOrder(3)), kNoOrder);
+        EXPECT_THROW(pool.Acquire(MakeOrder(3)), std::bad_alloc);
+    }
+    EXPECT_EQ(pool.Capacity(), 2);
+    EXPECT_EQ(pool.ChunkCount(), 1);
+    EXPECT_EQ(pool.InUse(), 2);
+
+    pool.Release(first);
+    EXPECT_EQ(pool.TryAcquire(MakeOrder(4)), first);
+    EXPECT_NE(pool.TryAcquire(MakeOrder(5)), kNoOrder);
+    EXPECT_EQ(pool.ChunkCount(), 2);
+}
+
+// Test that a book whose pool cannot grow rejects the add instead of terminating
+TEST_F(OrderPoolTest, BookRejectsAddWhenPoolCannotGrow) {
+    OrderBookConfig config;
+    config.order_pool.initial_capacity = 1;
+    OrderBook book(config);
+    book.AddOrder(1, 1, true, 10, 10000);
+
+    OrderResult result;
+    {
+        ScopedAllocationFailure failure;
+        result = book.TryAddOrder(2, 1, true, 10, 9900, 0, 0);
+    }
+    EXPECT_EQ(result.status, OrderStatus::CapacityExhausted);
+    EXPECT_EQ(book.GetTotalBidVolume(), 10);
+    EXPECT_EQ(book.TryCancelOrder(2).status, OrderStatus::OrderNotFound);
+    EXPECT_TRUE(book.TryAddOrder(2, 1, true, 10, 9900, 0, 0).Ok());
+}
+
+// Test that existing orders keep their handle and address when the pool grows
+TEST_F(OrderPoolTest, HandlesStableAcrossGrowth) {
+    OrderPoolConfig config;
+    config.initial_capacity = 2;
+    config.min_growth = 2;
+    OrderPool pool(config);
+
+    OrderHandle first = pool.Acquire(MakeOrder(1));
+    const Order* address = &pool.Get(first);
+    for (uint64_t i = 2; i < 100; ++i) {
+        pool.Acquire(MakeOrder(i));
+    }
+
+    EXPECT_EQ(&pool.Get(first), address);
+    EXPECT_EQ(pool.Get(first).order_id, 1);
+    EXPECT_GT(pool.ChunkCount(), 1);
+}
+
+// Test that each order's details follow it across growth and recycling
+TEST_F(OrderPoolTest, DetailsFollowTheirOrder) {
+    OrderPoolConfig config;
+    config.initial_capacity = 2;
+    config.min_growth = 2;
+    OrderPool pool(config);
+
+    std::vector<OrderHandle> orders;
+    for (uint64_t i = 0; i < 50; ++i) {
+        orders.push_back(pool.Acquire(MakeOrder(i), OrderDetails{i + 500, i, i + 1000}));
+    }
+    for (uint64_t i = 0; i < orders.size(); ++i) {
+        EXPECT_EQ(pool.Get(orders[i]).order_id, i);
+        EXPECT_EQ(pool.Details(orders[i]).user_id, i + 500);
+        EXPECT_EQ(pool.Details(orders[i]).ts_received, i);
+        EXPECT_EQ(pool.Details(orders[i]).ts_executed, i + 1000);
+    }
+
+    // A recycled order keeps its handle and takes the new details
+    pool.Release(orders[7]);
+    OrderHandle recycled = pool.Acquire(MakeOrder(77), OrderDetails{3, 7, 8});
+    EXPECT_EQ(recycled, orders[7]);
+    EXPECT_EQ(pool.Details(recycled).user_id, 3);
+    EXPECT_EQ(pool.Details(recycled).ts_executed, 8);
+}
+
+// Test Reserve
+TEST_F(OrderPoolTest, Reserve) {
+    OrderPoolConfig config;
+    config.initial_capacity = 0;
+    OrderPool pool(config);
+    EXPECT_EQ(pool.Capacity(), 0);
+
+    pool.Reserve(500);
+    EXPECT_EQ(pool.Capacity(), 500);
+
+    // Reserving less than the current capacity is a no-op
+    pool.Reserve(100);
+    EXPECT_EQ(pool.Capacity(), 500);
+}
+
+// Test that orders left in a chunk when Reserve adds another are still handed out
+TEST_F(OrderPoolTest, ReserveKeepsPartlyUsedChunk) {
+    OrderPoolConfig config;
+    config.initial_capacity = 4;
+    OrderPool pool(config);
+
+    OrderHandle first = pool.Acquire(MakeOrder(0));
+    pool.Reserve(10);
+    EXPECT_EQ(pool.Available(), 9);
+
+    std::set<OrderHandle> orders{first};
+    for (uint64_t i = 1; i < 10; ++i) {
+        OrderHandle order = pool.Acquire(MakeOrder(i), OrderDetails{0, i, i});
+        orders.insert(order);
+        EXPECT_EQ(pool.Details(order).ts_received, i);
+    }
+    EXPECT_EQ(orders.size(), 10);
+    EXPECT_EQ(pool.Available(), 0);
+    EXPECT_EQ(pool.ChunkCount(), 2);
+}
+
+// Test invalid configuration and release
+TEST_F(OrderPoolTest, InvalidArguments) {
+    OrderPoolConfig config;
+    config.growth_factor = 0.5;
+    EXPECT_THROW(OrderPool pool(config), std::invalid_argument);
+    config.growth_factor = 2.0;
+    config.initial_capacity = size_t{1} << 33;
+    EXPECT_THROW(OrderPool pool(config), std::invalid_argument);
+
+    OrderPool pool;
+    EXPECT_THROW(pool.Release(kNoOrder), std::invalid_argument);
+}
+
+// Test that a warm book does not grow its pool on the add/cancel/fill path
+TEST_F(OrderPoolTest, WarmBookDoesNotGrow) {
+    OrderBookConfig config;
+    config.order_pool.initial_capacity = 256;
+    OrderBook book(config);
+
+    for (int round = 0; round < 10; ++round) {
+        // Rest 100 bids, fill half with one sell, cancel the rest
+        for (uint64_t i = 0; i < 100; ++i) {
+            book.AddOrder(round * 1000 + i + 1, 1, true, 10, 10000 - i);
+        }
+        book.AddOrder(round * 1000 + 500, 2, false, 500, 9951);
+        for (uint64_t i = 50; i < 100; ++i) {
+            book.CancelOrder(round * 1000 + i + 1);
+        }
+        EXPECT_EQ(book.GetOrderPool().InUse(), 0);
+    }
+
+    EXPECT_EQ(book.GetOrderPool().Capacity(), 256);
+    EXPECT_EQ(book.GetOrderPool().ChunkCount(), 1);
+}
@@ -0,0 +1,251 @@
+#include <gtest/gtest.h>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "FlatPriceLadder.h"
+#include "MapPriceLadder.h"
+#include "OrderBook.h"
+#include "Order.h"
+#include "OrderPool.h"
+#include "PriceLevel.h"
+
+class FlatPriceLadderTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        config.type = PriceLadderType::Flat;
+        config.tick_size = 25;
+        config.initial_window_ticks = 16;
+        config.max_window_ticks = 1024;
+    }
+
+    OrderHandle MakeOrder(uint64_t order_id, uint64_t price) {
+        orders.push_back(pool.Acquire(Order{order_id, price, 10, true}));
+        return orders.back();
+    }
+
+    PriceLadderConfig config;
+    OrderPool pool;
+    std::vector<OrderHandle> orders;
+};
+
+// Test tick grid validation
+TEST_F(FlatPriceLadderTest, AcceptsOnlyTickMultiples) {
+    FlatPriceLadder<BookSide::Bid> ladder(config);
+    EXPECT_TRUE(ladder.Accepts(500000));
+    EXPECT_TRUE(ladder.Accepts(500025));
+    EXPECT_FALSE(ladder.Accepts(500010));
+    EXPECT_THROW(ladder.GetOrCreate(500010), std::out_of_range);
+}
+
+// Test best level on each side
+TEST_F(FlatPriceLadderTest, BestLevelPerSide) {
+    FlatPriceLadder<BookSide::Bid> bids(config);
+    FlatPriceLadder<BookSide::Ask> asks(config);
+
+    for (uint64_t price : {500000, 500050, 499975}) {
+        bids.GetOrCreate(price).AddOrder(pool, MakeOrder(price, price));
+        asks.GetOrCreate(price).AddOrder(pool, MakeOrder(price + 1, price));
+    }
+
+    EXPECT_EQ(bids.LevelCount(), 3);
+    EXPECT_EQ(bids.Best()->GetPrice(), 500050);   // Highest bid
+    EXPECT_EQ(asks.Best()->GetPrice(), 499975);   // Lowest ask
+}
+
+// Test walking from best to worse skips empty ticks
+TEST_F(FlatPriceLadderTest, NextWorseSkipsEmptyTicks) {
+    FlatPriceLadder<BookSide::Bid> bids(config);
+    for (uint64_t price : {500100, 500000, 499900}) {
+        bids.GetOrCreate(price).AddOrder(pool, MakeOrder(price, price));
+    }
+
+    std::vector<uint64_t> prices;
+    for (PriceLevel* level = bids.Best(); level; level = bids.NextWorse(level->GetPrice())) {
+        prices.push_back(level->GetPrice());
+    }
+    EXPECT_EQ(prices, (std::vector<uint64_t>{500100, 500000, 499900}));
+
+    // Off-grid prices are handled too
+    EXPECT_EQ(bids.NextWorse(500010)->GetPrice(), 500000);
+}
+
+// Test erasing the best level exposes the next one
+TEST_F(FlatPriceLadderTest, EraseBestLevel) {
+    FlatPriceLadder<BookSide::Ask> asks(config);
+    asks.GetOrCreate(500000).AddOrder(pool, MakeOrder(1, 500000));
+    asks.GetOrCreate(500075).AddOrder(pool, MakeOrder(2, 500075));
+
+    asks.Find(500000)->RemoveOrder(pool, orders[0]);
+    asks.Erase(500000);
+
+    EXPECT_EQ(asks.Find(500000), nullptr);
+    EXPECT_EQ(asks.LevelCount(), 1);
+    EXPECT_EQ(asks.Best()->GetPrice(), 500075);
+}
+
+// Test that a price outside the window re-centers and keeps orders attached
+TEST_F(FlatPriceLadderTest, RecenterMovesLevels) {
+    FlatPriceLadder<BookSide::Bid> bids(config);
+    OrderHandle low_order = MakeOrder(1, 500000);
+    bids.GetOrCreate(500000).AddOrder(pool, low_order);
+
+    // 100 ticks away from a 16-tick window
+    OrderHandle high_order = MakeOrder(2, 502500);
+    bids.GetOrCreate(502500).AddOrder(pool, high_order);
+
+    EXPECT_GE(bids.GetWindowTicks(), 101);
+    EXPECT_EQ(bids.LevelCount(), 2);
+    EXPECT_EQ(bids.Best()->GetPrice(), 502500);
+    // The moved level kept its queue
+    EXPECT_EQ(bids.Find(500000)->GetTopOrder(), low_order);
+    EXPECT_EQ(bids.Find(500000)->GetTotalVolume(), 10);
+}
+
+// Test that a resting order's level handle leads back to its level on both
+// backends, across a re-center, and that erased levels' handles are reused
+TEST_F(FlatPriceLadderTest, OrdersCarryTheirLevelHandle) {
+    FlatPriceLadder<BookSide::Bid> flat(config);
+    MapPriceLadder<BookSide::Bid> map;
+    for (PriceLadder* ladder : {static_cast<PriceLadder*>(&flat), static_cast<PriceLadder*>(&map)}) {
+        OrderHandle low_order = MakeOrder(1, 500000);
+        ladder->GetOrCreate(500000).AddOrder(pool, low_order);
+        OrderHandle high_order = MakeOrder(2, 502500);
+        ladder->GetOrCreate(502500).AddOrder(pool, high_order);
+
+        const Order& low = pool.Get(low_order);
+        ASSERT_TRUE(low.IsResting());
+        EXPECT_EQ(&ladder->Level(low.Level()), ladder->Find(500000));
+        EXPECT_EQ(ladder->Level(pool.Get(high_order).Level()).GetPrice(), 502500);
+
+        const LevelHandle freed = low.Level();
+        ladder->Find(500000)->RemoveOrder(pool, low_order);
+        EXPECT_FALSE(low.IsResting());
+        ladder->Erase(500000);
+        EXPECT_EQ(ladder->GetOrCreate(499975).GetHandle(), freed);
+    }
+}
+
+// Test that prices spread wider than max_window_ticks are refused
+TEST_F(FlatPriceLadderTest, RejectsSpanBeyondMaxWindow) {
+    FlatPriceLadder<BookSide::Ask> asks(config);
+    asks.GetOrCreate(500000).AddOrder(pool, MakeOrder(1, 500000));
+
+    EXPECT_TRUE(asks.Accepts(500000 + 1023 * 25));
+    EXPECT_FALSE(asks.Accepts(500000 + 1024 * 25));
+}
+
+// Test that an add priced beyond the window still trades; only a remainder
+// that would have to rest out there is refused
+TEST_F(FlatPriceLadderTest, MarketableOrderBeyondWindowStillTrades) {
+    OrderBookConfig book_config;
+    book_config.price_ladder = config;
+    OrderBook book(book_config);
+    book.AddOrder(1, 1, true, 10, 500000);
+    book.AddOrder(2, 2, false, 30, 500025);
+    const uint64_t far_price = 500000 + 2000 * 25;
+    // Passive and out of range: nowhere to rest, so refused up front
+    EXPECT_EQ(book.TryAddOrder(9, 3, true, 1, 500000 - 2000 * 25, 0, 0).status, OrderStatus::PriceOffGrid);
+
+    OrderResult result = book.TryAddOrder(3, 3, true, 20, far_price, 0, 0);
+    EXPECT_TRUE(result.Ok());
+    EXPECT_EQ(result.state, OrderState::Filled);
+    EXPECT_EQ(result.filled_quantity, 20);
+
+    result = book.TryAddOrder(4, 3, true, 25, far_price, 0, 0);
+    EXPECT_EQ(result.status, OrderStatus::PriceOffGrid);
+    EXPECT_EQ(result.state, OrderState::Cancelled);
+    EXPECT_EQ(result.filled_quantity, 10);
+    EXPECT_EQ(book.GetTotalAskVolume(), 0);
+    EXPECT_EQ(book.GetTotalBidVolume(), 10);
+    EXPECT_EQ(book.GetBestBid(), 500000);
+    EXPECT_EQ(book.TryCancelOrder(4).status, OrderStatus::OrderNotFound);
+
+    // Off the tick grid is refused before matching, even when marketable
+    book.AddOrder(5, 2, false, 30, 500025);
+    result = book.TryAddOrder(6, 3, true, 10, 500035, 0, 0);
+    EXPECT_EQ(result.status, OrderStatus::PriceOffGrid);
+    EXPECT_EQ(result.filled_quantity, 0);
+    EXPECT_EQ(book.GetTotalAskVolume(), 30);
+}
+
+// Test a book using the flat backend
+TEST_F(FlatPriceLadderTest, FlatOrderBookBasics) {
+    OrderBookConfig book_config;
+    book_config.price_ladder = config;
+    OrderBook book(book_config);
+
+    book.AddOrder(1, 1, true, 100, 500000);
+    book.AddOrder(2, 1, true, 50, 499975);
+    book.AddOrder(3, 2, false, 70, 500050);
+    EXPECT_EQ(book.GetBestBid(), 500000);
+    EXPECT_EQ(book.GetBestAsk(), 500050);
+
+    // Off-grid prices are rejected before touching the book
+    EXPECT_THROW(book.AddOrder(4, 1, true, 10, 500010), std::invalid_argument);
+
+    // Sweep both bid levels
+    book.AddOrder(5, 3, false, 150, 499975);
+    EXPECT_EQ(book.GetBestBid(), 0);
+    EXPECT_EQ(book.GetTotalBidVolume(), 0);
+    EXPECT_EQ(book.GetTotalAskVolume(), 70);
+}
+
+// Test that the map and flat backends agree on a random add/modify/cancel stream
+TEST(PriceLadderBackendTest, FlatMatchesMapBackend) {
+    OrderBookConfig flat_config;
+    flat_config.price_ladder.type = PriceLadderType::Flat;
+    flat_config.price_ladder.tick_size = 25;
+    flat_config.price_ladder.initial_window_ticks = 64;
+    OrderBook map_book;
+    OrderBook flat_book(flat_config);
+
+    std::mt19937 gen(12345);
+    std::uniform_int_distribution<int> tick_dist(-60, 60);
+    std::uniform_int_distribution<int> quantity_dist(1, 20);
+    std::uniform_int_distribution<int> action_dist(0, 9);
+    std::vector<uint64_t> live_ids;
+
+    for (uint64_t id = 1; id <= 20000; ++id) {
+        // Let the mid drift so the flat ladder has to re-center
+        int64_t mid_ticks = 200000 + static_cast<int64_t>(id / 500);
+        int action = action_dist(gen);
+
+        if (action < 7 || live_ids.empty()) {
+            bool is_buy = (id % 2) == 0;
+            uint64_t price = static_cast<uint64_t>(mid_ticks + tick_dist(gen)) * 25;
+            uint64_t quantity = quantity_dist(gen);
+            map_book.AddOrder(id, 1, is_buy, quantity, price);
+            flat_book.AddOrder(id, 1, is_buy, quantity, price);
+            live_ids.push_back(id);
+        } else if (action == 7) {
+            // Modify: size change in place, price move, or a crossing reprice
+            uint64_t order_id = live_ids[gen() % live_ids.size()];
+            uint64_t price = static_cast<uint64_t>(mid_ticks + tick_dist(gen)) * 25;
+            uint64_t quantity = quantity_dist(gen);
+            OrderResult map_result = map_book.TryModifyOrder(order_id, quantity, price);
+            OrderResult flat_result = flat_book.TryModifyOrder(order_id, quantity, price);
+            ASSERT_EQ(map_result.status, flat_result.status);
+            ASSERT_EQ(map_result.filled_quantity, flat_result.filled_quantity);
+        } else {
+            size_t index = gen() % live_ids.size();
+            uint64_t order_id = live_ids[index];
+            live_ids[index] = live_ids.back();
+            live_ids.pop_back();
+
+            bool map_threw = false;
+            bool flat_threw = false;
+            try { map_book.CancelOrder(order_id); } catch (const std::runtime_error&) { map_threw = true; }
+            try { flat_book.CancelOrder(order_id); } catch (const std::runtime_error&) { flat_threw = true; }
+            ASSERT_EQ(map_threw, flat_threw);
+        }
+
+        ASSERT_EQ(map_book.GetBestBid(), flat_book.GetBestBid()) << "at order " << id;
+        ASSERT_EQ(map_book.GetBestAsk(), flat_book.GetBestAsk()) << "at order " << id;
+        ASSERT_EQ(map_book.GetBestBidVolume(), flat_book.GetBestBidVolume()) << "at order " << id;
+        ASSERT_EQ(map_book.GetBestAskVolume(), flat_book.GetBestAskVolume()) << "at order " << id;
+        ASSERT_EQ(map_book.GetTotalBidVolume(), flat_book.GetTotalBidVolume()) << "at order " << id;
+    }
+
+    EXPECT_EQ(map_book.GetTotalAskVolume(), flat_book.GetTotalAskVolume());
+}
@@ -1,301 +1,360 @@
 #include <gtest/gtest.h>
 #include <memory>
+#include <vector>
+#include <chrono>
+#include <iostream>
 
 #include "PriceLevel.h"
 #include "Order.h"
+#include "OrderPool.h"
 #include "Trade.h"
 
 class PriceLevelTest : public ::testing::Test {
 protected:
     void SetUp() override {
         price_level = std::make_unique<PriceLevel>();
-        
-        // Create test orders
-        order1 = std::make_unique<Order>();
-        order1->order_id = 1001;
-        order1->user_id = 1;
-        order1->is_buy_side = true;
-        order1->quantity = 100;
-        order1->price = 10000;
-        order1->ts_received = 1000;
-        order1->ts_executed = 1000;
-        order1->parent_price_level = nullptr;
-        order1->position_in_list = {}; // Will be set when added to price level
-        
-        order2 = std::make_unique<Order>();
-        order2->order_id = 1002;
-        order2->user_id = 2;
-        order2->is_buy_side = true;
-        order2->quantity = 150;
-        order2->price = 10000;
-        order2->ts_received = 2000;
-        order2->ts_executed = 2000;
-        order2->parent_price_level = nullptr;
-        order2->position_in_list = {}; // Will be set when added to price level
-        
-        order3 = std::make_unique<Order>();
-        order3->order_id = 1003;
-        order3->user_id = 3;
-        order3->is_buy_side = true;
-        order3->quantity = 200;
-        order3->price = 10000;
-        order3->ts_received = 3000;
-        order3->ts_executed = 3000;
-        order3->parent_price_level = nullptr;
-        order3->position_in_list = {}; // Will be set when added to price level
+
+        // Create test orders; links are set when they are added to the price level
+        order1 = pool.Acquire(Order{1001, 10000, 100, true}, OrderDetails{1, 0, 0});
+        order2 = pool.Acquire(Order{1002, 10000, 150, true}, OrderDetails{2, 0, 0});
+        order3 = pool.Acquire(Order{1003, 10000, 200, true}, OrderDetails{3, 0, 0});
     }
 
-    void TearDown() override {
-        price_level.reset();
-        order1.reset();
-        order2.reset();
-        order3.reset();
+    // Incoming order on the opposite side
+    OrderHandle MakeIncoming(uint32_t quantity) {
+        return pool.Acquire(Order{9999, 10000, quantity, false}, OrderDetails{99, 0, 0});
     }
 
+    Order& Get(OrderHandle handle) { return pool.Get(handle); }
+
+    OrderPool pool;
     std::unique_ptr<PriceLevel> price_level;
-    std::unique_ptr<Order> order1;
-    std::unique_ptr<Order> order2;
-    std::unique_ptr<Order> order3;
+    OrderHandle order1 = kNoOrder;
+    OrderHandle order2 = kNoOrder;
+    OrderHandle order3 = kNoOrder;
 };
 
 // Test initial state of price level
 TEST_F(PriceLevelTest, InitialState) {
     EXPECT_EQ(price_level->GetTotalVolume(), 0);
     EXPECT_EQ(price_level->GetPrice(), 0);
-    EXPECT_EQ(price_level->GetTopOrder(), nullptr);
+    EXPECT_EQ(price_level->GetTopOrder(), kNoOrder);
 }
 
 // Test adding a single order
 TEST_F(PriceLevelTest, AddSingleOrder) {
-    price_level->AddOrder(order1.get());
-    
+    price_level->AddOrder(pool, order1);
+
     EXPECT_EQ(price_level->GetTotalVolume(), 100);
-    EXPECT_EQ(price_level->GetTopOrder(), order1.get());
-    EXPECT_EQ(order1->parent_price_level, price_level.get());
+    EXPECT_EQ(price_level->GetTopOrder(), order1);
+    EXPECT_TRUE(Get(order1).IsResting());
 }
 
 // Test adding multiple orders (FIFO queue)
 TEST_F(PriceLevelTest, AddMultipleOrders) {
-    price_level->AddOrder(order1.get());
-    price_level->AddOrder(order2.get());
-    price_level->AddOrder(order3.get());
-    
+    price_level->AddOrder(pool, order1);
+    price_level->AddOrder(pool, order2);
+    price_level->AddOrder(pool, order3);
+
     EXPECT_EQ(price_level->GetTotalVolume(), 450);  // 100 + 150 + 200
-    EXPECT_EQ(price_level->GetTopOrder(), order1.get());  // First order should be on top
-    
-    // Verify all orders have correct parent
-    EXPECT_EQ(order1->parent_price_level, price_level.get());
-    EXPECT_EQ(order2->parent_price_level, price_level.get());
-    EXPECT_EQ(order3->parent_price_level, price_level.get());
+    EXPECT_EQ(price_level->GetTopOrder(), order1);  // First order should be on top
+
+    // Verify all orders are linked in arrival order
+    EXPECT_EQ(Get(order1).next_in_level, order2);
+    EXPECT_EQ(Get(order2).next_in_level, order3);
+    EXPECT_EQ(Get(order3).prev_in_level, order2);
+    EXPECT_TRUE(Get(order3).IsResting());
 }
 
 // Test removing an order
 TEST_F(PriceLevelTest, RemoveOrder) {
-    price_level->AddOrder(order1.get());
-    price_level->AddOrder(order2.get());
-    price_level->AddOrder(order3.get());
-    
+    price_level->AddOrder(pool, order1);
+    price_level->AddOrder(pool, order2);
+    price_level->AddOrder(pool, order3);
+
     EXPECT_EQ(price_level->GetTotalVolume(), 450);
-    
+
     // Remove middle order
-    price_level->RemoveOrder(order2.get());
-    
+    price_level->RemoveOrder(pool, order2);
+
     EXPECT_EQ(price_level->GetTotalVolume(), 300);  // 100 + 200
-    EXPECT_EQ(price_level->GetTopOrder(), order1.get());  // First order still on top
+    EXPECT_EQ(price_level->GetTopOrder(), order1);  // First order still on top
+}
+
+// Test that removing from the middle keeps FIFO order of the rest
+TEST_F(PriceLevelTest, RemoveMiddleOrderKeepsFIFO) {
+    price_level->AddOrder(pool, order1);
+    price_level->AddOrder(pool, order2);
+    price_level->AddOrder(pool, order3);
+
+    price_level->RemoveOrder(pool, order2);
+
+    EXPECT_EQ(price_level->GetOrderCount(), 2);
+    EXPECT_EQ(Get(order1).next_in_level, order3);
+    EXPECT_EQ(Get(order3).prev_in_level, order1);
+    EXPECT_FALSE(Get(order2).IsResting());
+    EXPECT_EQ(Get(order2).prev_in_level, kNoOrder);
+    EXPECT_EQ(Get(order2).next_in_level, kNoOrder);
+
+    // Removing the head then makes order3 the only order
+    price_level->RemoveOrder(pool, order1);
+    EXPECT_EQ(price_level->GetTopOrder(), order3);
+    EXPECT_EQ(Get(order3).prev_in_level, kNoOrder);
+    EXPECT_EQ(Get(order3).next_in_level, kNoOrder);
 }
 
 // Test removing the top order
 TEST_F(PriceLevelTest, RemoveTopOrder) {
-    price_level->AddOrder(order1.get());
-    price_level->AddOrder(order2.get());
-    price_level->AddOrder(order3.get());
-    
+    price_level->AddOrder(pool, order1);
+    price_level->AddOrder(pool, order2);
+    price_level->AddOrder(pool, order3);
+
     // Remove the top order
-    price_level->RemoveOrder(order1.get());
-    
+    price_level->RemoveOrder(pool, order1);
+
     EXPECT_EQ(price_level->GetTotalVolume(), 350);  // 150 + 200
-    EXPECT_EQ(price_level->GetTopOrder(), order2.get());  // Second order becomes top
+    EXPECT_EQ(price_level->GetTopOrder(), order2);  // Second order becomes top
 }
 
 // Test removing all orders
 TEST_F(PriceLevelTest, RemoveAllOrders) {
-    price_level->AddOrder(order1.get());
-    price_level->AddOrder(order2.get());
-    price_level->AddOrder(order3.get());
-    
-    price_level->RemoveOrder(order1.get());
-    price_level->RemoveOrder(order2.get());
-    price_level->RemoveOrder(order3.get());
-    
+    price_level->AddOrder(pool, order1);
+    price_level->AddOrder(pool, order2);
+    price_level->AddOrder(pool, order3);
+
+    price_level->RemoveOrder(pool, order1);
+    price_level->RemoveOrder(pool, order2);
+    price_level->RemoveOrder(pool, order3);
+
     EXPECT_EQ(price_level->GetTotalVolume(), 0);
-    EXPECT_EQ(price_level->GetTopOrder(), nullptr);
+    EXPECT_EQ(price_level->GetTopOrder(), kNoOrder);
 }
 
 // Test partial fill of top order
 TEST_F(PriceLevelTest, PartialFillTopOrder) {
-    price_level->AddOrder(order1.get());  // 100 quantity
-    price_level->AddOrder(order2.get());  // 150 quantity
-    
+    price_level->AddOrder(pool, order1);  // 100 quantity
+    price_level->AddOrder(pool, order2);  // 150 quantity
+
     // Create incoming order for partial fill
-    Order incoming_order;
-    incoming_order.order_id = 9999;
-    incoming_order.user_id = 99;
-    incoming_order.is_buy_side = false;  // Opposite side
-    incoming_order.quantity = 50;       // Partial fill
-    incoming_order.price = 10000;
-    incoming_order.ts_received = 5000;
-    incoming_order.ts_executed = 5000;
-    
-    std::vector<Trade> trades = price_level->FillOrder(&incoming_order, 50);
-    
+    OrderHandle incoming_order = MakeIncoming(50);
+
+    std::vector<Trade> trades = price_level->FillOrder(pool, incoming_order, 50);
+
     // Should generate one trade
     EXPECT_EQ(trades.size(), 1);
     if (!trades.empty()) {
         EXPECT_EQ(trades[0].quantity, 50);
         EXPECT_EQ(trades[0].price, 10000);
-        EXPECT_EQ(trades[0].aggressor_order_id, incoming_order.order_id);
-        EXPECT_EQ(trades[0].resting_order_id, order1->order_id);
+        EXPECT_EQ(trades[0].aggressor_order_id, Get(incoming_order).order_id);
+        EXPECT_EQ(trades[0].resting_order_id, Get(order1).order_id);
+        // Both users come from the pool's cold array
+        EXPECT_EQ(trades[0].aggressor_user_id, 99);
+        EXPECT_EQ(trades[0].resting_user_id, 1);
     }
-    
+
     // Top order should have reduced quantity
-    EXPECT_EQ(order1->quantity, 50);  // 100 - 50
+    EXPECT_EQ(Get(order1).quantity, 50);  // 100 - 50
     EXPECT_EQ(price_level->GetTotalVolume(), 200);  // 50 + 150
-    EXPECT_EQ(price_level->GetTopOrder(), order1.get());  // Same order still on top
+    EXPECT_EQ(price_level->GetTopOrder(), order1);  // Same order still on top
 }
 
 // Test complete fill of top order
 TEST_F(PriceLevelTest, CompleteFillTopOrder) {
-    price_level->AddOrder(order1.get());  // 100 quantity
-    price_level->AddOrder(order2.get());  // 150 quantity
-    
+    price_level->AddOrder(pool, order1);  // 100 quantity
+    price_level->AddOrder(pool, order2);  // 150 quantity
+
     // Create incoming order for complete fill of top order
-    Order incoming_order;
-    incoming_order.order_id = 9999;
-    incoming_order.user_id = 99;
-    incoming_order.is_buy_side = false;
-    incoming_order.quantity = 100;
-    incoming_order.price = 10000;
-    incoming_order.ts_received = 5000;
-    incoming_order.ts_executed = 5000;
-    
-    std::vector<Trade> trades = price_level->FillOrder(&incoming_order, 100);
-    
+    OrderHandle incoming_order = MakeIncoming(100);
+
+    std::vector<Trade> trades = price_level->FillOrder(pool, incoming_order, 100);
+
     // Should generate one trade
     EXPECT_EQ(trades.size(), 1);
     if (!trades.empty()) {
         EXPECT_EQ(trades[0].quantity, 100);
-        EXPECT_EQ(trades[0].aggressor_order_id, incoming_order.order_id);
-        EXPECT_EQ(trades[0].resting_order_id, order1->order_id);
+        EXPECT_EQ(trades[0].aggressor_order_id, Get(incoming_order).order_id);
+        EXPECT_EQ(trades[0].resting_order_id, Get(order1).order_id);
     }
-    
+
     // Top order should be completely filled and removed
     EXPECT_EQ(price_level->GetTotalVolume(), 150);  // Only order2 remains
-    EXPECT_EQ(price_level->GetTopOrder(), order2.get());  // order2 becomes top
+    EXPECT_EQ(price_level->GetTopOrder(), order2);  // order2 becomes top
 }
 
 // Test fill quantity larger than top order
 TEST_F(PriceLevelTest, FillQuantityLargerThanTopOrder) {
-    price_level->AddOrder(order1.get());  // 100 quantity
-    price_level->AddOrder(order2.get());  // 150 quantity
-    
+    price_level->AddOrder(pool, order1);  // 100 quantity
+    price_level->AddOrder(pool, order2);  // 150 quantity
+
     // Create incoming order that requires multiple fills
-    Order incoming_order;
-    incoming_order.order_id = 9999;
-    incoming_order.user_id = 99;
-    incoming_order.is_buy_side = false;
-    incoming_order.quantity = 200;  // More than first order
-    incoming_order.price = 10000;
-    incoming_order.ts_received = 5000;
-    incoming_order.ts_executed = 5000;
-    
-    std::vector<Trade> trades = price_level->FillOrder(&incoming_order, 200);
-    
+    OrderHandle incoming_order = MakeIncoming(200);  // More than first order
+
+    std::vector<Trade> trades = price_level->FillOrder(pool, incoming_order, 200);
+
     // Should generate two trades
     EXPECT_EQ(trades.size(), 2);
     if (trades.size() >= 2) {
         // First trade: complete fill of order1
         EXPECT_EQ(trades[0].quantity, 100);
-        EXPECT_EQ(trades[0].resting_order_id, order1->order_id);
-        
+        EXPECT_EQ(trades[0].resting_order_id, Get(order1).order_id);
+
         // Second trade: partial fill of order2
         EXPECT_EQ(trades[1].quantity, 100);  // 200 - 100
-        EXPECT_EQ(trades[1].resting_order_id, order2->order_id);
+        EXPECT_EQ(trades[1].resting_order_id, Get(order2).order_id);
+        EXPECT_EQ(trades[1].resting_user_id, 2);
     }
-    
+
     // order2 should have reduced quantity and be on top
-    EXPECT_EQ(order2->quantity, 50);  // 150 - 100
+    EXPECT_EQ(Get(order2).quantity, 50);  // 150 - 100
     EXPECT_EQ(price_level->GetTotalVolume(), 50);
-    EXPECT_EQ(price_level->GetTopOrder(), order2.get());
+    EXPECT_EQ(price_level->GetTopOrder(), order2);
 }
 
 // Test fill when price level becomes empty
 TEST_F(PriceLevelTest, FillUntilEmpty) {
-    price_level->AddOrder(order1.get());  // 100 quantity
-    
-    Order incoming_order;
-    incoming_order.order_id = 9999;
-    incoming_order.user_id = 99;
-    incoming_order.is_buy_side = false;
-    incoming_order.quantity = 100;
-    incoming_order.price = 10000;
-    incoming_order.ts_received = 5000;
-    incoming_order.ts_executed = 5000;
-    
-    std::vector<Trade> trades = price_level->FillOrder(&incoming_order, 100);
-    
+    price_level->AddOrder(pool, order1);  // 100 quantity
+
+    OrderHandle incoming_order = MakeIncoming(100);
+
+    std::vector<Trade> trades = price_level->FillOrder(pool, incoming_order, 100);
+
     EXPECT_EQ(trades.size(), 1);
     EXPECT_EQ(price_level->GetTotalVolume(), 0);
-    EXPECT_EQ(price_level->GetTopOrder(), nullptr);
+    EXPECT_EQ(price_level->GetTopOrder(), kNoOrder);
+}
+
+// Test that the sink overload reports each trade and hands back completed orders
+TEST_F(PriceLevelTest, FillOrderIntoSink) {
+    price_level->AddOrder(pool, order1);  // 100 quantity
+    price_level->AddOrder(pool, order2);  // 150 quantity
+
+    OrderHandle incoming_order = MakeIncoming(120);
+    std::vector<std::pair<uint64_t, uint64_t>> seen;  // {resting id, resting quantity left}
+    std::vector<OrderHandle> completed_orders;
+    uint64_t filled = price_level->FillOrder(pool, incoming_order, 120, [&](const Trade& trade, OrderHandle completed) {
+        const Order& resting = Get(trade.resting_order_id == Get(order1).order_id ? order1 : order2);
+        seen.push_back({trade.resting_order_id, resting.quantity});
+        // A fully filled order is already unlinked when its trade is reported
+        EXPECT_EQ(resting.IsResting(), resting.quantity != 0);
+        if (completed != kNoOrder) completed_orders.push_back(completed);
+    });
+
+    EXPECT_EQ(filled, 120);
+    EXPECT_EQ(seen, (std::vector<std::pair<uint64_t, uint64_t>>{{Get(order1).order_id, 0}, {Get(order2).order_id, 130}}));
+    // Only the fully filled order is handed back for reclaiming
+    EXPECT_EQ(completed_orders, std::vector<OrderHandle>{order1});
+    EXPECT_EQ(price_level->GetTotalVolume(), 130);
+}
+
+// Test that every trade carries the aggressor's details and the supplied execution IDs
+TEST_F(PriceLevelTest, FillOrderStampsTrades) {
+    price_level->AddOrder(pool, order1);  // 100 quantity
+    price_level->AddOrder(pool, order2);  // 150 quantity
+
+    Order incoming_order{9999, 10000, 120, false};
+    uint64_t next_id = 70;
+    std::vector<Trade> trades;
+    price_level->FillOrder(pool, incoming_order, 120, OrderDetails{99, 5000, 6000}, [&] { return next_id++; },
+                           [&](const Trade& trade, OrderHandle) { trades.push_back(trade); });
+
+    ASSERT_EQ(trades.size(), 2);
+    for (size_t i = 0; i < trades.size(); ++i) {
+        EXPECT_EQ(trades[i].execution_id, 70 + i);
+        EXPECT_EQ(trades[i].aggressor_user_id, 99);
+        EXPECT_EQ(trades[i].ts_received, 5000);
+        EXPECT_EQ(trades[i].ts_executed, 6000);
+    }
 }
 
 // Test that orders maintain time priority (FIFO)
 TEST_F(PriceLevelTest, TimePriorityFIFO) {
     // Add orders in chronological order
-    price_level->AddOrder(order1.get());  // ts_received 1000
-    price_level->AddOrder(order2.get());  // ts_received 2000
-    price_level->AddOrder(order3.get());  // ts_received 3000
-    
+    price_level->AddOrder(pool, order1);  // ts_received 1000
+    price_level->AddOrder(pool, order2);  // ts_received 2000
+    price_level->AddOrder(pool, order3);  // ts_received 3000
+
     // Fill part of the level
-    Order incoming_order;
-    incoming_order.order_id = 9999;
-    incoming_order.user_id = 99;
-    incoming_order.is_buy_side = false;
-    incoming_order.quantity = 150;  // Should fill order1 completely and part of order2
-    incoming_order.price = 10000;
-    incoming_order.ts_received = 5000;
-    incoming_order.ts_executed = 5000;
-    
-    std::vector<Trade> trades = price_level->FillOrder(&incoming_order, 150);
-    
+    OrderHandle incoming_order = MakeIncoming(150);  // Should fill order1 completely and part of order2
+
+    std::vector<Trade> trades = price_level->FillOrder(pool, incoming_order, 150);
+
     // Should have two trades in time priority order
     EXPECT_EQ(trades.size(), 2);
     if (trades.size() >= 2) {
         // First trade should be with order1 (earliest ts_received)
-        EXPECT_EQ(trades[0].resting_order_id, order1->order_id);
+        EXPECT_EQ(trades[0].resting_order_id, Get(order1).order_id);
         EXPECT_EQ(trades[0].quantity, 100);
-        
+
         // Second trade should be with order2
-        EXPECT_EQ(trades[1].resting_order_id, order2->order_id);
+        EXPECT_EQ(trades[1].resting_order_id, Get(order2).order_id);
         EXPECT_EQ(trades[1].quantity, 50);
     }
-    
+
     // order2 should be on top with reduced quantity
-    EXPECT_EQ(price_level->GetTopOrder(), order2.get());
-    EXPECT_EQ(order2->quantity, 100);  // 150 - 50
+    EXPECT_EQ(price_level->GetTopOrder(), order2);
+    EXPECT_EQ(Get(order2).quantity, 100);  // 150 - 50
 }
 
-// Test adding order with null pointer
+// Test adding an empty handle
 TEST_F(PriceLevelTest, AddNullOrder) {
     // This should throw an exception
-    EXPECT_THROW(price_level->AddOrder(nullptr), std::invalid_argument);
+    EXPECT_THROW(price_level->AddOrder(pool, kNoOrder), std::invalid_argument);
     EXPECT_EQ(price_level->GetTotalVolume(), 0);
 }
 
 // Test removing order that's not in the level
 TEST_F(PriceLevelTest, RemoveOrderNotInLevel) {
-    price_level->AddOrder(order1.get());
-    
+    price_level->AddOrder(pool, order1);
+
     // Try to remove an order that wasn't added
-    EXPECT_THROW(price_level->RemoveOrder(order2.get()), std::runtime_error);
+    EXPECT_THROW(price_level->RemoveOrder(pool, order2), std::runtime_error);
     EXPECT_EQ(price_level->GetTotalVolume(), 100);  // Should remain unchanged
 }
+
+// Test that a level moves with its queue intact
+TEST_F(PriceLevelTest, MovedLevelKeepsQueue) {
+    price_level->AddOrder(pool, order1);
+    price_level->AddOrder(pool, order2);
+
+    PriceLevel moved(std::move(*price_level));
+    EXPECT_EQ(moved.GetTopOrder(), order1);
+    EXPECT_EQ(moved.GetTotalVolume(), 250);
+    moved.RemoveOrder(pool, order1);
+    EXPECT_EQ(moved.GetTopOrder(), order2);
+}
+
+// Performance test: cancel every order from the middle of a 10k-order level
+TEST_F(PriceLevelTest, CancelFromMiddleOfDeepLevelPerformance) {
+    const int num_orders = 10000;
+    std::vector<OrderHandle> orders(num_orders);
+    for (int i = 0; i < num_orders; ++i) {
+        orders[i] = pool.Acquire(Order{static_cast<uint64_t>(i + 1), 10000, 10, true});
+        price_level->AddOrder(pool, orders[i]);
+    }
+    EXPECT_EQ(price_level->GetOrderCount(), num_orders);
+
+    // Cancel the middle half of the queue, working outwards from the centre
+    const int first = num_orders / 4;
+    const int last = 3 * num_orders / 4;
+
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = num_orders / 2, j = num_orders / 2 + 1; i >= first || j < last; --i, ++j) {
+        if (i >= first) price_level->RemoveOrder(pool, orders[i]);
+        if (j < last) price_level->RemoveOrder(pool, orders[j]);
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+
+    const int cancelled = last - first;
+    EXPECT_EQ(price_level->GetOrderCount(), num_orders - cancelled);
+    EXPECT_EQ(price_level->GetTotalVolume(), static_cast<uint64_t>(num_orders - cancelled) * 10);
+    EXPECT_EQ(price_level->GetTopOrder(), orders[0]);
+    // Queue is still intact across the gap
+    EXPECT_EQ(Get(orders[first - 1]).next_in_level, orders[last]);
+
+    // O(1) cancels: 5k removals should be well under a millisecond on any machine
+    EXPECT_LT(duration.count(), 10000);  // Less than 10ms
+
+    std::cout << "Cancelled " << cancelled << " orders from the middle of a "
+              << num_orders << "-order level in " << duration.count() << " microseconds" << std::endl;
+}
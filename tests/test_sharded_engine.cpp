@@ -0,0 +1,132 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "RecordingClient.h"
+#include "ShardedEngine.h"
+
+// Test that commands reach the right instrument's book on the right shard
+TEST(ShardedEngineTest, RoutesCommandsToInstrumentBooks) {
+    ShardedEngineConfig config;
+    config.num_shards = 2;
+    ShardedEngine engine(config);
+    engine.AssignInstrument(10, 1);
+    EXPECT_EQ(engine.ShardFor(10), 1);
+    EXPECT_EQ(engine.ShardFor(11), 1);
+    EXPECT_EQ(engine.ShardFor(12), 0);
+
+    std::mutex mutex;
+    std::vector<std::thread::id> creating_threads;
+    engine.SetBookCreatedCallback([&](size_t, size_t, uint32_t, const std::shared_ptr<OrderBook>&) {
+        std::lock_guard<std::mutex> lock(mutex);
+        creating_threads.push_back(std::this_thread::get_id());
+    });
+
+    EXPECT_THROW(engine.Submit(10, BookCommand::Cancel(1)), std::runtime_error);
+    engine.Start();
+    EXPECT_THROW(engine.AssignInstrument(12, 1), std::runtime_error);
+
+    // Same order IDs on different instruments must not collide
+    engine.Submit(10, BookCommand::Add(1, 1, true, 10, 100, 0, 0));
+    engine.Submit(12, BookCommand::Add(1, 1, false, 5, 200, 0, 0));
+    engine.Submit(10, BookCommand::Add(2, 2, false, 4, 100, 0, 0));  // Trades against order 1
+    engine.Submit(12, BookCommand::Cancel(99));                        // Rejected
+    engine.Stop();
+
+    ShardStats shard0 = engine.GetShardStats(0);
+    ShardStats shard1 = engine.GetShardStats(1);
+    EXPECT_EQ(shard0.commands, 2);
+    EXPECT_EQ(shard0.rejected, 1);
+    EXPECT_EQ(shard0.books, 1);
+    EXPECT_EQ(shard1.commands, 2);
+    EXPECT_EQ(shard1.rejected, 0);
+    EXPECT_EQ(shard1.books, 1);
+    EXPECT_EQ(engine.GetTotalStats().commands, 4);
+
+    OrderBook* book10 = engine.Registry(1).Find(10);
+    OrderBook* book12 = engine.Registry(0).Find(12);
+    ASSERT_NE(book10, nullptr);
+    ASSERT_NE(book12, nullptr);
+    EXPECT_EQ(engine.Registry(0).Find(10), nullptr);
+    EXPECT_EQ(book10->GetBestBid(), 100);
+    EXPECT_EQ(book10->GetTotalBidVolume(), 6);
+    EXPECT_EQ(book12->GetBestAsk(), 200);
+
+    // Books were created on worker threads, not here
+    ASSERT_EQ(creating_threads.size(), 2);
+    EXPECT_NE(creating_threads[0], std::this_thread::get_id());
+    EXPECT_NE(creating_threads[1], std::this_thread::get_id());
+}
+
+// Test that clients registered at creation see their book's events
+TEST(ShardedEngineTest, ClientsAttachOnBookCreation) {
+    ShardedEngineConfig config;
+    config.num_shards = 3;
+    config.ring_capacity = 16;  // Small enough that Submit has to wait
+    ShardedEngine engine(config);
+
+    std::vector<std::shared_ptr<RecordingClient>> clients(6);
+    engine.SetBookCreatedCallback([&](size_t, size_t, uint32_t instrument_id, const std::shared_ptr<OrderBook>& book) {
+        clients[instrument_id] = std::make_shared<RecordingClient>(instrument_id + 1);
+        book->RegisterClient(clients[instrument_id]);
+    });
+
+    engine.Start();
+    const uint64_t orders_per_instrument = 500;
+    for (uint64_t i = 0; i < orders_per_instrument; ++i) {
+        for (uint32_t instrument = 0; instrument < clients.size(); ++instrument) {
+            engine.Submit(instrument, BookCommand::Add(i, 1, i % 2 == 0, 1, 100, 0, 0));
+        }
+    }
+    engine.Stop();
+
+    for (uint32_t instrument = 0; instrument < clients.size(); ++instrument) {
+        ASSERT_NE(clients[instrument], nullptr);
+        // Alternating buys and sells at one price pair off into one trade each
+        EXPECT_EQ(clients[instrument]->trades.size(), orders_per_instrument / 2);
+    }
+    EXPECT_EQ(engine.GetTotalStats().commands, orders_per_instrument * clients.size());
+    EXPECT_EQ(engine.GetTotalStats().rejected, 0);
+}
+
+// Performance test: the same flow through 1, 2 and 4 shards
+TEST(ShardedEngineTest, ShardScalingPerformance) {
+    const uint32_t num_instruments = 16;
+    const uint64_t orders_per_instrument = 20000;
+
+    for (size_t num_shards : {1, 2, 4}) {
+        ShardedEngineConfig config;
+        config.num_shards = num_shards;
+        ShardedEngine engine(config);
+        engine.Start();
+
+        auto start = std::chrono::high_resolution_clock::now();
+        for (uint64_t i = 0; i < orders_per_instrument; ++i) {
+            for (uint32_t instrument = 0; instrument < num_instruments; ++instrument) {
+                // Resting orders on both sides, a cross every fourth order
+                bool is_buy = i % 2 == 0;
+                uint64_t price = is_buy ? 1000 - (i % 50) : 1001 + (i % 50);
+                if (i % 4 == 3) {
+                    price = 990;
+                }
+                engine.Submit(instrument, BookCommand::Add(i, 1, is_buy, 10, price, 0, 0));
+            }
+        }
+        engine.Stop();
+        auto end = std::chrono::high_resolution_clock::now();
+        auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+
+        ShardStats total = engine.GetTotalStats();
+        EXPECT_EQ(total.commands, orders_per_instrument * num_instruments);
+        std::cout << num_shards << " shard(s): " << total.commands << " commands in " << duration.count()
+                  << " microseconds (" << total.batches << " batches, " << total.submit_stalls << " stalls)"
+                  << std::endl;
+        EXPECT_LT(duration.count(), 5000000);  // Should complete in less than 5 seconds
+    }
+}
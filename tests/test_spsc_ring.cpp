@@ -0,0 +1,152 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "IngressRing.h"
+#include "SpscRing.h"
+
+// Test push/pop order, capacity rounding and the full/empty edges
+TEST(SpscRingTest, PushPopSingleThread) {
+    SpscRing<uint64_t> ring(5);
+    EXPECT_EQ(ring.Capacity(), 8);
+    EXPECT_TRUE(ring.Empty());
+
+    uint64_t value = 0;
+    EXPECT_FALSE(ring.TryPop(value));
+
+    for (uint64_t i = 0; i < 8; ++i) {
+        EXPECT_TRUE(ring.TryPush(i));
+    }
+    EXPECT_FALSE(ring.TryPush(99));
+    EXPECT_EQ(ring.Size(), 8);
+
+    ASSERT_TRUE(ring.TryPop(value));
+    EXPECT_EQ(value, 0);
+    EXPECT_TRUE(ring.TryPush(8));  // Room again after one pop
+
+    uint64_t batch[16];
+    ASSERT_EQ(ring.PopBatch(batch, 3), 3);
+    EXPECT_EQ(batch[0], 1);
+    EXPECT_EQ(batch[2], 3);
+    ASSERT_EQ(ring.PopBatch(batch, 16), 5);
+    EXPECT_EQ(batch[4], 8);
+    EXPECT_TRUE(ring.Empty());
+
+    EXPECT_THROW(SpscRing<uint64_t>(0), std::invalid_argument);
+}
+
+// Test that a consumer thread sees every element exactly once, in order
+TEST(SpscRingTest, ProducerConsumerThreads) {
+    const uint64_t count = 1000000;
+    SpscRing<uint64_t> ring(1024);
+
+    uint64_t received = 0;
+    bool in_order = true;
+    std::thread consumer([&] {
+        uint64_t batch[64];
+        while (received < count) {
+            size_t n = ring.PopBatch(batch, 64);
+            for (size_t i = 0; i < n; ++i) {
+                in_order &= batch[i] == received;
+                ++received;
+            }
+            if (n == 0) {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    auto start = std::chrono::high_resolution_clock::now();
+    for (uint64_t i = 0; i < count; ++i) {
+        while (!ring.TryPush(i)) {
+            std::this_thread::yield();
+        }
+    }
+    consumer.join();
+    auto end = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+
+    std::cout << "Passed " << count << " elements through SpscRing in " << duration.count() << " microseconds"
+              << std::endl;
+    EXPECT_EQ(received, count);
+    EXPECT_TRUE(in_order);
+    EXPECT_TRUE(ring.Empty());
+}
+
+// Test every wait strategy hands over all elements and shuts down cleanly
+TEST(SpscRingTest, IngressRingWaitStrategies) {
+    const uint64_t count = 200000;
+    for (WaitStrategy strategy : {WaitStrategy::BusySpin, WaitStrategy::Yield, WaitStrategy::Park}) {
+        if (strategy == WaitStrategy::BusySpin && std::thread::hardware_concurrency() < 2) {
+            continue;  // Two spinning threads on one core just trade time slices
+        }
+        IngressRing<uint64_t> ring(256, strategy);
+
+        uint64_t received = 0;
+        uint64_t sum = 0;
+        std::thread consumer([&] {
+            uint64_t batch[32];
+            while (size_t n = ring.WaitPopBatch(batch, 32)) {
+                for (size_t i = 0; i < n; ++i) {
+                    sum += batch[i];
+                }
+                received += n;
+            }
+        });
+
+        auto start = std::chrono::high_resolution_clock::now();
+        for (uint64_t i = 0; i < count; ++i) {
+            ring.Push(i);
+            if (strategy == WaitStrategy::Park && i % 50000 == 0) {
+                // Let the consumer go idle long enough to park
+                std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            }
+        }
+        ring.Close();
+        consumer.join();
+        auto end = std::chrono::high_resolution_clock::now();
+        auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+
+        IngressRingStats stats = ring.GetStats();
+        std::cout << "Wait strategy " << static_cast<int>(strategy) << ": " << count << " elements in "
+                  << duration.count() << " microseconds, " << stats.batches << " batches, " << stats.overflows
+                  << " overflows, " << stats.parks << " parks, high water " << stats.high_water << std::endl;
+        EXPECT_EQ(received, count);
+        EXPECT_EQ(sum, count * (count - 1) / 2);
+        EXPECT_EQ(stats.pushed, count);
+        EXPECT_EQ(stats.popped, count);
+        EXPECT_LE(stats.high_water, ring.Capacity());
+        if (strategy == WaitStrategy::Park) {
+            EXPECT_GT(stats.parks, 0);
+        } else {
+            EXPECT_EQ(stats.parks, 0);
+        }
+    }
+}
+
+// Test TryPush drops and counts overflows instead of waiting
+TEST(SpscRingTest, IngressRingCountsOverflows) {
+    IngressRing<uint64_t> ring(4);
+    for (uint64_t i = 0; i < 6; ++i) {
+        ring.TryPush(i);
+    }
+    IngressRingStats stats = ring.GetStats();
+    EXPECT_EQ(stats.pushed, 4);
+    EXPECT_EQ(stats.overflows, 2);
+
+    uint64_t batch[8];
+    EXPECT_EQ(ring.PopBatch(batch, 8), 4);
+    EXPECT_EQ(batch[3], 3);
+    EXPECT_EQ(ring.GetStats().high_water, 4);
+
+    // Closed and drained: no waiting
+    ring.Close();
+    EXPECT_EQ(ring.WaitPopBatch(batch, 8), 0);
+    ring.Reopen();
+    EXPECT_TRUE(ring.TryPush(7));
+    EXPECT_EQ(ring.WaitPopBatch(batch, 8), 1);
+}